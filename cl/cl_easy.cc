@@ -25,6 +25,7 @@
 #include <cl/killer.hh>
 #include <cl/memdebug.hh>
 #include <cl/storage.hh>
+#include <cl/thread_pool.hh>
 
 #include "callgraph.hh"
 #include "cl_storage.hh"
@@ -32,7 +33,9 @@
 #include "pointsto.hh"
 #include "stopwatch.hh"
 
+#include <algorithm>
 #include <string>
+#include <thread>
 
 #define _CL_PRINT_TIME(mech, watch) mech("clEasyRun() took " << watch)
 
@@ -65,17 +68,24 @@ class ClEasy: public ClStorageBuilder {
             CodeStorage::CallGraph::buildCallGraph(stor);
             printMemUsage("buildCallGraph");
 
-            CL_DEBUG("scanning CFG for loop-closing edges...");
-            findLoopClosingEdges(stor);
-            printMemUsage("findLoopClosingEdges");
+            {
+                // the intra-procedural parts of the passes run per function
+                const unsigned hw = std::max(1U,
+                        std::thread::hardware_concurrency());
+                ThreadPool pool(std::min(hw, unsigned(CL_EASY_THREADS)));
 
-            CL_DEBUG("perform points-to analysis...");
-            pointsToAnalyse(stor, configString_);
-            printMemUsage("pointsToAnalyse");
+                CL_DEBUG("scanning CFG for loop-closing edges...");
+                findLoopClosingEdges(stor, &pool);
+                printMemUsage("findLoopClosingEdges");
 
-            CL_DEBUG("killing local variables...");
-            killLocalVariables(stor);
-            printMemUsage("killLocalVariables");
+                CL_DEBUG("perform points-to analysis...");
+                pointsToAnalyse(stor, configString_, &pool);
+                printMemUsage("pointsToAnalyse");
+
+                CL_DEBUG("killing local variables...");
+                killLocalVariables(stor, &pool);
+                printMemUsage("killLocalVariables");
+            }
 
             CL_DEBUG("ClEasy is calling the analyzer...");
             StopWatch watch;
@@ -26,6 +26,7 @@
 #include "cl_factory.hh"
 #include "cl_locator.hh"
 #include "cl_pp.hh"
+#include "cl_snapshot.hh"
 #include "cl_typedot.hh"
 
 #include "clf_intchk.hh"
@@ -300,6 +301,7 @@ ClFactory::ClFactory():
     d->map["locator"]       = &createClLocator;
     d->map["pp"]            = &createClPrettyPrintDef;
     d->map["pp_with_types"] = &createClPrettyPrintWithTypes;
+    d->map["snapshot"]      = &createClSnapshotWriter;
     d->map["typedot"]       = &createClTypeDotGenerator;
 }
 
@@ -0,0 +1,1042 @@
+/*
+ * Copyright (C) 2026 Kamil Dudka <kdudka@redhat.com>
+ *
+ * This file is part of predator.
+ *
+ * predator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * predator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with predator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config_cl.h"
+#include "cl_snapshot.hh"
+
+#include <cl/cl_msg.hh>
+
+#include "cl.hh"
+
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// /////////////////////////////////////////////////////////////////////////////
+// snapshot file format
+//
+// The file starts with SnapHeader, which is followed by the string table, the
+// table of types, the table of variables, and the stream of callbacks.  All
+// integers are stored in the byte order of the machine that wrote the file.
+// Strings are referred by their offset in the string table, types and
+// variables are referred by their index in the corresponding table.
+
+namespace {
+
+const char      snapMagic[8]    = { 'C', 'L', 'S', 'N', 'A', 'P', '\0', '\1' };
+const uint32_t  snapVersion     = 1U;
+const uint32_t  snapByteOrder   = 0x01020304U;
+const uint32_t  snapNull        = 0xFFFFFFFFU;
+const uint8_t   snapNullOp      = 0xFFU;
+
+struct SnapHeader {
+    char                    magic[8];
+    uint32_t                version;
+    uint32_t                byteOrder;
+    uint32_t                cntTypes;
+    uint32_t                cntVars;
+    uint64_t                offStrings;
+    uint64_t                sizeStrings;
+    uint64_t                offTypes;
+    uint64_t                sizeTypes;
+    uint64_t                offVars;
+    uint64_t                sizeVars;
+    uint64_t                offEvents;
+    uint64_t                sizeEvents;
+};
+
+enum ESnapEvent {
+    SE_FILE_OPEN = 1,
+    SE_FILE_CLOSE,
+    SE_FNC_OPEN,
+    SE_FNC_ARG_DECL,
+    SE_FNC_CLOSE,
+    SE_BB_OPEN,
+    SE_INSN,
+    SE_INSN_CALL_OPEN,
+    SE_INSN_CALL_ARG,
+    SE_INSN_CALL_CLOSE,
+    SE_INSN_SWITCH_OPEN,
+    SE_INSN_SWITCH_CASE,
+    SE_INSN_SWITCH_CLOSE,
+    SE_ACKNOWLEDGE
+};
+
+typedef std::string TBuf;
+
+template <typename T>
+void writeRaw(TBuf &buf, const T val)
+{
+    buf.append(reinterpret_cast<const char *>(&val), sizeof val);
+}
+
+} // namespace
+
+
+// /////////////////////////////////////////////////////////////////////////////
+// ClSnapshotWriter implementation
+class ClSnapshotWriter: public ICodeListener {
+    public:
+        ClSnapshotWriter(const char *fileName);
+
+        virtual void file_open(const char *fileName) {
+            writeRaw<uint8_t>(events_, SE_FILE_OPEN);
+            this->writeStr(events_, fileName);
+        }
+
+        virtual void file_close() {
+            writeRaw<uint8_t>(events_, SE_FILE_CLOSE);
+        }
+
+        virtual void fnc_open(const struct cl_operand *fnc) {
+            writeRaw<uint8_t>(events_, SE_FNC_OPEN);
+            this->writeOp(events_, fnc);
+        }
+
+        virtual void fnc_arg_decl(int argId, const struct cl_operand *argSrc) {
+            writeRaw<uint8_t>(events_, SE_FNC_ARG_DECL);
+            writeRaw<int32_t>(events_, argId);
+            this->writeOp(events_, argSrc);
+        }
+
+        virtual void fnc_close() {
+            writeRaw<uint8_t>(events_, SE_FNC_CLOSE);
+        }
+
+        virtual void bb_open(const char *bbName) {
+            writeRaw<uint8_t>(events_, SE_BB_OPEN);
+            this->writeStr(events_, bbName);
+        }
+
+        virtual void insn(const struct cl_insn *cli) {
+            writeRaw<uint8_t>(events_, SE_INSN);
+            this->writeInsn(events_, cli);
+        }
+
+        virtual void insn_call_open(
+            const struct cl_loc     *loc,
+            const struct cl_operand *dst,
+            const struct cl_operand *fnc)
+        {
+            writeRaw<uint8_t>(events_, SE_INSN_CALL_OPEN);
+            this->writeLoc(events_, loc);
+            this->writeOp(events_, dst);
+            this->writeOp(events_, fnc);
+        }
+
+        virtual void insn_call_arg(int argId, const struct cl_operand *argSrc) {
+            writeRaw<uint8_t>(events_, SE_INSN_CALL_ARG);
+            writeRaw<int32_t>(events_, argId);
+            this->writeOp(events_, argSrc);
+        }
+
+        virtual void insn_call_close() {
+            writeRaw<uint8_t>(events_, SE_INSN_CALL_CLOSE);
+        }
+
+        virtual void insn_switch_open(
+            const struct cl_loc     *loc,
+            const struct cl_operand *src)
+        {
+            writeRaw<uint8_t>(events_, SE_INSN_SWITCH_OPEN);
+            this->writeLoc(events_, loc);
+            this->writeOp(events_, src);
+        }
+
+        virtual void insn_switch_case(
+            const struct cl_loc     *loc,
+            const struct cl_operand *valLo,
+            const struct cl_operand *valHi,
+            const char              *label)
+        {
+            writeRaw<uint8_t>(events_, SE_INSN_SWITCH_CASE);
+            this->writeLoc(events_, loc);
+            this->writeOp(events_, valLo);
+            this->writeOp(events_, valHi);
+            this->writeStr(events_, label);
+        }
+
+        virtual void insn_switch_close() {
+            writeRaw<uint8_t>(events_, SE_INSN_SWITCH_CLOSE);
+        }
+
+        virtual void acknowledge();
+
+    private:
+        void writeStr(TBuf &buf, const char *str);
+        void writeLoc(TBuf &buf, const struct cl_loc *loc);
+        void writeType(TBuf &buf, const struct cl_type *clt);
+        void writeVar(TBuf &buf, const struct cl_var *clv);
+        void writeOp(TBuf &buf, const struct cl_operand *op);
+        void writeInsn(TBuf &buf, const struct cl_insn *cli);
+
+    private:
+        typedef std::unordered_map<std::string, uint32_t>   TStrMap;
+        typedef std::map<cl_uid_t, uint32_t>                TIdxMap;
+
+        std::string                 fileName_;
+        TBuf                        strings_;
+        TStrMap                     strMap_;
+        TIdxMap                     typeMap_;
+        std::vector<TBuf>           types_;
+        TIdxMap                     varMap_;
+        std::vector<TBuf>           vars_;
+        TBuf                        events_;
+};
+
+ClSnapshotWriter::ClSnapshotWriter(const char *fileName):
+    fileName_(fileName)
+{
+    if (fileName_.empty())
+        CL_ERROR("no file name given to the snapshot code listener");
+}
+
+void ClSnapshotWriter::writeStr(TBuf &buf, const char *str)
+{
+    if (!str) {
+        writeRaw<uint32_t>(buf, snapNull);
+        return;
+    }
+
+    // each string is stored only once in the string table
+    const std::pair<TStrMap::iterator, bool> ret =
+        strMap_.insert(std::make_pair(std::string(str), 0U));
+
+    if (ret.second) {
+        ret.first->second = strings_.size();
+        strings_.append(str, strlen(str) + /* NUL */ 1U);
+    }
+
+    writeRaw<uint32_t>(buf, ret.first->second);
+}
+
+void ClSnapshotWriter::writeLoc(TBuf &buf, const struct cl_loc *loc)
+{
+    if (!loc)
+        loc = &cl_loc_unknown;
+
+    this->writeStr(buf, loc->file);
+    writeRaw<int32_t>(buf, loc->line);
+    writeRaw<int32_t>(buf, loc->column);
+    writeRaw<uint8_t>(buf, loc->sysp);
+}
+
+void ClSnapshotWriter::writeType(TBuf &buf, const struct cl_type *clt)
+{
+    if (!clt) {
+        writeRaw<uint32_t>(buf, snapNull);
+        return;
+    }
+
+    const TIdxMap::const_iterator it = typeMap_.find(clt->uid);
+    if (typeMap_.end() != it) {
+        writeRaw<uint32_t>(buf, it->second);
+        return;
+    }
+
+    // assign the index before going into nested types, which may refer back
+    const uint32_t idx = types_.size();
+    typeMap_[clt->uid] = idx;
+    types_.push_back(TBuf());
+    writeRaw<uint32_t>(buf, idx);
+
+    TBuf rec;
+    writeRaw<int64_t>(rec, clt->uid);
+    writeRaw<uint8_t>(rec, clt->code);
+    this->writeLoc(rec, &clt->loc);
+    writeRaw<uint8_t>(rec, clt->scope);
+    this->writeStr(rec, clt->name);
+    writeRaw<int32_t>(rec, clt->size);
+    writeRaw<int32_t>(rec, clt->item_cnt);
+    for (int i = 0; i < clt->item_cnt; ++i) {
+        const struct cl_type_item &item = clt->items[i];
+        this->writeType(rec, item.type);
+        this->writeStr(rec, item.name);
+        writeRaw<int32_t>(rec, item.offset);
+    }
+    writeRaw<int32_t>(rec, clt->array_size);
+    writeRaw<uint8_t>(rec, clt->is_unsigned);
+    writeRaw<uint8_t>(rec, clt->is_const);
+    writeRaw<uint8_t>(rec, clt->ptr_type);
+
+    // the vector may have been reallocated by the nested calls
+    types_[idx].swap(rec);
+}
+
+void ClSnapshotWriter::writeVar(TBuf &buf, const struct cl_var *clv)
+{
+    const TIdxMap::const_iterator it = varMap_.find(clv->uid);
+    if (varMap_.end() != it) {
+        writeRaw<uint32_t>(buf, it->second);
+        return;
+    }
+
+    // assign the index before going into initializers, which may refer back
+    const uint32_t idx = vars_.size();
+    varMap_[clv->uid] = idx;
+    vars_.push_back(TBuf());
+    writeRaw<uint32_t>(buf, idx);
+
+    TBuf rec;
+    writeRaw<int64_t>(rec, clv->uid);
+    this->writeStr(rec, clv->name);
+    writeRaw<uint8_t>(rec, clv->artificial);
+    this->writeLoc(rec, &clv->loc);
+    writeRaw<uint8_t>(rec, clv->initialized);
+    writeRaw<uint8_t>(rec, clv->is_extern);
+
+    uint32_t cntInitials = 0U;
+    const struct cl_initializer *initial;
+    for (initial = clv->initial; initial; initial = initial->next)
+        ++cntInitials;
+
+    writeRaw<uint32_t>(rec, cntInitials);
+    for (initial = clv->initial; initial; initial = initial->next)
+        this->writeInsn(rec, &initial->insn);
+
+    // the vector may have been reallocated by the nested calls
+    vars_[idx].swap(rec);
+}
+
+void ClSnapshotWriter::writeOp(TBuf &buf, const struct cl_operand *op)
+{
+    if (!op) {
+        writeRaw<uint8_t>(buf, snapNullOp);
+        return;
+    }
+
+    writeRaw<uint8_t>(buf, op->code);
+    if (CL_OPERAND_VOID == op->code)
+        return;
+
+    writeRaw<uint8_t>(buf, op->scope);
+    this->writeType(buf, op->type);
+
+    uint32_t cntAccessors = 0U;
+    const struct cl_accessor *ac;
+    for (ac = op->accessor; ac; ac = ac->next)
+        ++cntAccessors;
+
+    writeRaw<uint32_t>(buf, cntAccessors);
+    for (ac = op->accessor; ac; ac = ac->next) {
+        writeRaw<uint8_t>(buf, ac->code);
+        this->writeType(buf, ac->type);
+        switch (ac->code) {
+            case CL_ACCESSOR_DEREF_ARRAY:
+                this->writeOp(buf, ac->data.array.index);
+                break;
+
+            case CL_ACCESSOR_ITEM:
+                writeRaw<int32_t>(buf, ac->data.item.id);
+                break;
+
+            case CL_ACCESSOR_OFFSET:
+                writeRaw<int32_t>(buf, ac->data.offset.off);
+                break;
+
+            case CL_ACCESSOR_REF:
+            case CL_ACCESSOR_DEREF:
+                break;
+        }
+    }
+
+    if (CL_OPERAND_VAR == op->code) {
+        this->writeVar(buf, op->data.var);
+        return;
+    }
+
+    const struct cl_cst &cst = op->data.cst;
+    writeRaw<uint8_t>(buf, cst.code);
+    switch (cst.code) {
+        case CL_TYPE_FNC:
+            writeRaw<int64_t>(buf, cst.data.cst_fnc.uid);
+            this->writeStr(buf, cst.data.cst_fnc.name);
+            writeRaw<uint8_t>(buf, cst.data.cst_fnc.is_extern);
+            this->writeLoc(buf, &cst.data.cst_fnc.loc);
+            break;
+
+        case CL_TYPE_STRING:
+            this->writeStr(buf, cst.data.cst_string.value);
+            break;
+
+        case CL_TYPE_REAL:
+            writeRaw<double>(buf, cst.data.cst_real.value);
+            break;
+
+        default:
+            // integral constants share the storage of cst_int
+            writeRaw<int64_t>(buf, cst.data.cst_int.value);
+            break;
+    }
+}
+
+void ClSnapshotWriter::writeInsn(TBuf &buf, const struct cl_insn *cli)
+{
+    writeRaw<uint8_t>(buf, cli->code);
+    this->writeLoc(buf, &cli->loc);
+
+    switch (cli->code) {
+        case CL_INSN_NOP:
+        case CL_INSN_ABORT:
+            break;
+
+        case CL_INSN_JMP:
+            this->writeStr(buf, cli->data.insn_jmp.label);
+            break;
+
+        case CL_INSN_COND:
+            this->writeOp(buf, cli->data.insn_cond.src);
+            this->writeStr(buf, cli->data.insn_cond.then_label);
+            this->writeStr(buf, cli->data.insn_cond.else_label);
+            break;
+
+        case CL_INSN_RET:
+            this->writeOp(buf, cli->data.insn_ret.src);
+            break;
+
+        case CL_INSN_CLOBBER:
+            this->writeOp(buf, cli->data.insn_clobber.var);
+            break;
+
+        case CL_INSN_UNOP:
+            writeRaw<uint8_t>(buf, cli->data.insn_unop.code);
+            this->writeOp(buf, cli->data.insn_unop.dst);
+            this->writeOp(buf, cli->data.insn_unop.src);
+            break;
+
+        case CL_INSN_BINOP:
+            writeRaw<uint8_t>(buf, cli->data.insn_binop.code);
+            this->writeOp(buf, cli->data.insn_binop.dst);
+            this->writeOp(buf, cli->data.insn_binop.src1);
+            this->writeOp(buf, cli->data.insn_binop.src2);
+            break;
+
+        case CL_INSN_LABEL:
+            this->writeStr(buf, cli->data.insn_label.name);
+            break;
+
+        case CL_INSN_CALL:
+        case CL_INSN_SWITCH:
+            CL_BREAK_IF("ClSnapshotWriter::writeInsn() got an invalid insn");
+            break;
+    }
+}
+
+void ClSnapshotWriter::acknowledge()
+{
+    writeRaw<uint8_t>(events_, SE_ACKNOWLEDGE);
+    if (fileName_.empty())
+        return;
+
+    SnapHeader hdr;
+    memset(&hdr, 0, sizeof hdr);
+    memcpy(hdr.magic, snapMagic, sizeof hdr.magic);
+    hdr.version     = snapVersion;
+    hdr.byteOrder   = snapByteOrder;
+    hdr.cntTypes    = types_.size();
+    hdr.cntVars     = vars_.size();
+
+    uint64_t off = sizeof hdr;
+    hdr.offStrings  = off;
+    hdr.sizeStrings = strings_.size();
+    off += hdr.sizeStrings;
+
+    hdr.offTypes    = off;
+    for (const TBuf &rec : types_)
+        hdr.sizeTypes += rec.size();
+    off += hdr.sizeTypes;
+
+    hdr.offVars     = off;
+    for (const TBuf &rec : vars_)
+        hdr.sizeVars += rec.size();
+    off += hdr.sizeVars;
+
+    hdr.offEvents   = off;
+    hdr.sizeEvents  = events_.size();
+
+    std::fstream str(fileName_.c_str(),
+            std::fstream::out | std::fstream::binary | std::fstream::trunc);
+
+    str.write(reinterpret_cast<const char *>(&hdr), sizeof hdr);
+    str.write(strings_.data(), strings_.size());
+    for (const TBuf &rec : types_)
+        str.write(rec.data(), rec.size());
+    for (const TBuf &rec : vars_)
+        str.write(rec.data(), rec.size());
+    str.write(events_.data(), events_.size());
+    str.close();
+
+    if (!str)
+        CL_ERROR("failed to write snapshot to '" << fileName_ << "'");
+    else
+        CL_DEBUG("snapshot written to '" << fileName_ << "': "
+                << hdr.cntTypes << " types, "
+                << hdr.cntVars << " variables, "
+                << (off + hdr.sizeEvents) << " bytes");
+}
+
+
+// /////////////////////////////////////////////////////////////////////////////
+// snapshot reader
+class ClSnapshotReader {
+    public:
+        ClSnapshotReader(const char *base, size_t size):
+            base_(base),
+            size_(size),
+            pos_(0),
+            end_(0),
+            strings_(0),
+            sizeStrings_(0),
+            error_(false)
+        {
+        }
+
+        bool replay(struct cl_code_listener *cl);
+
+    private:
+        template <typename T> T read() {
+            T val = T();
+            if (end_ < pos_ + sizeof val) {
+                error_ = true;
+                return val;
+            }
+
+            memcpy(&val, pos_, sizeof val);
+            pos_ += sizeof val;
+            return val;
+        }
+
+        bool seek(uint64_t off, uint64_t size) {
+            if (size_ < off || size_ - off < size)
+                return false;
+
+            pos_ = base_ + off;
+            end_ = pos_ + size;
+            return true;
+        }
+
+        const char*                 readStr();
+        void                        readLoc(struct cl_loc *loc);
+        struct cl_type*             readType();
+        void                        readTypeRec(struct cl_type *clt);
+        struct cl_var*              readVar();
+        void                        readVarRec(struct cl_var *clv);
+        const struct cl_operand*    readOp();
+        void                        readInsn(struct cl_insn *cli);
+
+    private:
+        typedef std::vector<struct cl_type_item>    TItemList;
+
+        const char                  *base_;
+        const size_t                size_;
+        const char                  *pos_;
+        const char                  *end_;
+        const char                  *strings_;
+        uint64_t                    sizeStrings_;
+        bool                        error_;
+
+        // all the objects below are referenced by the code listener being fed
+        std::vector<struct cl_type> types_;
+        std::vector<TItemList>      items_;
+        std::vector<struct cl_var>  vars_;
+        std::deque<cl_operand>      ops_;
+        std::deque<cl_accessor>     acs_;
+        std::deque<cl_initializer>  initials_;
+        std::deque<struct cl_loc>   locs_;
+};
+
+const char* ClSnapshotReader::readStr()
+{
+    const uint32_t off = this->read<uint32_t>();
+    if (snapNull == off)
+        return 0;
+
+    if (sizeStrings_ <= off) {
+        error_ = true;
+        return 0;
+    }
+
+    // the strings are used directly from the mapped file
+    return strings_ + off;
+}
+
+void ClSnapshotReader::readLoc(struct cl_loc *loc)
+{
+    loc->file   = this->readStr();
+    loc->line   = this->read<int32_t>();
+    loc->column = this->read<int32_t>();
+    loc->sysp   = this->read<uint8_t>();
+}
+
+struct cl_type* ClSnapshotReader::readType()
+{
+    const uint32_t idx = this->read<uint32_t>();
+    if (snapNull == idx)
+        return 0;
+
+    if (types_.size() <= idx) {
+        error_ = true;
+        return 0;
+    }
+
+    return &types_[idx];
+}
+
+void ClSnapshotReader::readTypeRec(struct cl_type *clt)
+{
+    clt->uid    = this->read<int64_t>();
+    clt->code   = static_cast<enum cl_type_e>(this->read<uint8_t>());
+    this->readLoc(&clt->loc);
+    clt->scope  = static_cast<enum cl_scope_e>(this->read<uint8_t>());
+    clt->name   = this->readStr();
+    clt->size   = this->read<int32_t>();
+
+    const int32_t cnt = this->read<int32_t>();
+    if (cnt < 0 || end_ - pos_ < cnt) {
+        error_ = true;
+        return;
+    }
+
+    clt->item_cnt = cnt;
+    clt->items = 0;
+    if (cnt) {
+        const size_t idx = clt - &types_[0];
+        TItemList &items = items_[idx];
+        items.resize(cnt);
+        for (struct cl_type_item &item : items) {
+            item.type   = this->readType();
+            item.name   = this->readStr();
+            item.offset = this->read<int32_t>();
+        }
+
+        clt->items = &items[0];
+    }
+
+    clt->array_size     = this->read<int32_t>();
+    clt->is_unsigned    = this->read<uint8_t>();
+    clt->is_const       = this->read<uint8_t>();
+    clt->ptr_type       = static_cast<enum cl_ptr_type_e>(this->read<uint8_t>());
+}
+
+struct cl_var* ClSnapshotReader::readVar()
+{
+    const uint32_t idx = this->read<uint32_t>();
+    if (vars_.size() <= idx) {
+        error_ = true;
+        return 0;
+    }
+
+    return &vars_[idx];
+}
+
+void ClSnapshotReader::readVarRec(struct cl_var *clv)
+{
+    clv->uid            = this->read<int64_t>();
+    clv->name           = this->readStr();
+    clv->artificial     = this->read<uint8_t>();
+    this->readLoc(&clv->loc);
+    clv->initialized    = this->read<uint8_t>();
+    clv->is_extern      = this->read<uint8_t>();
+    clv->initial        = 0;
+
+    struct cl_initializer **pNext = &clv->initial;
+    const uint32_t cnt = this->read<uint32_t>();
+    for (uint32_t i = 0U; i < cnt && !error_; ++i) {
+        initials_.push_back(cl_initializer());
+        struct cl_initializer *initial = &initials_.back();
+        initial->next = 0;
+        this->readInsn(&initial->insn);
+
+        *pNext = initial;
+        pNext = &initial->next;
+    }
+}
+
+const struct cl_operand* ClSnapshotReader::readOp()
+{
+    const uint8_t code = this->read<uint8_t>();
+    if (snapNullOp == code)
+        return 0;
+
+    ops_.push_back(cl_operand());
+    struct cl_operand *op = &ops_.back();
+    memset(op, 0, sizeof *op);
+    op->code = static_cast<enum cl_operand_e>(code);
+    if (CL_OPERAND_VOID == op->code)
+        return op;
+
+    op->scope = static_cast<enum cl_scope_e>(this->read<uint8_t>());
+    op->type  = this->readType();
+
+    struct cl_accessor **pNext = &op->accessor;
+    const uint32_t cntAccessors = this->read<uint32_t>();
+    for (uint32_t i = 0U; i < cntAccessors && !error_; ++i) {
+        acs_.push_back(cl_accessor());
+        struct cl_accessor *ac = &acs_.back();
+        memset(ac, 0, sizeof *ac);
+        ac->code = static_cast<enum cl_accessor_e>(this->read<uint8_t>());
+        ac->type = this->readType();
+        switch (ac->code) {
+            case CL_ACCESSOR_DEREF_ARRAY:
+                ac->data.array.index =
+                    const_cast<struct cl_operand *>(this->readOp());
+                break;
+
+            case CL_ACCESSOR_ITEM:
+                ac->data.item.id = this->read<int32_t>();
+                break;
+
+            case CL_ACCESSOR_OFFSET:
+                ac->data.offset.off = this->read<int32_t>();
+                break;
+
+            case CL_ACCESSOR_REF:
+            case CL_ACCESSOR_DEREF:
+                break;
+        }
+
+        *pNext = ac;
+        pNext = &ac->next;
+    }
+
+    if (CL_OPERAND_VAR == op->code) {
+        op->data.var = this->readVar();
+        return op;
+    }
+
+    struct cl_cst &cst = op->data.cst;
+    cst.code = static_cast<enum cl_type_e>(this->read<uint8_t>());
+    switch (cst.code) {
+        case CL_TYPE_FNC:
+            cst.data.cst_fnc.uid        = this->read<int64_t>();
+            cst.data.cst_fnc.name       = this->readStr();
+            cst.data.cst_fnc.is_extern  = this->read<uint8_t>();
+            this->readLoc(&cst.data.cst_fnc.loc);
+            break;
+
+        case CL_TYPE_STRING:
+            cst.data.cst_string.value   = this->readStr();
+            break;
+
+        case CL_TYPE_REAL:
+            cst.data.cst_real.value     = this->read<double>();
+            break;
+
+        default:
+            cst.data.cst_int.value      = this->read<int64_t>();
+            break;
+    }
+
+    return op;
+}
+
+void ClSnapshotReader::readInsn(struct cl_insn *cli)
+{
+    memset(cli, 0, sizeof *cli);
+    cli->code = static_cast<enum cl_insn_e>(this->read<uint8_t>());
+    this->readLoc(&cli->loc);
+
+    switch (cli->code) {
+        case CL_INSN_NOP:
+        case CL_INSN_ABORT:
+            break;
+
+        case CL_INSN_JMP:
+            cli->data.insn_jmp.label = this->readStr();
+            break;
+
+        case CL_INSN_COND:
+            cli->data.insn_cond.src         = this->readOp();
+            cli->data.insn_cond.then_label  = this->readStr();
+            cli->data.insn_cond.else_label  = this->readStr();
+            break;
+
+        case CL_INSN_RET:
+            cli->data.insn_ret.src = this->readOp();
+            break;
+
+        case CL_INSN_CLOBBER:
+            cli->data.insn_clobber.var = this->readOp();
+            break;
+
+        case CL_INSN_UNOP:
+            cli->data.insn_unop.code =
+                static_cast<enum cl_unop_e>(this->read<uint8_t>());
+            cli->data.insn_unop.dst = this->readOp();
+            cli->data.insn_unop.src = this->readOp();
+            break;
+
+        case CL_INSN_BINOP:
+            cli->data.insn_binop.code =
+                static_cast<enum cl_binop_e>(this->read<uint8_t>());
+            cli->data.insn_binop.dst  = this->readOp();
+            cli->data.insn_binop.src1 = this->readOp();
+            cli->data.insn_binop.src2 = this->readOp();
+            break;
+
+        case CL_INSN_LABEL:
+            cli->data.insn_label.name = this->readStr();
+            break;
+
+        default:
+            error_ = true;
+            break;
+    }
+}
+
+bool ClSnapshotReader::replay(struct cl_code_listener *cl)
+{
+    SnapHeader hdr;
+    if (size_ < sizeof hdr) {
+        CL_ERROR("snapshot file is truncated");
+        return false;
+    }
+
+    memcpy(&hdr, base_, sizeof hdr);
+    if (memcmp(hdr.magic, snapMagic, sizeof hdr.magic)
+            || snapVersion != hdr.version
+            || snapByteOrder != hdr.byteOrder)
+    {
+        CL_ERROR("snapshot file has an unsupported format");
+        return false;
+    }
+
+    if (!this->seek(hdr.offStrings, hdr.sizeStrings)
+            || (hdr.sizeStrings && '\0' != base_[hdr.offStrings
+                                                 + hdr.sizeStrings - 1U]))
+    {
+        CL_ERROR("snapshot file has a corrupted string table");
+        return false;
+    }
+
+    strings_ = pos_;
+    sizeStrings_ = hdr.sizeStrings;
+
+    // allocate all types and variables first as their records refer each other
+    types_.resize(hdr.cntTypes);
+    items_.resize(hdr.cntTypes);
+    vars_.resize(hdr.cntVars);
+
+    if (!this->seek(hdr.offTypes, hdr.sizeTypes)) {
+        CL_ERROR("snapshot file has a corrupted table of types");
+        return false;
+    }
+
+    for (struct cl_type &clt : types_)
+        this->readTypeRec(&clt);
+
+    if (error_ || pos_ != end_) {
+        CL_ERROR("snapshot file has a corrupted table of types");
+        return false;
+    }
+
+    if (!this->seek(hdr.offVars, hdr.sizeVars)) {
+        CL_ERROR("snapshot file has a corrupted table of variables");
+        return false;
+    }
+
+    for (struct cl_var &clv : vars_)
+        this->readVarRec(&clv);
+
+    if (error_ || pos_ != end_) {
+        CL_ERROR("snapshot file has a corrupted table of variables");
+        return false;
+    }
+
+    if (!this->seek(hdr.offEvents, hdr.sizeEvents)) {
+        CL_ERROR("snapshot file has a corrupted stream of callbacks");
+        return false;
+    }
+
+    // feed the code listener
+    while (pos_ < end_) {
+        const ESnapEvent code = static_cast<ESnapEvent>(this->read<uint8_t>());
+        switch (code) {
+            case SE_FILE_OPEN: {
+                const char *fileName = this->readStr();
+                if (!error_)
+                    cl->file_open(cl, fileName);
+                break;
+            }
+
+            case SE_FILE_CLOSE:
+                cl->file_close(cl);
+                break;
+
+            case SE_FNC_OPEN: {
+                const struct cl_operand *fnc = this->readOp();
+                if (!error_)
+                    cl->fnc_open(cl, fnc);
+                break;
+            }
+
+            case SE_FNC_ARG_DECL: {
+                const int argId = this->read<int32_t>();
+                const struct cl_operand *argSrc = this->readOp();
+                if (!error_)
+                    cl->fnc_arg_decl(cl, argId, argSrc);
+                break;
+            }
+
+            case SE_FNC_CLOSE:
+                cl->fnc_close(cl);
+                break;
+
+            case SE_BB_OPEN: {
+                const char *bbName = this->readStr();
+                if (!error_)
+                    cl->bb_open(cl, bbName);
+                break;
+            }
+
+            case SE_INSN: {
+                struct cl_insn cli;
+                this->readInsn(&cli);
+                if (!error_)
+                    cl->insn(cl, &cli);
+                break;
+            }
+
+            case SE_INSN_CALL_OPEN: {
+                locs_.push_back(cl_loc());
+                struct cl_loc *loc = &locs_.back();
+                this->readLoc(loc);
+                const struct cl_operand *dst = this->readOp();
+                const struct cl_operand *fnc = this->readOp();
+                if (!error_)
+                    cl->insn_call_open(cl, loc, dst, fnc);
+                break;
+            }
+
+            case SE_INSN_CALL_ARG: {
+                const int argId = this->read<int32_t>();
+                const struct cl_operand *argSrc = this->readOp();
+                if (!error_)
+                    cl->insn_call_arg(cl, argId, argSrc);
+                break;
+            }
+
+            case SE_INSN_CALL_CLOSE:
+                cl->insn_call_close(cl);
+                break;
+
+            case SE_INSN_SWITCH_OPEN: {
+                locs_.push_back(cl_loc());
+                struct cl_loc *loc = &locs_.back();
+                this->readLoc(loc);
+                const struct cl_operand *src = this->readOp();
+                if (!error_)
+                    cl->insn_switch_open(cl, loc, src);
+                break;
+            }
+
+            case SE_INSN_SWITCH_CASE: {
+                locs_.push_back(cl_loc());
+                struct cl_loc *loc = &locs_.back();
+                this->readLoc(loc);
+                const struct cl_operand *valLo = this->readOp();
+                const struct cl_operand *valHi = this->readOp();
+                const char *label = this->readStr();
+                if (!error_)
+                    cl->insn_switch_case(cl, loc, valLo, valHi, label);
+                break;
+            }
+
+            case SE_INSN_SWITCH_CLOSE:
+                cl->insn_switch_close(cl);
+                break;
+
+            case SE_ACKNOWLEDGE:
+                cl->acknowledge(cl);
+                break;
+
+            default:
+                error_ = true;
+        }
+
+        if (error_) {
+            CL_ERROR("snapshot file has a corrupted stream of callbacks");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+// /////////////////////////////////////////////////////////////////////////////
+// interface, see cl_snapshot.hh and code_listener.h for details
+ICodeListener* createClSnapshotWriter(const char *fileName)
+{
+    return new ClSnapshotWriter(fileName);
+}
+
+bool cl_snapshot_replay(
+        struct cl_code_listener         *listener,
+        const char                      *file_name)
+{
+    const int fd = open(file_name, O_RDONLY);
+    if (fd < 0) {
+        CL_ERROR("unable to open snapshot file '" << file_name << "'");
+        listener->destroy(listener);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) || !st.st_size) {
+        CL_ERROR("unable to read snapshot file '" << file_name << "'");
+        listener->destroy(listener);
+        close(fd);
+        return false;
+    }
+
+    const size_t size = st.st_size;
+    void *addr = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (MAP_FAILED == addr) {
+        CL_ERROR("unable to map snapshot file '" << file_name << "'");
+        listener->destroy(listener);
+        return false;
+    }
+
+    bool ok;
+    try {
+        ClSnapshotReader reader(static_cast<const char *>(addr), size);
+        ok = reader.replay(listener);
+    }
+    catch (...) {
+        CL_DIE("uncaught exception in cl_snapshot_replay()");
+    }
+
+    // the listener may still refer to the data of the snapshot
+    listener->destroy(listener);
+
+    munmap(addr, size);
+    return ok;
+}
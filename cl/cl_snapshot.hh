@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2026 Kamil Dudka <kdudka@redhat.com>
+ *
+ * This file is part of predator.
+ *
+ * predator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * predator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with predator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H_GUARD_CL_SNAPSHOT_H
+#define H_GUARD_CL_SNAPSHOT_H
+
+/**
+ * @file cl_snapshot.hh
+ * constructor createClSnapshotWriter() of the @b "snapshot" code listener
+ */
+
+class ICodeListener;
+
+/**
+ * create "snapshot" ICodeListener implementation, which records the types,
+ * variables, and the sequence of callbacks it receives into a binary file
+ * once the translation unit is acknowledged.  The snapshot can be later fed
+ * into another code listener by cl_snapshot_replay() without a compiler.
+ * @param fileName name of the file to write the snapshot to
+ */
+ICodeListener* createClSnapshotWriter(const char *fileName);
+
+#endif /* H_GUARD_CL_SNAPSHOT_H */
@@ -26,6 +26,7 @@
 #include "cl_factory.hh"
 #include "cl_private.hh"
 
+#include <atomic>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -91,29 +92,88 @@ static struct cl_init_data init_data = {
     0                      // .debug_level
 };
 
+// count of warnings and errors emitted so far, see cl_msg_cnt_issues(),
+// updated by any thread that emits a message
+static std::atomic<int> cnt_issues(0);
+
+// if not NULL, messages emitted by the current thread are captured there
+static thread_local cl_msg_list *msg_capture;
+
+// if not NULL, messages emitted by the current thread are passed there
+static thread_local cl_msg_sink_t msg_sink;
+
+// true while cl_msg_replay() emits messages already counted when captured
+static thread_local bool msg_replaying;
+
+#define CHK_CAPTURE(fnc, text) do {                 \
+    if (msg_capture) {                              \
+        const struct cl_msg_item item = { fnc, text };\
+        msg_capture->push_back(item);               \
+        return;                                     \
+    }                                               \
+    if (msg_sink) {                                 \
+        const struct cl_msg_item item = { fnc, text };\
+        msg_sink(item);                             \
+        return;                                     \
+    }                                               \
+} while (0)
+
 void cl_debug(const char *msg)
 {
+    CHK_CAPTURE(cl_debug, msg);
     init_data.debug(msg);
 }
 
 void cl_warn(const char *msg)
 {
+    if (!msg_replaying)
+        ++cnt_issues;
+
+    CHK_CAPTURE(cl_warn, msg);
     CHK_LAST(msg, /* filter */ true);
     init_data.warn(msg);
 }
 
 void cl_error(const char *msg)
 {
+    if (!msg_replaying)
+        ++cnt_issues;
+
+    CHK_CAPTURE(cl_error, msg);
     CHK_LAST(msg, /* filter */ true);
     init_data.error(msg);
 }
 
 void cl_note(const char *msg)
 {
+    CHK_CAPTURE(cl_note, msg);
     CHK_LAST(msg, /* filter */ false);
     init_data.note(msg);
 }
 
+void cl_msg_capture(cl_msg_list *dst)
+{
+    msg_capture = dst;
+}
+
+void cl_msg_stream(cl_msg_sink_t sink)
+{
+    msg_sink = sink;
+}
+
+void cl_msg_replay(const cl_msg_list &msgs)
+{
+    msg_replaying = true;
+    for (const struct cl_msg_item &item : msgs)
+        item.fnc(item.text.c_str());
+    msg_replaying = false;
+}
+
+int cl_msg_cnt_issues(void)
+{
+    return cnt_issues;
+}
+
 void cl_die(const char *msg)
 {
     // this call should never return (TODO: annotation?)
@@ -88,6 +88,12 @@
  */
 #define CL_EASY_TIMER                   1
 
+/**
+ * upper bound of the count of threads running the intra-procedural passes
+ * of ClEasy over all functions in parallel, 1 runs them sequentially
+ */
+#define CL_EASY_THREADS                 8
+
 /**
  * if 1, filter out repeated error/warning messages (sort of 2>&1 | uniq)
  */
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2026 Kamil Dudka <kdudka@redhat.com>
+ *
+ * This file is part of predator.
+ *
+ * predator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * predator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with predator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config_cl.h"
+#include "fncpool.hh"
+
+#include <cl/cl_msg.hh>
+#include <cl/thread_pool.hh>
+
+#include <atomic>
+
+namespace CodeStorage {
+
+bool runPerFnc(
+        ThreadPool                 *pool,
+        const TFncJobList          &fncs,
+        const TFncJob              &job)
+{
+    const unsigned cnt = fncs.size();
+    if (!pool || pool->cntThreads() < 2U || cnt < 2U) {
+        // sequential fallback
+        for (Fnc *fnc : fncs)
+            if (!job(*fnc))
+                return false;
+
+        return true;
+    }
+
+    // index of the first failed job so far (cnt if there is none)
+    std::atomic<unsigned> firstFailure(cnt);
+
+    std::vector<cl_msg_list> msgsByFnc(cnt);
+    pool->runAll(cnt, [&](unsigned idx) {
+        if (firstFailure.load() < idx)
+            // a job scheduled earlier has already failed
+            return;
+
+        cl_msg_capture(&msgsByFnc[idx]);
+        const bool ok = job(*fncs[idx]);
+        cl_msg_capture(0);
+        if (ok)
+            return;
+
+        unsigned last = firstFailure.load();
+        while (idx < last && !firstFailure.compare_exchange_weak(last, idx))
+            ;
+    });
+
+    // emit the messages in the same order as the sequential path would do
+    const unsigned end = firstFailure.load();
+    for (unsigned idx = 0U; idx < cnt && idx <= end; ++idx)
+        cl_msg_replay(msgsByFnc[idx]);
+
+    return (cnt == end);
+}
+
+} // namespace CodeStorage
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2026 Kamil Dudka <kdudka@redhat.com>
+ *
+ * This file is part of predator.
+ *
+ * predator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * predator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with predator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H_GUARD_FNCPOOL_H
+#define H_GUARD_FNCPOOL_H
+
+/**
+ * @file fncpool.hh
+ * runPerFnc() - run an intra-procedural pass over many functions in parallel
+ */
+
+#include <functional>
+#include <vector>
+
+class ThreadPool;
+
+namespace CodeStorage {
+
+struct Fnc;
+
+/// list of functions to run an intra-procedural pass on
+typedef std::vector<Fnc *>                          TFncJobList;
+
+/// an intra-procedural pass over a single function, returns false on failure
+typedef std::function<bool (Fnc &)>                 TFncJob;
+
+/**
+ * run the given job on each function in the list, in parallel if a pool with
+ * more than one thread is given.  The messages emitted by the jobs are emitted
+ * in the order of the list, so that the output does not depend on the count of
+ * threads.  As in the sequential case, nothing is emitted for the functions
+ * following the first failure, and the jobs that have not started yet by then
+ * are skipped.
+ * @note each job is allowed to modify only the data of its own function
+ * @return true if no job has failed
+ */
+bool runPerFnc(
+        ThreadPool                 *pool,
+        const TFncJobList          &fncs,
+        const TFncJob              &job);
+
+} // namespace CodeStorage
+
+#endif /* H_GUARD_FNCPOOL_H */
@@ -221,6 +221,7 @@ static struct plugin_info cl_info = {
 "    -fplugin-arg-%s-args=PEER_ARGS                 args given to analyzer\n"
 "    -fplugin-arg-%s-dry-run                        do not run the analyzer\n"
 "    -fplugin-arg-%s-dump-pp[=OUTPUT_FILE]          dump linearized code\n"
+"    -fplugin-arg-%s-dump-snapshot=SNAPSHOT_FILE    dump code for slsnap\n"
 "    -fplugin-arg-%s-dump-types                     dump also type info\n"
 "    -fplugin-arg-%s-gen-dot[=GLOBAL_CG_FILE]       generate CFGs\n"
 "    -fplugin-arg-%s-pid-file=FILE                  write PID of self to FILE\n"
@@ -273,7 +274,8 @@ static void init_plugin_name(const struct plugin_name_args *info)
     if (-1 == asprintf(&msg, cl_info.help, plugin_base_name,
                        name, name, name, name,
                        name, name, name, name,
-                       name, name, name, name))
+                       name, name, name, name,
+                       name))
         // OOM
         abort();
     else
@@ -2327,6 +2329,7 @@ struct cl_plug_options {
     const char              *pp_out_file;
     const char              *analyzer_args;
     const char              *type_dot_file;
+    const char              *snapshot_file;
     const char              *pid_file;
 };
 
@@ -2377,6 +2380,14 @@ static int clplug_init(const struct plugin_name_args *info,
             opt->use_pp         = true;
             opt->pp_out_file    = value;
         }
+        else if (STREQ(key, "dump-snapshot")) {
+            if (value)
+                opt->snapshot_file = value;
+            else {
+                CL_ERROR("mandatory value omitted for dump-snapshot");
+                return EXIT_FAILURE;
+            }
+        }
         else if (STREQ(key, "dump-types")) {
             opt->dump_types     = true;
             // TODO: warn about ignoring extra value?
@@ -2493,6 +2504,12 @@ create_cl_chain(const struct cl_plug_options *opt)
                 opt->type_dot_file, opt))
         return NULL;
 
+    // record the code exactly as the analyzer would see it
+    if (opt->snapshot_file && !cl_append_listener(chain,
+                "listener=\"snapshot\" listener_args=\"%s\" "
+                "clf=\"unfold_switch,unify_labels_gl\"", opt->snapshot_file))
+        return NULL;
+
     if (opt->use_analyzer
             && !cl_append_def_listener(chain, "easy", opt->analyzer_args, opt))
         return NULL;
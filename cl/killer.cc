@@ -25,11 +25,13 @@
 #include <cl/clutil.hh>
 #include <cl/storage.hh>
 
+#include "fncpool.hh"
 #include "pointsto.hh"
 #include "builtins.hh"
 #include "stopwatch.hh"
 #include "util.hh"
 
+#include <atomic>
 #include <map>
 #include <set>
 
@@ -84,17 +86,15 @@ struct VarData {
  * with help of PointsTo analysis.
  */
 class PTStats {
-    static PTStats *inst;
-
     public:
-        int count;
-        int fullCount;
+        // updated concurrently by analyzeFnc() running in parallel
+        std::atomic<int> count;
+        std::atomic<int> fullCount;
 
     public:
         static PTStats *getInstance() {
-            if (!inst)
-                inst = new PTStats();
-            return inst;
+            static PTStats inst;
+            return &inst;
         }
 
 
@@ -107,8 +107,6 @@ class PTStats {
         {
         }
 };
-// initialize
-PTStats *PTStats::inst = 0;
 
 void countPtStat(Data &data, cl_uid_t uid)
 {
@@ -328,7 +326,9 @@ inline bool isPointedUid(Data &data, cl_uid_t uid)
         if (item.second == uid)
             return false;
 
-    return data.stor.vars[uid].mayBePointed;
+    // use the read-only look-up, which is safe to run in parallel
+    const Storage &stor = data.stor;
+    return stor.vars[uid].mayBePointed;
 }
 
 // this just finishes the killing-per-target work (with some debug output)
@@ -516,8 +516,9 @@ cl_uid_t alias(Data &data, cl_uid_t uid)
     if (hasKey(data.derefAliases, uid))
         return data.derefAliases[uid];
 
-    // not computed yet
-    const Var *v = &data.stor.vars[uid];
+    // not computed yet (use the read-only look-up safe to run in parallel)
+    const Storage &stor = data.stor;
+    const Var *v = &stor.vars[uid];
 
     if (!cgn || cg.hasIndirectCall || cg.hasCallback || isDead(data.stor.ptd))
         return 0;
@@ -635,19 +636,21 @@ void analyzeFnc(Fnc &fnc)
 
 } // namespace VarKiller
 
-void killLocalVariables(Storage &stor)
+void killLocalVariables(Storage &stor, ThreadPool *pool)
 {
     StopWatch watch;
 
     // analyze all _defined_ functions
-    for (Fnc *pFnc : stor.fncs) {
-        Fnc &fnc = *pFnc;
-        if (!isDefined(fnc))
-            continue;
+    TFncJobList fncs;
+    for (Fnc *pFnc : stor.fncs)
+        if (isDefined(*pFnc))
+            fncs.push_back(pFnc);
 
-        // analyze a single function
+    // analyze each function separately
+    runPerFnc(pool, fncs, [](Fnc &fnc) {
         VarKiller::analyzeFnc(fnc);
-    }
+        return true;
+    });
 
     VarKiller::PTStats *stats = VarKiller::PTStats::getInstance();
     if (stats->count > 0) {
@@ -176,6 +176,11 @@ static cl::opt<std::string> CLPPFilename("dump-pp",
         cl::ValueOptional,
         cl::value_desc("filename"),
         cl::init("-"), cl::cat(CLOptionCategory));
+static cl::opt<std::string> CLSnapshotFilename("dump-snapshot",
+        cl::desc("Dump a binary snapshot of the code for a later analysis"),
+        cl::ValueRequired,
+        cl::value_desc("filename"),
+        cl::cat(CLOptionCategory));
 static cl::opt<bool> CLDumpType("dump-types",
         cl::desc("Dump also type info"),
         cl::init(false), cl::cat(CLOptionCategory));
@@ -417,6 +422,14 @@ void CLPass::setup(void) {
         configCL.clear();
     }
 
+    if (!CLSnapshotFilename.empty()) {
+        // record the code exactly as the analyzer would see it
+        configCL = "listener=\"snapshot\" listener_args=\""
+            + CLSnapshotFilename +"\" clf=\"unify_labels_fnc\"";
+        appendListener(configCL.c_str());
+        configCL.clear();
+    }
+
     if (!CLDryRun) {
         configCL = "listener=\"easy\"";
         if (!CLArgs.empty()) {
@@ -23,6 +23,7 @@
 #include <cl/cl_msg.hh>
 #include <cl/storage.hh>
 
+#include "fncpool.hh"
 #include "util.hh"
 #include "stopwatch.hh"
 
@@ -141,19 +142,21 @@ void analyzeFnc(Fnc &fnc)
 
 } // namespace LoopScan
 
-void findLoopClosingEdges(Storage &stor)
+void findLoopClosingEdges(Storage &stor, ThreadPool *pool)
 {
     StopWatch watch;
 
     // go through all _defined_ functions
-    for (Fnc *pFnc : stor.fncs) {
-        Fnc &fnc = *pFnc;
-        if (!isDefined(fnc))
-            continue;
+    TFncJobList fncs;
+    for (Fnc *pFnc : stor.fncs)
+        if (isDefined(*pFnc))
+            fncs.push_back(pFnc);
 
-        // analyze a single function
+    // analyze each function separately
+    runPerFnc(pool, fncs, [](Fnc &fnc) {
         LoopScan::analyzeFnc(fnc);
-    }
+        return true;
+    });
 
     // print time elapsed
     CL_DEBUG("findLoopClosingEdges() took " << watch);
@@ -25,10 +25,13 @@
  * @todo some dox
  */
 
+class ThreadPool;
+
 namespace CodeStorage {
     struct Storage;
 
-    void findLoopClosingEdges(Storage &stor);
+    /// mark loop-closing edges in all defined functions (in parallel if pool)
+    void findLoopClosingEdges(Storage &stor, ThreadPool *pool = 0);
 }
 
 #endif /* H_GUARD_LOOPSCAN_H */
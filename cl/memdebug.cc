@@ -24,6 +24,13 @@
 
 #include <iomanip>
 
+static TMemUsageDetail memUsageDetail;
+
+void registerMemUsageDetail(TMemUsageDetail detail)
+{
+    ::memUsageDetail = detail;
+}
+
 #if DEBUG_MEM_USAGE
 #   include <malloc.h>
 
@@ -126,6 +133,9 @@ bool printMemUsage(const char *fnc)
                 /* dec digits */ 2)
             << " MB (just completed " << fnc << "())");
 
+    if (::memUsageDetail)
+        ::memUsageDetail();
+
     return true;
 }
 
@@ -651,12 +651,16 @@ bool existsError(const Storage &stor)
 
 } /* namespace PointsTo */
 
-void pointsToAnalyse(Storage &stor, const std::string &conf)
+void pointsToAnalyse(
+        Storage                        &stor,
+        const std::string              &conf,
+        ThreadPool                     *pool)
 {
     StopWatch watch;
 
     PointsTo::BuildCtx ctx(stor);
     ptParseOpts(ctx, conf.c_str());
+    ctx.pool = pool;
 
     if (stor.callGraph.hasCallback || stor.callGraph.hasIndirectCall) {
         stor.ptd.dead = true;
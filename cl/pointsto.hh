@@ -28,6 +28,8 @@
 
 extern int pt_dbg_level;
 
+class ThreadPool;
+
 #define PT_DEBUG(level, ...) do {                                           \
     if ((level) <= pt_dbg_level)                                            \
         CL_DEBUG("PT: " << __VA_ARGS__);                                    \
@@ -55,6 +57,9 @@ namespace PointsTo {
             CodeStorage::Storage       &stor;
             Graph                      *ptg;
 
+            // if not NULL, the intra-procedural phase runs in parallel
+            ThreadPool                 *pool;
+
             struct plot {
                 // set this variable when you want to plot all points-to graphs
                 // when some of them is changed.  Content of this variable will
@@ -71,7 +76,8 @@ namespace PointsTo {
 
             BuildCtx(Storage &stor_) :
                 stor(stor_),
-                ptg(NULL)
+                ptg(NULL),
+                pool(NULL)
             {
                 plot.progress = NULL; // disable by default
                 debug.phases = FICS_PHASE_1 | FICS_PHASE_2 | FICS_PHASE_3;
@@ -257,7 +263,10 @@ namespace PointsTo {
     bool existsError(const Storage &stor);
 } /* namespace PointsTo */
 
-void pointsToAnalyse(Storage &stor, const std::string &conf);
+void pointsToAnalyse(
+        Storage                        &stor,
+        const std::string              &conf,
+        ThreadPool                     *pool = 0);
 
 } /* namespace CodeStorage */
 
@@ -25,6 +25,7 @@
 #include <cl/storage.hh>
 
 #include "clplot.hh"
+#include "fncpool.hh"
 #include "pointsto.hh"
 #include "pointsto_fics.hh"
 
@@ -464,7 +465,7 @@ RetVal phase1handleInsn(
     return PTFICS_RET_CHANGE;
 
 fallback:
-    ctx.stor.ptd.dead = 1;
+    // ptd is marked as dead by pointsToAnalyse() as phase 1 fails as a whole
     return PTFICS_RET_FAIL;
 }
 
@@ -497,55 +498,76 @@ void makeBlackHole(Fnc &fnc)
     setBlackHole(ptg, blackHole);
 }
 
-bool ficsPhase1(BuildCtx &ctx)
+bool ficsPhase1Fnc(BuildCtx &ctx, Fnc &fnc)
 {
-    const Storage & stor = ctx.stor;
+    if (isBuiltInFnc(fnc.def))
+        // just skip built-ins
+        return true;
 
-    PT_DEBUG(1, "> phase 1 <");
-    if (!(ctx.debug.phases & FICS_PHASE_1)) {
-        PT_DEBUG(1, "skipping");
+    if (!isDefined(fnc)) {
+        if (isWhiteListed(&fnc))
+            return true;
+
+        PT_DEBUG(2, "creating black hole for function: '"
+                    << nameOf(fnc) << "'");
+        makeBlackHole(fnc);
+        PLOT_PROGRESS(ctx);
         return true;
     }
 
-    for (const Fnc *pFnc : stor.callGraph.topOrder) {
-        Fnc &fnc = *const_cast<Fnc *>(pFnc);
-        ctx.ptg = &fnc.ptg;
-        if (isBuiltInFnc(fnc.def))
-            // just skip built-ins
-            continue;
+    PT_DEBUG(2, "function: '" << nameOf(fnc) << "'");
 
-        if (!isDefined(fnc)) {
-            if (isWhiteListed(&fnc))
+    for (const Block *bb : fnc.cfg) {
+        PT_DEBUG(3, "block: " << bb->name());
+        for (const Insn *insn : *bb) {
+
+            int rc = phase1handleInsn(ctx, *insn);
+            if (PTFICS_RET_NO_CHANGE == rc)
                 continue;
 
-            PT_DEBUG(2, "creating black hole for function: '"
-                        << nameOf(fnc) << "'");
-            makeBlackHole(fnc);
-            PLOT_PROGRESS(ctx);
-            continue;
+            if (PTFICS_RET_CHANGE == rc) {
+                PLOT_PROGRESS(ctx);
+                continue;
+            }
+            // error occurred
+            return false;
         }
+    }
 
-        PT_DEBUG(2, "function: '" << nameOf(fnc) << "'");
-
-        for (const Block *bb : fnc.cfg) {
-            PT_DEBUG(3, "block: " << bb->name());
-            for (const Insn *insn : *bb) {
+    return true;
+}
 
-                int rc = phase1handleInsn(ctx, *insn);
-                if (PTFICS_RET_NO_CHANGE == rc)
-                    continue;
+bool ficsPhase1(BuildCtx &ctx)
+{
+    const Storage & stor = ctx.stor;
 
-                if (PTFICS_RET_CHANGE == rc) {
-                    PLOT_PROGRESS(ctx);
-                    continue;
-                }
-                // error occurred
-                return false;
-            }
-        }
+    PT_DEBUG(1, "> phase 1 <");
+    if (!(ctx.debug.phases & FICS_PHASE_1)) {
+        PT_DEBUG(1, "skipping");
+        return true;
     }
 
-    return true;
+    TFncJobList fncs;
+    for (const Fnc *pFnc : stor.callGraph.topOrder)
+        fncs.push_back(const_cast<Fnc *>(pFnc));
+
+    // each function gets its own context as the functions may run in parallel
+    const auto job = [&ctx](Fnc &fnc) {
+        BuildCtx fncCtx(ctx);
+        fncCtx.ptg = &fnc.ptg;
+        return ficsPhase1Fnc(fncCtx, fnc);
+    };
+
+    ThreadPool *pool = ctx.pool;
+#ifndef NDEBUG
+    // the consistency checks by existsError() read graphs of all functions
+    pool = 0;
+#endif
+    if (ctx.plot.progress)
+        // PLOT_PROGRESS(ctx) plots graphs of all functions
+        pool = 0;
+
+    return runPerFnc(pool, fncs, job);
 }
 
 typedef enum {
@@ -437,7 +437,7 @@ const char *Item::name() const
     }
 
 #define __nameRet_MAX_LEN 1024
-    static char nameRet[__nameRet_MAX_LEN];
+    static thread_local char nameRet[__nameRet_MAX_LEN];
     nameRet[__nameRet_MAX_LEN - 1] = 0;
     strncpy(nameRet, name.str().c_str(), __nameRet_MAX_LEN -1);
 
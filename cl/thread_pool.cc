@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2026 Kamil Dudka <kdudka@redhat.com>
+ *
+ * This file is part of predator.
+ *
+ * predator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * predator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with predator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config_cl.h"
+
+#include <cl/cl_msg.hh>
+#include <cl/thread_pool.hh>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct ThreadPool::Private {
+    std::vector<std::thread>        workers;
+    std::mutex                      mutex;
+    std::condition_variable         cvWork;
+    std::condition_variable         cvDone;
+
+    // the batch of jobs just being executed (guarded by mutex)
+    const TJob                     *job;
+    unsigned                        cnt;
+    unsigned long                   generation;
+    unsigned                        cntFinished;
+    bool                            quit;
+
+    // index of the next job to be picked by a thread
+    std::atomic<unsigned>           next;
+
+    Private():
+        job(0),
+        cnt(0U),
+        generation(0UL),
+        cntFinished(0U),
+        quit(false),
+        next(0U)
+    {
+    }
+
+    void drain(const TJob &job, unsigned cnt);
+    void workerLoop();
+};
+
+void ThreadPool::Private::drain(const TJob &job, const unsigned cnt)
+{
+    for (unsigned idx; (idx = this->next.fetch_add(1U)) < cnt;)
+        job(idx);
+}
+
+void ThreadPool::Private::workerLoop()
+{
+    unsigned long seen = 0UL;
+
+    std::unique_lock<std::mutex> lock(this->mutex);
+    for (;;) {
+        this->cvWork.wait(lock, [this, seen] {
+            return this->quit || seen != this->generation;
+        });
+
+        if (this->quit)
+            return;
+
+        // pick the batch while holding the lock
+        seen = this->generation;
+        const TJob *job = this->job;
+        const unsigned cnt = this->cnt;
+
+        lock.unlock();
+        this->drain(*job, cnt);
+        lock.lock();
+
+        // the batch cannot be released before all workers have seen it
+        if (this->workers.size() == ++this->cntFinished)
+            this->cvDone.notify_one();
+    }
+}
+
+ThreadPool::ThreadPool(const unsigned cntThreads):
+    d(new Private)
+{
+    for (unsigned i = 1U; i < cntThreads; ++i)
+        d->workers.push_back(std::thread(&Private::workerLoop, d));
+
+    CL_DEBUG("ThreadPool started with " << cntThreads << " thread(s)");
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(d->mutex);
+        d->quit = true;
+    }
+
+    d->cvWork.notify_all();
+    for (std::thread &worker : d->workers)
+        worker.join();
+
+    delete d;
+}
+
+unsigned ThreadPool::cntThreads() const
+{
+    return 1U + d->workers.size();
+}
+
+void ThreadPool::runAll(const unsigned cnt, const TJob &job)
+{
+    if (cnt < 2U || d->workers.empty()) {
+        // nothing to parallelize
+        for (unsigned idx = 0U; idx < cnt; ++idx)
+            job(idx);
+
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(d->mutex);
+        d->job = &job;
+        d->cnt = cnt;
+        d->next = 0U;
+        d->cntFinished = 0U;
+        ++d->generation;
+    }
+
+    // wake up the workers and help them with the batch
+    d->cvWork.notify_all();
+    d->drain(job, cnt);
+
+    // wait for all the workers to finish
+    std::unique_lock<std::mutex> lock(d->mutex);
+    d->cvDone.wait(lock, [this] {
+        return d->workers.size() == d->cntFinished;
+    });
+}
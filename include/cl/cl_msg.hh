@@ -31,6 +31,7 @@
 #include <cstdlib>      // needed for abort()
 #include <sstream>      // needed for std::ostringstream
 #include <string>       // needed for operator<<(std::ostream, std::string)
+#include <vector>       // needed for cl_msg_list
 
 /**
  * emit a fatal error message and ask the code listener peer to shoot down the
@@ -206,4 +207,49 @@ void cl_die(const char *msg);
  */
 int cl_debug_level(void);
 
+/// a message captured by cl_msg_capture()
+struct cl_msg_item {
+    void (*fnc)(const char *);  ///< cl_debug(), cl_warn(), cl_error(), cl_note()
+    std::string text;           ///< the message as it would have been emitted
+};
+
+/// list of captured messages in the order they have been emitted
+typedef std::vector<struct cl_msg_item> cl_msg_list;
+
+/**
+ * redirect all messages emitted by the @b calling @b thread to the given list
+ * instead of emitting them (fatal errors emitted by cl_die() are not captured)
+ *
+ * @param[in]  dst  The list to append the messages to, NULL to stop capturing
+ */
+void cl_msg_capture(cl_msg_list *dst);
+
+/// a function receiving the messages redirected by cl_msg_stream()
+typedef void (*cl_msg_sink_t)(const struct cl_msg_item &);
+
+/**
+ * pass each message emitted by the @b calling @b thread to the given function
+ * as soon as it is emitted, instead of emitting it.  Messages captured by
+ * cl_msg_capture() are passed to the function once they are replayed.  Fatal
+ * errors emitted by cl_die() are not redirected.
+ *
+ * @param[in]  sink  The function to pass the messages to, NULL to stop it
+ */
+void cl_msg_stream(cl_msg_sink_t sink);
+
+/**
+ * emit the given list of captured messages in their original order
+ *
+ * @param[in]  msgs  The list of messages obtained by cl_msg_capture()
+ */
+void cl_msg_replay(const cl_msg_list &msgs);
+
+/**
+ * return the count of warnings and errors emitted so far by all threads,
+ * including the ones squeezed as duplicates and the ones captured by
+ * cl_msg_capture(), which are counted when captured (and not again by
+ * cl_msg_replay())
+ */
+int cl_msg_cnt_issues(void);
+
 #endif /* H_GUARD_CL_MSG_H */
@@ -984,6 +984,20 @@ void cl_chain_append(
         struct cl_code_listener         *chain,
         struct cl_code_listener         *listener);
 
+/**
+ * feed the given cl_code_listener object with the callbacks recorded in a
+ * snapshot, which was written by the "snapshot" listener.  The snapshot is
+ * memory-mapped and its strings are passed to the listener without copying.
+ * @param listener Object ought to be fed with the recorded callbacks.
+ * @param file_name Name of the file the snapshot is read from.
+ * @return Returns true if the whole snapshot has been replayed successfully.
+ * @note The listener is destroyed once the snapshot is replayed because it may
+ * still refer to the data of the snapshot.
+ */
+bool cl_snapshot_replay(
+        struct cl_code_listener         *listener,
+        const char                      *file_name);
+
 #ifdef __cplusplus
 }
 #endif
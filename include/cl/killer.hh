@@ -30,11 +30,14 @@
 #include <map>
 #include <set>
 
+class ThreadPool;
+
 namespace CodeStorage {
     struct Insn;
     struct Storage;
 
-    void killLocalVariables(Storage &stor);
+    /// compute kill lists of all defined functions (in parallel if pool)
+    void killLocalVariables(Storage &stor, ThreadPool *pool = 0);
 
     namespace VarKiller {
         typedef cl_uid_t                            TVar;
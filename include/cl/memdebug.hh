@@ -40,6 +40,12 @@ bool currentMemUsage(ssize_t *pDst);
 /// print the current amount of allocated memory
 bool printMemUsage(const char *justCompletedFncName);
 
+/// callback to print details about the memory usage of a component
+typedef void (*TMemUsageDetail)(void);
+
+/// register a callback to be invoked by printMemUsage() (0 to unregister)
+void registerMemUsageDetail(TMemUsageDetail);
+
 /// print the peak over all calls of rawMemUsage(), but relative to the drift
 bool printPeakMemUsage();
 
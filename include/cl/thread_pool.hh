@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2026 Kamil Dudka <kdudka@redhat.com>
+ *
+ * This file is part of predator.
+ *
+ * predator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * predator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with predator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H_GUARD_THREAD_POOL_H
+#define H_GUARD_THREAD_POOL_H
+
+/**
+ * @file thread_pool.hh
+ * a fixed set of worker threads executing independent jobs, see ThreadPool
+ */
+
+#include <functional>
+
+/// a fixed set of worker threads used to execute independent jobs in parallel
+class ThreadPool {
+    public:
+        /// a job to be executed for each index in the range 0..(cnt - 1)
+        typedef std::function<void (unsigned /* idx */)>    TJob;
+
+        /**
+         * @param cntThreads count of threads executing the jobs, including the
+         * thread calling runAll(), so that (cntThreads - 1) threads are spawned
+         */
+        ThreadPool(unsigned cntThreads);
+        ~ThreadPool();
+
+        /// count of threads executing the jobs, including the calling thread
+        unsigned cntThreads() const;
+
+        /**
+         * execute job(0), ..., job(cnt - 1) in parallel and return as soon as
+         * all of them are done
+         * @note the jobs are @b not allowed to throw any exception
+         */
+        void runAll(unsigned cnt, const TJob &job);
+
+    private:
+        // copying NOT allowed
+        ThreadPool(const ThreadPool &);
+        ThreadPool& operator=(const ThreadPool &);
+
+    private:
+        struct Private;
+        Private *d;
+};
+
+#endif /* H_GUARD_THREAD_POOL_H */
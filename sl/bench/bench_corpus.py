@@ -0,0 +1,389 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2026 Kamil Dudka <kdudka@redhat.com>
+#
+# This file is part of predator.
+#
+# predator is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# any later version.
+#
+# predator is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with predator.  If not, see <http://www.gnu.org/licenses/>.
+
+"""benchmark of Predator on the test corpora bundled in tests/
+
+Usage:
+    bench_corpus.py run [OPTIONS] -o RESULT.{csv,json} CORPUS_OR_FILE...
+    bench_corpus.py compare [--threshold PCT] OLD.{csv,json} NEW.{csv,json}
+
+The 'run' command analyses the given files (or all *.c files of the given
+directories, such as tests/predator-regre) one by one under fixed options and
+records the wall-clock time, the time reported by the analyzer, the peak RSS,
+the count of errors/warnings, and the statistics printed by the 'print_stats'
+option of Predator for each file.  The 'compare' command reports the files
+whose time or memory usage has grown by more than the given threshold and
+exits with a non-zero status if there are any.  Both commands are driven by
+the 'bench_corpus' and 'bench_corpus_compare' targets of sl/bench/CMakeLists.txt
+if sl is configured with -DSL_BENCHMARKS=ON.
+"""
+
+import argparse
+import csv
+import glob
+import json
+import os
+import re
+import shlex
+import signal
+import subprocess
+import sys
+import tempfile
+import time
+
+# statistics printed by printSymStateStats() in sl/symstate.cc
+STATS_PATTERNS = [
+    ("block_visits",        r"BlockScheduler statistics .*: (\d+) block visit"),
+    ("max_waiting",         r" (\d+) waiting block\(s\) at most"),
+    ("join_hits",           r" (\d+) of \d+ join\(s\) succeeded"),
+    ("joins",               r" \d+ of (\d+) join\(s\) succeeded"),
+    ("heaps_stored",        r"SymStateMap statistics: (\d+) heap\(s\) stored"),
+    ("max_block_state",     r" (\d+) heap\(s\) in a block at most"),
+    ("join_cache_hits",     r"join cache statistics: (\d+) hit\(s\)"),
+    ("join_cache_lookups",  r" hit\(s\) of (\d+) lookup\(s\)"),
+    ("lookup_hits",         r"SymHeapUnion::lookup\(\) statistics: (\d+) hit"),
+    ("lookup_skipped",      r" (\d+) comparison\(s\) skipped"),
+    ("analysis_s",          r"clEasyRun\(\) took ([0-9.]+) s"),
+]
+
+# columns of the result files, in this order
+COLUMNS = ["file", "status", "exit_code", "wall_s", "peak_rss_mb",
+           "errors", "warnings"] + [name for (name, _) in STATS_PATTERNS]
+
+# metrics checked by 'compare' unless given explicitly
+DEFAULT_METRICS = ["wall_s", "analysis_s", "peak_rss_mb"]
+
+# messages emitted by Predator (and not by the compiler)
+RE_OUR_MSG = re.compile(r" \[(-sl|-fplugin=libsl\.so)\]$")
+RE_ERROR = re.compile(r": error: ")
+RE_WARNING = re.compile(r": warning: ")
+RE_INTERNAL = re.compile(r"\[internal location\]")
+
+
+def list_files(paths):
+    """expand the given directories to the *.c files they contain"""
+    files = []
+    for path in paths:
+        if os.path.isdir(path):
+            files += sorted(glob.glob(os.path.join(path, "*.c")))
+        else:
+            files.append(path)
+
+    return files
+
+
+def default_cflags(path):
+    """the corpora named *-32bit are meant to be analysed with -m32"""
+    if "-32bit" in os.path.abspath(path):
+        return ["-m32"]
+
+    return ["-m64"]
+
+
+class Analyzer:
+    """runs the compiler plug-in of Predator on a single file"""
+
+    def __init__(self, opts):
+        self.opts = opts
+        self.include = os.path.join(opts.topdir, "include",
+                                    "predator-builtins")
+
+    def compile_opts(self, path):
+        cflags = shlex.split(self.opts.cflags) if self.opts.cflags \
+            else default_cflags(path)
+        return ["-S", "-O0", "-w", "-I" + self.include, "-DPREDATOR"] + cflags
+
+    def prepare(self, path, tmpdir):
+        """return the command to be measured, None if compilation fails"""
+        opts = self.opts
+        if opts.host == "gcc":
+            return [opts.gcc] + self.compile_opts(path) + [
+                "-o", os.devnull,
+                "-fplugin=" + opts.plugin,
+                "-fplugin-arg-libsl-args=" + opts.args,
+                path]
+
+        # compile to LLVM bitcode first, so that only opt(1) is measured
+        bitcode = os.path.join(tmpdir, "input.bc")
+        cmd = [opts.clang] + self.compile_opts(path) + [
+            "-emit-llvm", "-g", "-o", bitcode, path]
+        if subprocess.call(cmd, stdout=subprocess.DEVNULL,
+                           stderr=subprocess.DEVNULL):
+            return None
+
+        cmd = shlex.split(opts.opt) + ["-o", os.devnull, "-lowerswitch"]
+        if opts.passes:
+            cmd += ["-load", opts.passes, "-global-vars"]
+
+        return cmd + ["-load", opts.plugin, "-sl",
+                      "-args=" + opts.args, bitcode]
+
+
+def measure(cmd, timeout):
+    """run cmd, return (status, exit code, wall time, peak RSS, stderr)"""
+    with tempfile.TemporaryFile() as err:
+        start = time.monotonic()
+        proc = subprocess.Popen(cmd, stdout=subprocess.DEVNULL, stderr=err,
+                                start_new_session=True,
+                                env=dict(os.environ, LC_ALL="C"))
+        status = "ok"
+        deadline = start + timeout if timeout else None
+        while True:
+            pid, wstatus, rusage = os.wait4(proc.pid, os.WNOHANG)
+            if pid:
+                break
+
+            if status == "ok" and deadline and deadline < time.monotonic():
+                # kill the whole process group (e.g. gcc and cc1)
+                os.killpg(proc.pid, signal.SIGKILL)
+                status = "timeout"
+
+            time.sleep(0.01)
+
+        wall = time.monotonic() - start
+
+        # the process has been already reaped by os.wait4()
+        proc.returncode = 0
+
+        if os.WIFSIGNALED(wstatus):
+            code = -os.WTERMSIG(wstatus)
+            if status == "ok":
+                status = "crash"
+        else:
+            code = os.WEXITSTATUS(wstatus)
+
+        # ru_maxrss of the waited process covers its waited-for children
+        rss = rusage.ru_maxrss / 1024.0
+
+        err.seek(0)
+        text = err.read().decode("utf-8", "replace")
+
+    return status, code, wall, rss, text
+
+
+def parse_output(rec, text):
+    """count Predator's errors and warnings, collect the statistics"""
+    rec["errors"] = 0
+    rec["warnings"] = 0
+    for (name, _) in STATS_PATTERNS:
+        rec[name] = ""
+
+    for line in text.splitlines():
+        if not RE_OUR_MSG.search(line):
+            continue
+
+        if not RE_INTERNAL.search(line):
+            if RE_ERROR.search(line):
+                rec["errors"] += 1
+            elif RE_WARNING.search(line):
+                rec["warnings"] += 1
+
+        for (name, pattern) in STATS_PATTERNS:
+            m = re.search(pattern, line)
+            if m:
+                rec[name] = float(m.group(1)) if "." in m.group(1) \
+                    else int(m.group(1))
+
+
+def run_file(analyzer, path, opts):
+    rec = {"file": os.path.relpath(path, opts.topdir)}
+    with tempfile.TemporaryDirectory(prefix="bench_corpus.") as tmpdir:
+        cmd = analyzer.prepare(path, tmpdir)
+        if cmd is None:
+            rec.update(status="compile_error", exit_code="", wall_s="",
+                       peak_rss_mb="")
+            parse_output(rec, "")
+            return rec
+
+        # take the run with the median wall-clock time
+        runs = []
+        for _ in range(opts.repeat):
+            runs.append(measure(cmd, opts.timeout))
+            if runs[-1][0] != "ok":
+                break
+
+        runs.sort(key=lambda r: r[2])
+        status, code, wall, rss, text = runs[len(runs) // 2]
+
+    rec.update(status=status, exit_code=code, wall_s=round(wall, 3),
+               peak_rss_mb=round(rss, 1))
+    parse_output(rec, text)
+    return rec
+
+
+def write_results(fileName, records, meta):
+    with open(fileName, "w", newline="") as f:
+        if fileName.endswith(".csv"):
+            w = csv.DictWriter(f, fieldnames=COLUMNS, lineterminator="\n")
+            w.writeheader()
+            w.writerows(records)
+        else:
+            json.dump({"meta": meta, "results": records}, f, indent=1)
+            f.write("\n")
+
+
+def read_results(fileName):
+    """return a dictionary of records indexed by file name"""
+    with open(fileName, newline="") as f:
+        if fileName.endswith(".csv"):
+            records = list(csv.DictReader(f))
+        else:
+            records = json.load(f)["results"]
+
+    return {rec["file"]: rec for rec in records}
+
+
+def cmd_run(opts):
+    opts.topdir = os.path.abspath(opts.topdir)
+    files = list_files(opts.paths)
+    if not files:
+        sys.exit("bench_corpus.py: no input files given")
+
+    analyzer = Analyzer(opts)
+    meta = {
+        "host": opts.host,
+        "args": opts.args,
+        "cflags": opts.cflags,
+        "repeat": opts.repeat,
+        "timeout": opts.timeout,
+    }
+
+    records = []
+    for idx, path in enumerate(files):
+        rec = run_file(analyzer, path, opts)
+        records.append(rec)
+        sys.stderr.write("[%d/%d] %-60s %-8s %8s s %8s MB\n" % (
+            idx + 1, len(files), rec["file"], rec["status"],
+            rec["wall_s"], rec["peak_rss_mb"]))
+
+    for fileName in opts.output:
+        write_results(fileName, records, meta)
+
+    return 0
+
+
+def to_number(value):
+    try:
+        return float(value)
+    except (TypeError, ValueError):
+        return None
+
+
+def cmd_compare(opts):
+    old = read_results(opts.old)
+    new = read_results(opts.new)
+    metrics = opts.metrics.split(",")
+
+    regressions = 0
+    totals = {m: [0.0, 0.0] for m in metrics}
+    for name in sorted(set(old) & set(new)):
+        o, n = old[name], new[name]
+        if o["status"] == "ok" and n["status"] != "ok":
+            print("%s: status changed from ok to %s" % (name, n["status"]))
+            regressions += 1
+            continue
+
+        for m in metrics:
+            vo, vn = to_number(o.get(m)), to_number(n.get(m))
+            if vo is None or vn is None:
+                continue
+
+            totals[m][0] += vo
+            totals[m][1] += vn
+
+            # ignore differences in the noise of short runs
+            floor = opts.min_time if m.endswith("_s") else opts.min_rss
+            if vn - vo <= floor:
+                continue
+
+            if vo * (1.0 + opts.threshold / 100.0) < vn:
+                print("%s: %s grew from %g to %g (%+.1f%%)" % (
+                    name, m, vo, vn, 100.0 * (vn - vo) / vo if vo else 100.0))
+                regressions += 1
+
+    for name in sorted(set(old) - set(new)):
+        print("%s: missing in %s" % (name, opts.new))
+
+    for m in metrics:
+        vo, vn = totals[m]
+        if vo:
+            print("total %s: %g -> %g (%+.1f%%)" % (
+                m, vo, vn, 100.0 * (vn - vo) / vo))
+
+    if regressions:
+        print("%d regression(s) beyond %g%% found" % (
+            regressions, opts.threshold))
+        return 1
+
+    return 0
+
+
+def main():
+    topdir = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                          os.pardir, os.pardir)
+
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    sub = parser.add_subparsers(dest="command")
+
+    p = sub.add_parser("run", help="analyse files and record the results")
+    p.add_argument("paths", nargs="+", metavar="CORPUS_OR_FILE")
+    p.add_argument("-o", "--output", action="append", required=True,
+                   help="result file (.csv or .json), can be repeated")
+    p.add_argument("--host", choices=["gcc", "llvm"], default="gcc")
+    p.add_argument("--plugin", required=True, help="path to libsl.so")
+    p.add_argument("--gcc", default="gcc", help="host gcc(1)")
+    p.add_argument("--clang", default="clang", help="host clang(1)")
+    p.add_argument("--opt", default="opt -enable-new-pm=0",
+                   help="host opt(1) including its options")
+    p.add_argument("--passes", default="", help="path to libpasses.so")
+    p.add_argument("--args", default="error_label:ERROR,print_stats",
+                   help="options of Predator (see docs/options.md)")
+    p.add_argument("--cflags", default="",
+                   help="compiler flags (-m32 for *-32bit, -m64 otherwise)")
+    p.add_argument("--repeat", type=int, default=1,
+                   help="run each file N times and take the median time")
+    p.add_argument("--timeout", type=int, default=900,
+                   help="kill the analysis after N seconds (0 = no limit)")
+    p.add_argument("--topdir", default=topdir,
+                   help="top-level directory of predator")
+
+    p = sub.add_parser("compare", help="compare two result files")
+    p.add_argument("old")
+    p.add_argument("new")
+    p.add_argument("--threshold", type=float, default=10.0,
+                   help="allowed growth in percent (10 by default)")
+    p.add_argument("--metrics", default=",".join(DEFAULT_METRICS),
+                   help="comma-separated list of columns to check")
+    p.add_argument("--min-time", type=float, default=0.1,
+                   help="ignore time differences up to N seconds")
+    p.add_argument("--min-rss", type=float, default=4.0,
+                   help="ignore memory differences up to N MB")
+
+    opts = parser.parse_args()
+    if opts.command == "run":
+        return cmd_run(opts)
+    if opts.command == "compare":
+        return cmd_compare(opts)
+
+    parser.print_usage()
+    return 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
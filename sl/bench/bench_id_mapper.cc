@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2026 Kamil Dudka <kdudka@redhat.com>
+ *
+ * This file is part of predator.
+ *
+ * predator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * predator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with predator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file bench_id_mapper.cc
+ * micro-benchmark of IdMapper against the original implementation of it,
+ * which used a pair of std::set trees
+ */
+
+#include "config.h"
+#include "id_mapper.hh"
+
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <set>
+
+/// the original tree-based implementation, kept here for comparison only
+class TreeIdMapper {
+    public:
+        typedef int                             TId;
+        typedef std::vector<TId>                TVector;
+
+    private:
+        typedef std::pair<TId, TId>             TPair;
+        typedef std::set<TPair>                 TSearch;
+        typedef TSearch::const_iterator         TIter;
+
+        TSearch                 biSearch_[2];
+
+    public:
+        bool insert(const TId left, const TId right) {
+            if (!biSearch_[0].insert(TPair(left, right)).second)
+                return false;
+
+            biSearch_[1].insert(TPair(right, left));
+            return true;
+        }
+
+        template <EDirection DIR>
+        void query(TVector *pDst, const TId id) const {
+            const TSearch &search = biSearch_[DIR];
+            const TIter beg = search.lower_bound(TPair(id, INT_MIN));
+            const TIter end = search.upper_bound(TPair(id, INT_MAX));
+            for (TIter it = beg; it != end; ++it)
+                pDst->push_back(it->second);
+        }
+
+        template <EDirection DIR>
+        void composite(const TreeIdMapper &by) {
+            TreeIdMapper result;
+            for (const TPair &item : biSearch_[DIR]) {
+                TVector cList;
+                by.query<DIR>(&cList, item.second);
+                for (const TId c : cList)
+                    result.insert(item.first, c);
+            }
+
+            biSearch_[0].swap(result.biSearch_[D_RIGHT_TO_LEFT == DIR]);
+            biSearch_[1].swap(result.biSearch_[D_LEFT_TO_RIGHT == DIR]);
+        }
+};
+
+typedef IdMapper<int, INT_MIN, INT_MAX>         TFlatIdMapper;
+
+typedef std::chrono::steady_clock               TClock;
+
+/// IDs are dense in practice as they come from EntStore
+struct Workload {
+    std::vector<std::pair<int, int> >   pairs;
+    std::vector<int>                    queries;
+
+    Workload(const unsigned size, const unsigned seed) {
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<int> dist(1, 2 * size);
+        for (unsigned i = 0U; i < size; ++i)
+            pairs.push_back(std::make_pair(dist(gen), dist(gen)));
+        for (unsigned i = 0U; i < 4U * size; ++i)
+            queries.push_back(dist(gen));
+    }
+};
+
+template <class TMapper>
+double runOnce(const Workload &wl, const Workload &wlBy, unsigned long *pSum)
+{
+    const TClock::time_point start = TClock::now();
+
+    TMapper m, by;
+    for (const std::pair<int, int> &item : wl.pairs)
+        m.insert(item.first, item.second);
+    for (const std::pair<int, int> &item : wlBy.pairs)
+        by.insert(item.first, item.second);
+
+    typename TMapper::TVector dst;
+    for (const int id : wl.queries) {
+        dst.clear();
+        m.template query<D_LEFT_TO_RIGHT>(&dst, id);
+        *pSum += dst.size();
+        dst.clear();
+        m.template query<D_RIGHT_TO_LEFT>(&dst, id);
+        *pSum += dst.size();
+    }
+
+    m.template composite<D_LEFT_TO_RIGHT>(by);
+
+    const std::chrono::duration<double> elapsed = TClock::now() - start;
+    return elapsed.count();
+}
+
+template <class TMapper>
+double measure(const unsigned size, const unsigned rounds, unsigned long *pSum)
+{
+    const Workload wl(size, /* seed */ 1U), wlBy(size, /* seed */ 2U);
+
+    double total = 0.0;
+    for (unsigned i = 0U; i < rounds; ++i)
+        total += runOnce<TMapper>(wl, wlBy, pSum);
+
+    return total;
+}
+
+/// default NFA of IdMapper traps to debugger, which does not suit the benchmark
+class FlatIdMapper: public TFlatIdMapper {
+    public:
+        FlatIdMapper():
+            TFlatIdMapper(NFA_RETURN_NOTHING)
+        {
+        }
+};
+
+int main(int argc, char *argv[])
+{
+    // the total count of pairs inserted per measurement
+    const unsigned long volume = (1 < argc) ? atol(argv[1]) : (1UL << 20);
+
+    printf("%8s %10s %12s %12s %8s\n",
+            "size", "rounds", "tree [s]", "flat [s]", "speedup");
+
+    for (unsigned size = 4U; size <= 0x4000; size *= 4U) {
+        const unsigned rounds = (volume / size) ? (volume / size) : 1U;
+        unsigned long sumTree = 0UL, sumFlat = 0UL;
+        const double tree = measure<TreeIdMapper>(size, rounds, &sumTree);
+        const double flat = measure<FlatIdMapper>(size, rounds, &sumFlat);
+        if (sumTree != sumFlat) {
+            fprintf(stderr, "results do not match for size %u\n", size);
+            return EXIT_FAILURE;
+        }
+
+        printf("%8u %10u %12.3f %12.3f %7.2fx\n",
+                size, rounds, tree, flat, tree / flat);
+    }
+
+    return EXIT_SUCCESS;
+}
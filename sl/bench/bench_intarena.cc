@@ -0,0 +1,520 @@
+/*
+ * Copyright (C) 2026 Kamil Dudka <kdudka@redhat.com>
+ *
+ * This file is part of predator.
+ *
+ * predator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * predator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with predator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file bench_intarena.cc
+ * micro-benchmark of IntervalArena against the original implementation of it,
+ * replaying traces of arena operations recorded with IA_RECORD_TRACE enabled
+ *
+ * Usage: bench_intarena [TRACE_FILE...]
+ *
+ * To record a trace, set IA_RECORD_TRACE to 1 in sl/intarena.hh, rebuild sl,
+ * and run the analyzer on a test-case (e.g. from tests/nspr-arena-64bit or
+ * tests/linux-drivers) without the "threads" option.  The trace is written to
+ * intarena-trace.txt in the current directory.  If no trace is given, two
+ * synthetic traces are used, one resembling field operations on nested
+ * structures and one updating the elements of a single big array.
+ */
+
+#include "config.h"
+#include "intarena.hh"
+#include "util.hh"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
+/// the original implementation of IntervalArena, kept for comparison only
+template <typename TInt, typename TFld>
+class MapIntervalArena {
+    public:
+        typedef std::set<TFld>                      TSet;
+
+        // for compatibility with STL
+        typedef std::pair<TInt, TInt>               key_type;
+        typedef std::pair<key_type, TFld>           value_type;
+
+        typedef std::vector<key_type>               TKeySet;
+
+    private:
+        typedef std::set<TFld>                      TLeaf;
+        typedef std::map</* beg */ TInt, TLeaf>     TLine;
+        typedef std::map</* end */ TInt, TLine>     TCont;
+        TCont                                       cont_;
+
+    public:
+        void add(const key_type &, TFld);
+        void sub(const key_type &, TFld);
+        void intersects(TSet &dst, const key_type &key) const;
+        void exactMatch(TSet &dst, const key_type &key) const;
+
+        /// return the set of all keys that map to this object
+        void reverseLookup(TKeySet &dst, TFld) const;
+
+        void clear() {
+            cont_.clear();
+        }
+
+        MapIntervalArena& operator+=(const value_type &item) {
+            this->add(item.first, item.second);
+            return *this;
+        }
+
+        MapIntervalArena& operator-=(const value_type &item) {
+            this->sub(item.first, item.second);
+            return *this;
+        }
+};
+
+template <typename TInt, typename TFld>
+void MapIntervalArena<TInt, TFld>::add(const key_type &key, const TFld fld)
+{
+    const TInt beg = key.first;
+    const TInt end = key.second;
+    CL_BREAK_IF(end <= beg);
+
+    cont_[end][beg].insert(fld);
+}
+
+template <typename TInt, typename TFld>
+void MapIntervalArena<TInt, TFld>::sub(const key_type &key, const TFld fld)
+{
+    const TInt winBeg = key.first;
+    const TInt winEnd = key.second;
+    CL_BREAK_IF(winEnd <= winBeg);
+
+    std::vector<value_type> recoverList;
+
+    const typename TCont::iterator itEnd = cont_.end();
+    typename TCont::iterator it =
+        cont_.lower_bound(winBeg + /* right-open interval given as key */ 1);
+
+    while (itEnd != it) {
+        TLine &line = it->second;
+        if (line.empty()) {
+            // skip orphans
+            ++it;
+            continue;
+        }
+        typename TLine::iterator lineIt = line.begin();
+        TInt beg = lineIt->first;
+        if (winEnd <= beg) {
+            // we are beyond the window already
+            ++it;
+            continue;
+        }
+
+        const TInt end = it->first;
+        bool anyHit = false;
+
+        const typename TLine::iterator lineItEnd = line.end();
+        do {
+            // make sure the basic window axioms hold
+            CL_BREAK_IF(winEnd <= beg);
+            CL_BREAK_IF(end <= winBeg);
+
+            // remove the object from the current leaf (if found)
+            TLeaf &os = lineIt->second;
+            if (os.erase(fld)) {
+                anyHit = true;
+
+                if (beg < winBeg) {
+                    // schedule "the part above" for re-insertion
+                    const key_type key(beg, winBeg);
+                    const value_type item(key, fld);
+                    recoverList.push_back(item);
+                }
+            }
+
+            ++lineIt;
+
+            if (lineItEnd == lineIt)
+                // end of line
+                break;
+
+            beg = lineIt->first;
+        }
+        while (beg < winEnd);
+
+        if (anyHit) {
+            if (winEnd < end) {
+                // schedule "the part beyond" for re-insertion
+                const key_type key(winEnd, end);
+                const value_type item(key, fld);
+                recoverList.push_back(item);
+            }
+
+        }
+
+        ++it;
+    }
+
+    // go through the recoverList and re-insert the missing parts
+    for (const value_type &rItem : recoverList) {
+        const key_type &key = rItem.first;
+        const TFld fld = rItem.second;
+        const TInt beg = key.first;
+        const TInt end = key.second;
+
+        cont_[end][beg].insert(fld);
+    }
+}
+
+template <typename TInt, typename TFld>
+void MapIntervalArena<TInt, TFld>::intersects(TSet &dst, const key_type &key) const
+{
+    const TInt winBeg = key.first;
+    const TInt winEnd = key.second;
+    CL_BREAK_IF(winEnd <= winBeg);
+
+    typename TCont::const_iterator it =
+        cont_.lower_bound(winBeg + /* right-open interval given as key */ 1);
+
+    for (; cont_.end() != it; ++it) {
+        const TLine &line = it->second;
+        if (line.empty())
+            // skip orphans
+            continue;
+        typename TLine::const_iterator lineIt = line.begin();
+        TInt beg = lineIt->first;
+        if (winEnd <= beg)
+            // we are beyond the window already
+            continue;
+
+        const typename TLine::const_iterator lineItEnd = line.end();
+        do {
+            // make sure the basic window axioms hold
+            CL_BREAK_IF(winEnd <= beg);
+            CL_BREAK_IF(/* end */ it->first <= winBeg);
+
+            const TLeaf &os = lineIt->second;
+            std::copy(os.begin(), os.end(), std::inserter(dst, dst.begin()));
+
+            // increment for next wheel
+            if (lineItEnd == ++lineIt)
+                // end of line
+                break;
+
+            beg = lineIt->first;
+        }
+        while (beg < winEnd);
+    }
+}
+
+// FIXME: brute-force method
+// FIXME: no assumptions can be made about the output format
+template <typename TInt, typename TFld>
+void MapIntervalArena<TInt, TFld>::reverseLookup(TKeySet &dst, const TFld fld)
+    const
+{
+    key_type key;
+
+    for (typename TCont::const_reference item : cont_) {
+        key/* end */.second = item/* end */.first;
+        const TLine &line = item.second;
+
+        for (typename TLine::const_reference lineItem : line) {
+            const TLeaf &leaf = lineItem.second;
+            if (!hasKey(leaf, fld))
+                continue;
+
+            key/* beg */.first = lineItem/* beg */.first;
+            dst.push_back(key);
+        }
+    }
+}
+
+template <typename TInt, typename TFld>
+void MapIntervalArena<TInt, TFld>::exactMatch(TSet &dst, const key_type &key) const
+{
+    typedef typename TCont::const_iterator TEndIt;
+    const TEndIt itEnd = cont_.find(/* end */ key.second);
+    if (cont_.end() == itEnd)
+        // upper bound not found
+        return;
+
+    const TLine &line = itEnd->second;
+    const typename TLine::const_iterator itBeg = line.find(/* beg */ key.first);
+    if (line.end() == itBeg)
+        // lower bound not found
+        return;
+
+    const TLeaf &leaf = itBeg->second;
+    std::copy(leaf.begin(), leaf.end(), std::inserter(dst, dst.begin()));
+}
+
+typedef long                                        TFld;
+typedef long                                        TInt;
+typedef IntervalArena<TInt, TFld>                   TTreeArena;
+typedef MapIntervalArena<TInt, TFld>                TMapArena;
+
+/// a single recorded operation on an arena
+struct Op {
+    char        code;
+    long        id;
+    long        ref;
+    TInt        beg;
+    TInt        end;
+    TFld        fld;
+};
+
+typedef std::vector<Op>                             TTrace;
+
+bool readTrace(TTrace &dst, const char *fileName)
+{
+    std::ifstream str(fileName);
+    if (!str) {
+        fprintf(stderr, "failed to open %s\n", fileName);
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(str, line)) {
+        std::istringstream ls(line);
+        Op op = { 0, 0L, 0L, 0L, 0L, 0L };
+        ls >> op.code >> op.id;
+        switch (op.code) {
+            case 'c':
+            case 'a':
+                ls >> op.ref;
+                break;
+
+            case '+':
+            case '-':
+                ls >> op.beg >> op.end >> op.fld;
+                break;
+
+            case 'i':
+            case 'x':
+                ls >> op.beg >> op.end;
+                break;
+
+            case 'r':
+                ls >> op.fld;
+                break;
+
+            case 'n':
+            case 'd':
+            case 'z':
+                break;
+
+            default:
+                fprintf(stderr, "unknown operation in %s: %s\n",
+                        fileName, line.c_str());
+                return false;
+        }
+
+        dst.push_back(op);
+    }
+
+    return true;
+}
+
+/// generate operations similar to those on objects with nested structures
+void synthTrace(TTrace &dst, const unsigned cntObjs)
+{
+    std::mt19937 gen(/* seed */ 7U);
+    long lastId = 0L;
+    long lastFld = 0L;
+
+    for (unsigned i = 0U; i < cntObjs; ++i) {
+        const long id = ++lastId;
+        dst.push_back(Op{ 'n', id, 0L, 0L, 0L, 0L });
+
+        // a structure of 2..64 fields of 1..8 bytes, some grouped in nests
+        const unsigned cntFlds = 2U + gen() % 63U;
+        TInt off = 0L;
+        std::vector<Op> fields;
+        for (unsigned f = 0U; f < cntFlds; ++f) {
+            const TInt size = 1L << (gen() % 4U);
+            off = (off + size - 1L) & ~(size - 1L);
+            fields.push_back(Op{ '+', id, 0L, off, off + size, ++lastFld });
+            off += size;
+        }
+
+        // the whole object covered by a uniform block, then the fields
+        dst.push_back(Op{ '+', id, 0L, 0L, off, ++lastFld });
+        for (const Op &fldOp : fields) {
+            Op sub = fldOp;
+            sub.code = '-';
+            sub.fld = lastFld - cntFlds;
+            dst.push_back(sub);
+            dst.push_back(fldOp);
+
+            Op look = fldOp;
+            look.code = 'i';
+            dst.push_back(look);
+        }
+
+        // clone the object a few times and modify the clones
+        for (unsigned c = 0U; c < 4U; ++c) {
+            const long cloneId = ++lastId;
+            dst.push_back(Op{ 'c', cloneId, id, 0L, 0L, 0L });
+            for (unsigned q = 0U; q < 2U * cntFlds; ++q) {
+                const Op &fldOp = fields[gen() % cntFlds];
+                Op op = fldOp;
+                op.id = cloneId;
+                op.code = "ix-+"[gen() % 4U];
+                dst.push_back(op);
+            }
+
+            dst.push_back(Op{ 'd', cloneId, 0L, 0L, 0L, 0L });
+        }
+
+        dst.push_back(Op{ 'd', id, 0L, 0L, 0L, 0L });
+    }
+}
+
+/// generate operations on a single big array of 8-byte elements
+void synthArrayTrace(
+        TTrace                     &dst,
+        const unsigned              cntElems,
+        const unsigned              cntOps)
+{
+    std::mt19937 gen(/* seed */ 7U);
+    const long id = 1L;
+    dst.push_back(Op{ 'n', id, 0L, 0L, 0L, 0L });
+
+    for (unsigned i = 0U; i < cntElems; ++i) {
+        const TInt off = 8L * i;
+        dst.push_back(Op{ '+', id, 0L, off, off + 8L, 1L + i });
+    }
+
+    for (unsigned q = 0U; q < cntOps; ++q) {
+        const unsigned i = gen() % cntElems;
+        const TInt off = 8L * i;
+        const char code = "+-ix"[gen() % 4U];
+        dst.push_back(Op{ code, id, 0L, off, off + 8L, 1L + i });
+    }
+
+    dst.push_back(Op{ 'd', id, 0L, 0L, 0L, 0L });
+}
+
+template <class TArena>
+double replay(const TTrace &trace, unsigned long *pSum)
+{
+    typedef std::unordered_map<long, TArena> TArenaMap;
+    TArenaMap arenas;
+
+    typename TArena::TSet fldSet;
+    typename TArena::TKeySet keySet;
+
+    typedef std::chrono::steady_clock TClock;
+    const TClock::time_point start = TClock::now();
+
+    for (const Op &op : trace) {
+        const typename TArena::key_type key(op.beg, op.end);
+        switch (op.code) {
+            case 'n':
+                arenas[op.id];
+                break;
+
+            case 'c':
+            case 'a':
+                arenas[op.id] = arenas[op.ref];
+                break;
+
+            case 'd':
+                arenas.erase(op.id);
+                break;
+
+            case 'z':
+                arenas[op.id].clear();
+                break;
+
+            case '+':
+                arenas[op.id].add(key, op.fld);
+                break;
+
+            case '-':
+                arenas[op.id].sub(key, op.fld);
+                break;
+
+            case 'i':
+                fldSet.clear();
+                arenas[op.id].intersects(fldSet, key);
+                for (const TFld fld : fldSet)
+                    *pSum += fld;
+                break;
+
+            case 'x':
+                fldSet.clear();
+                arenas[op.id].exactMatch(fldSet, key);
+                for (const TFld fld : fldSet)
+                    *pSum += fld;
+                break;
+
+            case 'r':
+                keySet.clear();
+                arenas[op.id].reverseLookup(keySet, op.fld);
+                *pSum += keySet.size();
+                break;
+        }
+    }
+
+    const std::chrono::duration<double> elapsed = TClock::now() - start;
+    return elapsed.count();
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<std::pair<std::string, TTrace> > traces;
+    for (int i = 1; i < argc; ++i) {
+        traces.push_back(std::make_pair(std::string(argv[i]), TTrace()));
+        if (!readTrace(traces.back().second, argv[i]))
+            return EXIT_FAILURE;
+    }
+
+    if (traces.empty()) {
+        traces.push_back(std::make_pair(std::string("synthetic"), TTrace()));
+        synthTrace(traces.back().second, /* cntObjs */ 0x4000);
+
+        traces.push_back(std::make_pair(std::string("synthetic-array"),
+                    TTrace()));
+        synthArrayTrace(traces.back().second, /* cntElems */ 0x4000,
+                /* cntOps */ 50000U);
+    }
+
+    printf("%-32s %10s %10s %10s %8s\n",
+            "trace", "ops", "map [s]", "tree [s]", "speedup");
+
+    for (const std::pair<std::string, TTrace> &item : traces) {
+        const TTrace &trace = item.second;
+        unsigned long sumMap = 0UL, sumTree = 0UL;
+        const double tMap = replay<TMapArena>(trace, &sumMap);
+        const double tTree = replay<TTreeArena>(trace, &sumTree);
+        if (sumMap != sumTree) {
+            fprintf(stderr, "results do not match for %s\n",
+                    item.first.c_str());
+            return EXIT_FAILURE;
+        }
+
+        printf("%-32s %10zu %10.3f %10.3f %7.2fx\n", item.first.c_str(),
+                trace.size(), tMap, tTree, tMap / tTree);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,309 @@
+/*
+ * Copyright (C) 2026 Kamil Dudka <kdudka@redhat.com>
+ *
+ * This file is part of predator.
+ *
+ * predator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * predator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with predator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file bench_symjoin.cc
+ * micro-benchmark of the containers of SymJoinCtx (the join cache and the work
+ * list of value pairs) reused from a scratch arena against the original ones
+ * created for each join, replaying traces recorded with SJ_RECORD_TRACE
+ *
+ * Usage: bench_symjoin [TRACE_FILE...]
+ *
+ * To record a trace, set SJ_RECORD_TRACE to 1 in sl/symjoin.cc, rebuild sl,
+ * and run the analyzer on a test-case (e.g. from tests/predator-regre).  The
+ * trace is written to symjoin-trace.txt in the current directory.  If no trace
+ * is given, a synthetic trace resembling joins of linked lists is used.
+ */
+
+#include "config.h"
+#include "scratch.hh"
+#include "worklist.hh"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+
+/// stand-in for SchedItem, with field IDs instead of field handles
+struct Item {
+    long        fldDst;
+    long        fld1;
+    long        fld2;
+    int         ldiff;
+};
+
+inline bool operator<(const Item &a, const Item &b)
+{
+    RETURN_IF_COMPARED(a, b, fldDst);
+    RETURN_IF_COMPARED(a, b, fld1);
+    RETURN_IF_COMPARED(a, b, fld2);
+    return (a.ldiff < b.ldiff);
+}
+
+inline bool operator==(const Item &a, const Item &b)
+{
+    return (a.fldDst == b.fldDst)
+        && (a.fld1 == b.fld1)
+        && (a.fld2 == b.fld2)
+        && (a.ldiff == b.ldiff);
+}
+
+struct ItemHash {
+    size_t operator()(const Item &item) const {
+        size_t seed = 0;
+        boost::hash_combine(seed, item.fldDst);
+        boost::hash_combine(seed, item.fld1);
+        boost::hash_combine(seed, item.fld2);
+        boost::hash_combine(seed, item.ldiff);
+        return seed;
+    }
+};
+
+typedef std::pair<long, long>                       TPair;
+
+/// the original containers of SymJoinCtx, created for each join
+struct MapCtx {
+    WorkList<Item>                                  wl;
+    std::map<TPair, long>                           joinCache;
+};
+
+/// the containers of SymJoinCtx taken from a scratch arena
+struct ScratchCtx {
+    ScratchWorkList<Item, ItemHash>                 wl;
+    ScratchHashMap<TPair, long, boost::hash<TPair> > joinCache;
+};
+
+/// a single recorded operation on a join context
+struct Op {
+    char        code;
+    long        id;
+    long        v1;
+    long        v2;
+    Item        item;
+};
+
+typedef std::vector<Op>                             TTrace;
+
+bool readTrace(TTrace &dst, const char *fileName)
+{
+    std::ifstream str(fileName);
+    if (!str) {
+        fprintf(stderr, "failed to open %s\n", fileName);
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(str, line)) {
+        std::istringstream ls(line);
+        Op op = { 0, 0L, 0L, 0L, { 0L, 0L, 0L, 0 } };
+        ls >> op.code >> op.id;
+        switch (op.code) {
+            case 'c':
+            case 'l':
+                ls >> op.v1 >> op.v2;
+                break;
+
+            case 's':
+                ls >> op.item.fldDst >> op.item.fld1 >> op.item.fld2
+                    >> op.item.ldiff;
+                break;
+
+            case 'b':
+            case 'e':
+            case 'n':
+                break;
+
+            default:
+                fprintf(stderr, "unknown operation in %s: %s\n",
+                        fileName, line.c_str());
+                return false;
+        }
+
+        dst.push_back(op);
+    }
+
+    return true;
+}
+
+/// generate operations similar to those of joins of two linked lists
+void synthTrace(TTrace &dst, const unsigned cntJoins)
+{
+    std::mt19937 gen(/* seed */ 7U);
+
+    for (unsigned j = 0U; j < cntJoins; ++j) {
+        const long id = 1L + j;
+        dst.push_back(Op{ 'b', id, 0L, 0L, { 0L, 0L, 0L, 0 } });
+        dst.push_back(Op{ 'c', id, 0L, 0L, { 0L, 0L, 0L, 0 } });
+
+        // lists of 1..64 nodes with 2..4 fields each
+        const unsigned cntNodes = 1U + gen() % 64U;
+        const unsigned cntFlds = 2U + gen() % 3U;
+        long v = 0x100L;
+        for (unsigned n = 0U; n < cntNodes; ++n) {
+            for (unsigned f = 0U; f < cntFlds; ++f) {
+                const long fld = n * cntFlds + f;
+                const Item item = { 3 * fld, 3 * fld + 1, 3 * fld + 2, 0 };
+                dst.push_back(Op{ 's', id, 0L, 0L, item });
+
+                // some of the fields are scheduled more than once
+                if (!(gen() % 4U))
+                    dst.push_back(Op{ 's', id, 0L, 0L, item });
+            }
+
+            for (unsigned f = 0U; f < cntFlds; ++f) {
+                dst.push_back(Op{ 'n', id, 0L, 0L, { 0L, 0L, 0L, 0 } });
+                ++v;
+                dst.push_back(Op{ 'l', id, v, v + 1L, { 0L, 0L, 0L, 0 } });
+                dst.push_back(Op{ 'c', id, v, v + 1L, { 0L, 0L, 0L, 0 } });
+                const long vOld = v - static_cast<long>(gen() % 8U);
+                dst.push_back(Op{ 'l', id, vOld, v, { 0L, 0L, 0L, 0 } });
+            }
+        }
+
+        dst.push_back(Op{ 'n', id, 0L, 0L, { 0L, 0L, 0L, 0 } });
+        dst.push_back(Op{ 'e', id, 0L, 0L, { 0L, 0L, 0L, 0 } });
+    }
+}
+
+/// obtain a new MapCtx for each join
+struct MapCtxPool {
+    MapCtx* acquire() {
+        return new MapCtx;
+    }
+
+    void release(MapCtx *ctx) {
+        delete ctx;
+    }
+};
+
+/// reuse ScratchCtx objects like JoinScratchLease in sl/symjoin.cc does
+struct ScratchCtxPool {
+    std::vector<std::unique_ptr<ScratchCtx> >       free;
+
+    ScratchCtx* acquire() {
+        if (free.empty())
+            return new ScratchCtx;
+
+        ScratchCtx *ctx = free.back().release();
+        free.pop_back();
+        return ctx;
+    }
+
+    void release(ScratchCtx *ctx) {
+        ctx->wl.clear();
+        ctx->joinCache.clear();
+        free.emplace_back(ctx);
+    }
+};
+
+template <class TCtx, class TPool>
+double replay(const TTrace &trace, unsigned long *pSum)
+{
+    TPool pool;
+    std::unordered_map<long, TCtx *> live;
+
+    typedef std::chrono::steady_clock TClock;
+    const TClock::time_point start = TClock::now();
+
+    for (const Op &op : trace) {
+        switch (op.code) {
+            case 'b':
+                live[op.id] = pool.acquire();
+                continue;
+
+            case 'e':
+                pool.release(live[op.id]);
+                live.erase(op.id);
+                continue;
+        }
+
+        TCtx *ctx = live[op.id];
+        const TPair vp(op.v1, op.v2);
+        Item item;
+        switch (op.code) {
+            case 's':
+                if (ctx->wl.schedule(op.item))
+                    ++(*pSum);
+                break;
+
+            case 'n':
+                if (ctx->wl.next(item))
+                    *pSum += item.fld1;
+                break;
+
+            case 'c':
+                ctx->joinCache[vp] = op.v1 ^ op.v2;
+                break;
+
+            case 'l':
+                if (ctx->joinCache.end() != ctx->joinCache.find(vp))
+                    ++(*pSum);
+                break;
+        }
+    }
+
+    const std::chrono::duration<double> elapsed = TClock::now() - start;
+    return elapsed.count();
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<std::pair<std::string, TTrace> > traces;
+    for (int i = 1; i < argc; ++i) {
+        traces.push_back(std::make_pair(std::string(argv[i]), TTrace()));
+        if (!readTrace(traces.back().second, argv[i]))
+            return EXIT_FAILURE;
+    }
+
+    if (traces.empty()) {
+        traces.push_back(std::make_pair(std::string("synthetic"), TTrace()));
+        synthTrace(traces.back().second, /* cntJoins */ 0x8000);
+    }
+
+    printf("%-32s %10s %10s %10s %8s\n",
+            "trace", "ops", "map [s]", "hash [s]", "speedup");
+
+    for (const std::pair<std::string, TTrace> &item : traces) {
+        const TTrace &trace = item.second;
+        unsigned long sumMap = 0UL, sumHash = 0UL;
+        const double tMap =
+            replay<MapCtx, MapCtxPool>(trace, &sumMap);
+        const double tHash =
+            replay<ScratchCtx, ScratchCtxPool>(trace, &sumHash);
+        if (sumMap != sumHash) {
+            fprintf(stderr, "results do not match for %s\n",
+                    item.first.c_str());
+            return EXIT_FAILURE;
+        }
+
+        printf("%-32s %10zu %10.3f %10.3f %7.2fx\n", item.first.c_str(),
+                trace.size(), tMap, tHash, tMap / tHash);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -26,18 +26,26 @@
 #include <cl/storage.hh>
 
 #include "fixed_point_proxy.hh"
+#include "forkpool.hh"
 #include "glconf.hh"
+#include "mempool.hh"
+#include "plotwriter.hh"
+#include "symbin.hh"
 #include "symbt.hh"
 #include "symdump.hh"
 #include "symexec.hh"
 #include "symproc.hh"
+#include "symprof.hh"
 #include "symstate.hh"
+#include "symsummary.hh"
 #include "symtrace.hh"
 #include "symutil.hh"
 #include "util.hh"
 
+#include <algorithm>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 // required by the gcc plug-in API
 extern "C" {
@@ -75,7 +83,7 @@ void digGlJunk(SymHeap &sh)
     destroyProgVars(proc);
 }
 
-void execFnc(const CodeStorage::Fnc &fnc, bool lookForGlJunk = false)
+void execFncCore(const CodeStorage::Fnc &fnc, bool lookForGlJunk)
 {
     const CodeStorage::Storage &stor = *fnc.stor;
     const struct cl_loc *lw = locationOf(fnc);
@@ -110,25 +118,130 @@ void execFnc(const CodeStorage::Fnc &fnc, bool lookForGlJunk = false)
     }
 }
 
+void execFnc(const CodeStorage::Fnc &fnc, bool lookForGlJunk = false)
+{
+    if (!GlConf::data.traceFree) {
+        execFncCore(fnc, lookForGlJunk);
+        return;
+    }
+
+    // run without the trace graph and hold the messages until we are done
+    cl_msg_list msgs;
+    cl_msg_capture(&msgs);
+    try {
+        execFncCore(fnc, lookForGlJunk);
+    }
+    catch (const Trace::TraceRequiredException &) {
+        // drop the messages and start over with the trace graph
+        cl_msg_capture(0);
+        CL_DEBUG_MSG(locationOf(fnc), "re-running " << nameOf(fnc)
+                << "() with the trace graph to obtain a trace");
+
+        GlConf::data.traceFree = false;
+        execFncCore(fnc, lookForGlJunk);
+        GlConf::data.traceFree = true;
+        return;
+    }
+    catch (...) {
+        cl_msg_capture(0);
+        cl_msg_replay(msgs);
+        throw;
+    }
+
+    cl_msg_capture(0);
+    cl_msg_replay(msgs);
+}
+
+void execVirtualRoot(const CodeStorage::Fnc &fnc)
+{
+    const struct cl_loc *lw = locationOf(fnc);
+    CL_DEBUG_MSG(lw, nameOf(fnc)
+            << "() is defined, but not called from anywhere");
+
+    // perform symbolic execution for a virtual root
+    execFnc(fnc);
+    printMemUsage("execFnc");
+}
+
+typedef std::vector<const CodeStorage::Fnc *>        TFncPtrList;
+
+void execVirtualRootsInWorkers(const TFncPtrList &fncs)
+{
+    const GlConf::Options &opts = GlConf::data;
+    CL_DEBUG("executing " << fncs.size() << " virtual roots using "
+            << opts.rootWorkers << " worker processes");
+
+    const ForkPool::TJob job = [&fncs](unsigned idx) {
+        execVirtualRoot(*fncs[idx]);
+
+        // nothing but messages survives the worker process, plot traces now
+        if (Trace::Globals::alive())
+            Trace::Globals::instance()->glProxy()->plotAll();
+
+        // the background thread of PlotWriter dies with the worker process
+        PlotWriter::flush();
+    };
+
+    const ForkPool::TDone done = [&fncs, &opts](unsigned idx,
+            EForkJobStatus status)
+    {
+        const CodeStorage::Fnc &fnc = *fncs[idx];
+        const struct cl_loc *lw = locationOf(fnc);
+        switch (status) {
+            case FJS_DONE:
+                break;
+
+            case FJS_TIMED_OUT:
+                CL_WARN_MSG(lw, "time limit of " << opts.rootTimeLimit
+                        << " s exceeded while analysing " << nameOf(fnc)
+                        << "()");
+                break;
+
+            case FJS_CRASHED:
+                CL_ERROR_MSG(lw, "worker process crashed while analysing "
+                        << nameOf(fnc) << "()");
+                break;
+        }
+    };
+
+    // the workers cannot wait for plots queued by the parent process
+    PlotWriter::flush();
+
+    ForkPool pool(opts.rootWorkers, opts.rootTimeLimit);
+    pool.runAll(fncs.size(), job, done);
+}
+
 void execVirtualRoots(const CodeStorage::Storage &stor)
 {
     namespace CG = CodeStorage::CallGraph;
 
     // go through all root nodes
+    TFncPtrList fncs;
     const CG::Graph &cg = stor.callGraph;
     for (const CG::Node *node : cg.roots) {
         const CodeStorage::Fnc &fnc = *node->fnc;
-        if (!isDefined(fnc))
-            continue;
-
-        const struct cl_loc *lw = locationOf(fnc);
-        CL_DEBUG_MSG(lw, nameOf(fnc)
-                << "() is defined, but not called from anywhere");
+        if (isDefined(fnc))
+            fncs.push_back(&fnc);
+    }
 
-        // perform symbolic execution for a virtual root
-        execFnc(fnc);
-        printMemUsage("execFnc");
+    // cg.roots is ordered by addresses, make the order of messages stable
+    std::sort(fncs.begin(), fncs.end(),
+            [](const CodeStorage::Fnc *a, const CodeStorage::Fnc *b) {
+                return uidOf(*a) < uidOf(*b);
+            });
+
+    const GlConf::Options &opts = GlConf::data;
+    if ((1 < opts.rootWorkers || opts.rootTimeLimit)
+            && !opts.fixedPoint && !opts.summaryStore
+            && opts.plotArchive.empty())
+    {
+        // the virtual roots are independent of each other
+        execVirtualRootsInWorkers(fncs);
+        return;
     }
+
+    for (const CodeStorage::Fnc *fnc : fncs)
+        execVirtualRoot(*fnc);
 }
 
 void launchSymExec(const CodeStorage::Storage &stor)
@@ -165,17 +278,54 @@ void clEasyRun(const CodeStorage::Storage &stor, const char *configString)
 {
     initSymDump(stor);
 
+    // print per-kind usage of the memory pools along with the memory usage
+    registerMemUsageDetail(MemPool::printUsage);
+
     // read parameters of symbolic execution
     GlConf::loadConfigString(configString);
 
+    GlConf::Options &opts = GlConf::data;
+    if (opts.traceFree && (opts.fixedPoint || opts.detectContainers)) {
+        // these map objects of the heaps along the trace graph
+        CL_WARN("option no_trace is not compatible with dump_fixed_point "
+                "and detect_containers, ignoring it");
+        opts.traceFree = false;
+    }
+
+    if ((1 < opts.rootWorkers || opts.rootTimeLimit)
+            && (opts.timeBudget || opts.memBudget))
+    {
+        // the blocks and functions reached by workers are not known here
+        CL_WARN("options root_workers and root_time_limit are not compatible "
+                "with time_budget and mem_budget, ignoring them");
+        opts.rootWorkers = 1;
+        opts.rootTimeLimit = 0;
+    }
+
+    SymSummaryStore *const summaryStore = GlConf::data.summaryStore;
+    if (summaryStore)
+        // load function call summaries computed by the previous runs
+        summaryStore->load(stor);
+
+    // resolve calls of built-in functions once per function uid
+    resolveBuiltIns(stor);
+
     // run symbolic execution
+    startBudgets();
     try {
         launchSymExec(stor);
     }
+    catch (const BudgetExhaustedException &e) {
+        // anytime mode: the errors found so far have been already reported
+        printIncompleteVerdict(stor, e);
+    }
     catch (const std::runtime_error &e) {
         CL_DEBUG("clEasyRun() caught a run-time exception: " << e.what());
     }
 
+    // write the profile of symbolic execution if requested
+    Profiler::dump();
+
     FixedPoint::StateByInsn *const fixedPoint = GlConf::data.fixedPoint;
     if (fixedPoint) {
         // plot fixed-point
@@ -184,6 +334,14 @@ void clEasyRun(const CodeStorage::Storage &stor, const char *configString)
         printMemUsage("FixedPoint::StateByInsn::~StateByInsn");
     }
 
+    if (summaryStore) {
+        // write back the function call summaries computed by this run
+        summaryStore->save();
+        summaryStore->printStats();
+        delete summaryStore;
+        GlConf::data.summaryStore = 0;
+    }
+
     if (Trace::Globals::alive()) {
         // plot all pending trace graphs
         Trace::GraphProxy *glProxy = Trace::Globals::instance()->glProxy();
@@ -194,5 +352,13 @@ void clEasyRun(const CodeStorage::Storage &stor, const char *configString)
         printMemUsage("Trace::Globals::cleanup");
     }
 
+    // wait for the heap plots to be written
+    PlotWriter::stop();
+
+    printSymStateStats();
+
+    // release the memory pools of heap entities and trace nodes
+    MemPool::reset();
+    registerMemUsageDetail(0);
     printPeakMemUsage();
 }
@@ -143,6 +143,11 @@
  * - 1 ... use DFS scheduler, keep already scheduled blocks at their position
  * - 2 ... use DFS scheduler, move already scheduled blocks to front of queue
  * - 3 ... use load-driven scheduler (picks the one with fewer pending heaps)
+ * - 4 ... pick blocks in reverse post-order of the control flow graph
+ * - 5 ... pick blocks nested in the deepest loop first
+ * - 6 ... postpone loop entries until the loop bodies have been processed
+ *
+ * The default can be overridden at run-time by the block_scheduler option.
  */
 #define SE_BLOCK_SCHEDULER_KIND             2
 
@@ -231,11 +236,32 @@
  */
 #define SE_FORBID_HEAP_REPLACE              0
 
+/**
+ * count of seconds a worker process executing a virtual root is given to stop
+ * after SIGTERM once the root_time_limit is exceeded, before it is killed
+ */
+#define SE_FORK_POOL_KILL_GRACE             5
+
+/**
+ * - 0 ... walk backwards from each junk candidate looking for a root object
+ * - 1 ... mark all objects reachable from root objects, then sweep
+ * - 2 ... walk backwards, but visit each object at most once per collection
+ *
+ * The default can be overridden at run-time by the garbage_collector option.
+ */
+#define SE_GARBAGE_COLLECTOR_KIND           0
+
 /**
  * the highest integral number we can count to (only partial implementation atm)
  */
 #define SE_INT_ARITHMETIC_LIMIT             10
 
+/**
+ * maximal count of failed joins (and of heaps they refer to) remembered by the
+ * join cache to skip joinSymHeaps() on the same pair of heaps, 0 to disable it
+ */
+#define SE_JOIN_CACHE_SIZE                  0x400
+
 /**
  * - -1 ... never join, never check for entailment, always check for isomorphism
  * - 0 ... join states on each basic block entry
@@ -250,11 +276,23 @@
  */
 #define SE_MAX_CALL_DEPTH                   0x40
 
+/**
+ * minimal time in milliseconds between two checks of the memory usage against
+ * the memory budget given by the option mem_budget
+ */
+#define SE_MEM_BUDGET_CHECK_INTERVAL        50
+
 /**
  * if non-zero, plot each state that caused an error to be reported
  */
 #define SE_PLOT_ERROR_STATES                0
 
+/**
+ * count of bytes of rendered heap plots waiting for PlotWriter, above which
+ * the analysis waits for the plots to be written
+ */
+#define SE_PLOT_QUEUE_LIMIT                 0x4000000
+
 /**
  * preserve heaps with different DLS minimum lengths up to the specified number
  */
@@ -325,6 +363,16 @@
  */
 #define SH_PREVENT_AMBIGUOUS_ENT_ID         1
 
+/**
+ * if 1, allocate heap entities and trace nodes from size-class memory pools
+ */
+#define SH_MEM_POOL                         1
+
+/**
+ * count of entity pointers per chunk of EntStore, shared on copy of SymHeap
+ */
+#define SH_ENT_STORE_CHUNK_SIZE             0x40
+
 /**
  * if more than zero, jump to debugger as soon as N graph of the same name has
  * been plotted
@@ -145,8 +145,6 @@ void TraceIndex::nearestPredecessorOf(
     }
 }
 
-typedef StateByInsn::TStateMap                      TStateMap;
-
 typedef CleanList<LocalState>                       TStateList;
 typedef CleanList<TraceEdge>                        TTraceList;
 typedef std::map<TInsn, TLocIdx>                    TInsnLookup;
@@ -155,7 +153,7 @@ void loadHeaps(
         TStateList                 *pStateList,
         TInsnLookup                *pInsnLookup,
         const TFnc                  fnc,
-        const TStateMap            &stateMap)
+        const StateByInsn          &stateByInsn)
 {
     typedef WorkList<TBlock> TWorkList;
 
@@ -192,9 +190,9 @@ void loadHeaps(
             (*pInsnLookup)[insn] = locIdx;
 
             // load heaps if a non-empty fixed-point is available for this loc
-            const TStateMap::const_iterator it = stateMap.find(insn);
-            if (it != stateMap.end()) {
-                locState->heapList = it->second;
+            const SymState *state = stateByInsn.stateOf(insn);
+            if (state) {
+                locState->heapList = *state;
                 Trace::waiveCloneOperation(locState->heapList);
             }
 
@@ -550,7 +548,7 @@ bool /* found any */ implyContShapesFromTrace(GlobalState &glState)
     return foundAny;
 }
 
-GlobalState* computeStateOf(const TFnc fnc, const TStateMap &stateByInsn)
+GlobalState* computeStateOf(const TFnc fnc, const StateByInsn &stateByInsn)
 {
     GlobalState *glState = new GlobalState;
 
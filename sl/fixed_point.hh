@@ -154,8 +154,7 @@ class GlobalState {
         GlobalState(const GlobalState &);
         GlobalState& operator=(const GlobalState &);
 
-        friend GlobalState* computeStateOf(const TFnc,
-                const StateByInsn::TStateMap &);
+        friend GlobalState* computeStateOf(const TFnc, const StateByInsn &);
 
         friend void exportControlFlow(GlobalState *pDst,
                 const GlobalState &glState);
@@ -172,8 +171,11 @@ SymHeap *heapByIdent(GlobalState &, THeapIdent);
 /// return shape of the given state by its identity
 const Shape *shapeByIdent(const GlobalState &, const TShapeIdent &);
 
+/// true for insns that have no location in the fixed-point (COND and JMP)
+bool isTransparentInsn(TInsn);
+
 /// caller is responsible to destroy the returned instance
-GlobalState* computeStateOf(TFnc, const StateByInsn::TStateMap &);
+GlobalState* computeStateOf(TFnc, const StateByInsn &);
 
 /// write the CFG-only skeleton of glState into *pDst
 void exportControlFlow(GlobalState *pDst, const GlobalState &glState);
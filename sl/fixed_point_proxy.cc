@@ -28,7 +28,9 @@
 #include "cont_shape_var.hh"
 #include "fixed_point.hh"
 #include "glconf.hh"
+#include "symbt.hh"
 #include "symplot.hh"
+#include "symproc.hh"
 #include "symtrace.hh"
 
 #include <cl/cl_msg.hh>
@@ -38,6 +40,8 @@
 #include <fstream>
 #include <iomanip>
 #include <map>
+#include <typeinfo>
+#include <vector>
 
 namespace FixedPoint {
 
@@ -50,13 +54,23 @@ typedef std::map<TFncUid, TFnc>                     TFncMap;
 typedef const CodeStorage::Block                   *TBlock;
 
 struct StateByInsn::Private {
+    bool                compact;
     TFncMap             visitedFncs;
     TStateMap           stateByInsn;
+
+    // used only in the compact mode
+    TStateMap           nestedByInsn;   ///< heaps of recursive calls
+    TBlock              rebuiltBlock;   ///< block whose states are rebuilt
+    TStateMap           rebuilt;        ///< states of insns of rebuiltBlock
+
+    void rebuildBlock(TBlock bb);
 };
 
-StateByInsn::StateByInsn():
+StateByInsn::StateByInsn(bool compact):
     d(new Private)
 {
+    d->compact = compact;
+    d->rebuiltBlock = 0;
 }
 
 StateByInsn::~StateByInsn()
@@ -64,34 +78,216 @@ StateByInsn::~StateByInsn()
     delete d;
 }
 
-bool /* any change */ StateByInsn::insert(const TInsn insn, const SymHeap &sh)
+/// true if the heaps at insn cannot be reconstructed from the preceding insn
+bool isAnchorInsn(const TInsn insn)
 {
-    SymStateWithJoin &state = d->stateByInsn[insn];
+    const TBlock bb = insn->bb;
+    if (bb->front() == insn)
+        // entry of a basic block (including loop heads)
+        return true;
+
+    const unsigned cnt = bb->size();
+    for (unsigned idx = 1U; idx < cnt; ++idx)
+        if (bb->operator[](idx) == insn)
+            // results of a call are not computed by SymExecCore
+            return (CL_INSN_CALL == bb->operator[](idx - 1U)->code);
+
+    CL_BREAK_IF("isAnchorInsn() got an insn not found in its basic block");
+    return true;
+}
 
-    if (!state.size()) {
+bool /* any change */ StateByInsn::insert(
+        const TInsn                 insn,
+        const SymHeap              &sh,
+        const int                   nestLevel)
+{
+    const TFnc fnc = fncByCfg(insn->bb->cfg());
+    const TFncUid uid = uidOf(*fnc);
+    if (!hasKey(d->visitedFncs, uid))
         // update the map of visited functions
-        const TFnc fnc = fncByCfg(insn->bb->cfg());
-        const TFncUid uid = uidOf(*fnc);
         d->visitedFncs[uid] = fnc;
+
+    if (d->compact) {
+        if (1 < nestLevel)
+            // SymExecCore would need the full backtrace to execute these
+            return d->nestedByInsn[insn].insert(sh, /* allowThreeWay */ false);
+
+        if (!isAnchorInsn(insn))
+            // to be reconstructed by stateOf() on demand
+            return false;
     }
 
+    SymStateWithJoin &state = d->stateByInsn[insn];
     return state.insert(sh, /* allowThreeWay */ false);
 }
 
-const StateByInsn::TStateMap& StateByInsn::stateMap() const
+/// true if both trace nodes stand for the same operation
+bool isSameTraceOp(const Trace::Node *tr1, const Trace::Node *tr2)
+{
+    if (typeid(*tr1) != typeid(*tr2))
+        return false;
+
+    using Trace::InsnNode;
+    const InsnNode *insnNode1 = dynamic_cast<const InsnNode *>(tr1);
+    if (!insnNode1)
+        return true;
+
+    const InsnNode *insnNode2 = static_cast<const InsnNode *>(tr2);
+    return (insnNode1->insn() == insnNode2->insn());
+}
+
+/**
+ * return the trace node created when the insn was executed by SymExecEngine
+ * that corresponds to tr, which has been created by executing the insn once
+ * again on a heap whose trace node was origin, 0 if not found
+ */
+Trace::Node* origTraceOf(Trace::Node *tr, const Trace::Node *origin)
+{
+    // collect the trace nodes created by the re-execution
+    std::vector<Trace::Node *> path;
+    for (; tr != origin; tr = tr->parent()) {
+        if (1U != tr->parents().size())
+            // not a linear path to origin
+            return 0;
+
+        path.push_back(tr);
+    }
+
+    // walk down the same path in the original trace graph
+    const Trace::Node *orig = origin;
+    Trace::Node *found = 0;
+    for (unsigned i = path.size(); i; --i) {
+        const Trace::Node *tpl = path[i - 1U];
+        found = 0;
+        for (Trace::NodeBase *child : orig->children()) {
+            Trace::Node *node = dynamic_cast<Trace::Node *>(child);
+            if (node && node != tpl && isSameTraceOp(node, tpl)) {
+                found = node;
+                break;
+            }
+        }
+
+        if (!found)
+            return 0;
+
+        orig = found;
+    }
+
+    return found;
+}
+
+void StateByInsn::Private::rebuildBlock(const TBlock bb)
+{
+    this->rebuiltBlock = bb;
+    this->rebuilt.clear();
+
+    const TFnc fnc = fncByCfg(bb->cfg());
+    TStorRef stor = *fnc->stor;
+    SymBackTrace bt(stor);
+    bt.pushCall(uidOf(*fnc), /* loc */ 0);
+
+    SymExecCoreParams ep(GlConf::data);
+    ep.skipPlot = true;
+
+    // errors have been already reported while executing the insns originally
+    cl_msg_list msgs;
+    cl_msg_capture(&msgs);
+
+    const SymState *src = 0;
+    TInsn srcInsn = 0;
+    for (const TInsn insn : *bb) {
+        if (isTransparentInsn(insn))
+            // no heaps captured for this insn
+            break;
+
+        SymStateWithJoin &dst = this->rebuilt[insn];
+        const TStateMap::const_iterator it = this->stateByInsn.find(insn);
+        if (it != this->stateByInsn.end()) {
+            // captured heaps
+            src = &it->second;
+            srcInsn = insn;
+            dst = it->second;
+            Trace::waiveCloneOperation(dst);
+            continue;
+        }
+
+        if (!src) {
+            // no heaps to start with
+            srcInsn = insn;
+            continue;
+        }
+
+        for (const SymHeap *origin : *src) {
+            if (origin->exitPoint())
+                // SymExecEngine does not execute these
+                continue;
+
+            SymHeap sh(*origin);
+            Trace::waiveCloneOperation(sh);
+            const Trace::Node *trOrigin = sh.traceNode();
+
+            SymHeapList results;
+            SymExecCore core(sh, &bt, ep);
+            core.setLocation(&srcInsn->loc);
+            if (!core.exec(results, *srcInsn))
+                // CL_INSN_CALL is always followed by an anchor insn
+                CL_BREAK_IF("StateByInsn: unable to reconstruct a state");
+
+            for (SymHeap *res : results) {
+                // reuse the trace nodes of the original execution if possible
+                // so that the trace leads to the heaps of successor blocks
+                Trace::Node *tr = origTraceOf(res->traceNode(), trOrigin);
+                if (tr)
+                    res->traceUpdate(tr);
+
+                dst.insert(*res, /* allowThreeWay */ false);
+            }
+        }
+
+        src = &dst;
+        srcInsn = insn;
+    }
+
+    cl_msg_capture(0);
+
+    // add the heaps of recursive calls, which are not reconstructed
+    for (TStateMap::reference item : this->rebuilt) {
+        const TStateMap &nested = this->nestedByInsn;
+        const TStateMap::const_iterator it = nested.find(item.first);
+        if (it == nested.end())
+            continue;
+
+        for (const SymHeap *sh : it->second)
+            item.second.insert(*sh, /* allowThreeWay */ false);
+    }
+}
+
+const SymState* StateByInsn::stateOf(const TInsn insn) const
 {
-    return d->stateByInsn;
+    TStateMap *pMap = &d->stateByInsn;
+    if (d->compact) {
+        if (d->rebuiltBlock != insn->bb)
+            d->rebuildBlock(insn->bb);
+
+        pMap = &d->rebuilt;
+    }
+
+    const TStateMap::const_iterator it = pMap->find(insn);
+    if (it == pMap->end())
+        return 0;
+
+    return &it->second;
 }
 
 struct PlotData {
     int                             subGraphIdx;
     std::ostream                   &out;
-    StateByInsn::TStateMap         &stateByInsn;
+    const StateByInsn              &stateByInsn;
     std::string                     name;
 
     PlotData(
             std::ostream           &out_,
-            StateByInsn::TStateMap &stateByInsn_,
+            const StateByInsn      &stateByInsn_,
             const std::string      &name_):
         subGraphIdx(0),
         out(out_),
@@ -404,7 +600,7 @@ void plotFixedPointOfFnc(PlotData &plot, const GlobalState &fncState)
     plotFncCore(plot, cfgResult);
 }
 
-void plotFnc(const TFnc fnc, StateByInsn::TStateMap &stateByInsn)
+void plotFnc(const TFnc fnc, const StateByInsn &stateByInsn)
 {
     const std::string fncName = nameOf(*fnc);
     std::string plotName("fp-");
@@ -453,7 +649,7 @@ void StateByInsn::plotAll()
         const TLoc loc = locationOf(*fnc);
         CL_NOTE_MSG(loc, "plotting fixed-point of " << nameOf(*fnc) << "()...");
 
-        plotFnc(fnc, d->stateByInsn);
+        plotFnc(fnc, *this);
     }
 }
 
@@ -22,7 +22,7 @@
 
 #include "symstate.hh"
 
-#include <map>
+#include <unordered_map>
 
 namespace CodeStorage {
     struct Insn;
@@ -34,14 +34,28 @@ namespace FixedPoint {
 
     class StateByInsn {
         public:
-            typedef std::map<TInsn, SymStateWithJoin> TStateMap;
+            typedef std::unordered_map<TInsn, SymStateWithJoin> TStateMap;
 
-            StateByInsn();
+            /**
+             * @param compact if true, heaps are captured only at entries of
+             * basic blocks (including loop heads) and after function calls,
+             * the states of the other instructions are reconstructed on
+             * demand by executing the instructions once again
+             */
+            StateByInsn(bool compact = false);
             ~StateByInsn();
 
-            bool /* any change */ insert(TInsn insn, const SymHeap &sh);
+            /**
+             * @param nestLevel count of occurrences of the function in the
+             * backtrace, heaps of recursive calls are always captured
+             */
+            bool /* any change */ insert(
+                    TInsn                   insn,
+                    const SymHeap          &sh,
+                    int                     nestLevel = 1);
 
-            const TStateMap& stateMap() const;
+            /// return the state captured for the instruction, 0 if none
+            const SymState* stateOf(TInsn insn) const;
 
             void plotAll();
 
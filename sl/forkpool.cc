@@ -0,0 +1,389 @@
+/*
+ * Copyright (C) 2026 Kamil Dudka <kdudka@redhat.com>
+ *
+ * This file is part of predator.
+ *
+ * predator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * predator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with predator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include "forkpool.hh"
+
+#include <cl/cl_msg.hh>
+
+#include "symexec.hh"
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// kinds of records sent from a worker process to the parent process
+enum ERecordKind {
+    RK_DEBUG        = 'D',
+    RK_NOTE         = 'N',
+    RK_WARN         = 'W',
+    RK_ERROR        = 'E',
+    RK_DONE         = 'S',          ///< the job has completed
+    RK_RUNTIME      = 'R',          ///< the job has thrown std::runtime_error
+    RK_BUDGET       = 'B'           ///< the job has thrown BudgetExhausted...
+};
+
+typedef std::chrono::steady_clock                   TClock;
+
+struct ForkJob {
+    pid_t                           pid;
+    int                             fd;
+    std::string                     data;       ///< raw records read so far
+    TClock::time_point              deadline;
+    bool                            termSent;
+    bool                            done;
+    bool                            crashed;
+
+    ForkJob():
+        pid(-1),
+        fd(-1),
+        termSent(false),
+        done(false),
+        crashed(false)
+    {
+    }
+};
+
+struct ForkPool::Private {
+    unsigned                        cntWorkers;
+    int                             timeLimit;
+    std::vector<ForkJob>            jobs;
+
+    void runChild(unsigned idx, const TJob &job, int fd);
+    void startJob(unsigned idx, const TJob &job);
+    void finishJob(ForkJob &fj);
+    void checkDeadline(ForkJob &fj, TClock::time_point now);
+    int pollTimeout(TClock::time_point now) const;
+    EForkJobStatus replay(const ForkJob &fj);
+    void killAll();
+};
+
+ForkPool::ForkPool(unsigned cntWorkers, int timeLimit):
+    d(new Private)
+{
+    d->cntWorkers = (cntWorkers) ? cntWorkers : 1U;
+    d->timeLimit = timeLimit;
+}
+
+ForkPool::~ForkPool()
+{
+    d->killAll();
+    delete d;
+}
+
+// write end of the pipe to the parent process (valid in a worker process only)
+static int childFd = -1;
+
+static void sendRecord(const char kind, const std::string &text)
+{
+    const uint32_t len = text.size();
+    std::string buf(1U, kind);
+    buf.append(reinterpret_cast<const char *>(&len), sizeof len);
+    buf.append(text);
+
+    // send the record right away so that it survives a crash of the worker
+    const char *data = buf.data();
+    size_t left = buf.size();
+    while (left) {
+        const ssize_t cnt = write(childFd, data, left);
+        if (cnt < 0) {
+            if (EINTR == errno)
+                continue;
+
+            _exit(EXIT_FAILURE);
+        }
+
+        data += cnt;
+        left -= cnt;
+    }
+}
+
+static char kindOfMsg(const struct cl_msg_item &item)
+{
+    if (item.fnc == cl_note)
+        return RK_NOTE;
+    if (item.fnc == cl_warn)
+        return RK_WARN;
+    if (item.fnc == cl_error)
+        return RK_ERROR;
+
+    return RK_DEBUG;
+}
+
+static void sendMsg(const struct cl_msg_item &item)
+{
+    sendRecord(kindOfMsg(item), item.text);
+}
+
+void ForkPool::Private::runChild(unsigned idx, const TJob &job, int fd)
+{
+    // stream all messages of the job to the parent process
+    childFd = fd;
+    cl_msg_stream(sendMsg);
+
+    char status = RK_DONE;
+    std::string what;
+    try {
+        job(idx);
+    }
+    catch (const BudgetExhaustedException &e) {
+        status = RK_BUDGET;
+        what = e.what();
+    }
+    catch (const std::exception &e) {
+        status = RK_RUNTIME;
+        what = e.what();
+    }
+
+    cl_msg_stream(0);
+    sendRecord(status, what);
+
+    // do not run any destructors or atexit() handlers of the host process
+    _exit(EXIT_SUCCESS);
+}
+
+void ForkPool::Private::startJob(unsigned idx, const TJob &job)
+{
+    ForkJob &fj = this->jobs[idx];
+
+    int fds[2];
+    if (pipe(fds))
+        throw std::runtime_error("ForkPool: pipe() failed");
+
+    const pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        throw std::runtime_error("ForkPool: fork() failed");
+    }
+
+    if (!pid) {
+        // worker process
+        close(fds[0]);
+        this->runChild(idx, job, fds[1]);
+    }
+
+    close(fds[1]);
+    fj.pid = pid;
+    fj.fd = fds[0];
+    fj.deadline = TClock::now() + std::chrono::seconds(this->timeLimit);
+}
+
+void ForkPool::Private::finishJob(ForkJob &fj)
+{
+    close(fj.fd);
+    fj.fd = -1;
+
+    int status;
+    while (waitpid(fj.pid, &status, 0) < 0 && EINTR == errno)
+        ;
+
+    fj.pid = -1;
+    fj.done = true;
+    fj.crashed = !WIFEXITED(status) || WEXITSTATUS(status);
+}
+
+void ForkPool::Private::checkDeadline(ForkJob &fj, TClock::time_point now)
+{
+    if (!this->timeLimit || now < fj.deadline)
+        return;
+
+    if (fj.termSent) {
+        // the worker has not stopped in time, shoot it down and wait for
+        // the end of its data without any deadline
+        kill(fj.pid, SIGKILL);
+        fj.deadline = TClock::time_point::max();
+        return;
+    }
+
+    // ask the worker to stop, see SymExecEngine::processPendingSignals()
+    kill(fj.pid, SIGTERM);
+    fj.termSent = true;
+    fj.deadline = now + std::chrono::seconds(SE_FORK_POOL_KILL_GRACE);
+}
+
+int ForkPool::Private::pollTimeout(TClock::time_point now) const
+{
+    if (!this->timeLimit)
+        return -1;
+
+    TClock::duration left = TClock::duration::max();
+    for (const ForkJob &fj : this->jobs) {
+        if (-1 == fj.fd || TClock::time_point::max() == fj.deadline)
+            // not running or already killed
+            continue;
+
+        if (fj.deadline <= now)
+            return 0;
+
+        if (fj.deadline - now < left)
+            left = fj.deadline - now;
+    }
+
+    if (TClock::duration::max() == left)
+        return -1;
+
+    using namespace std::chrono;
+    return 1 + duration_cast<milliseconds>(left).count();
+}
+
+EForkJobStatus ForkPool::Private::replay(const ForkJob &fj)
+{
+    const std::string &data = fj.data;
+    size_t pos = 0U;
+    while (pos + 1U + sizeof(uint32_t) <= data.size()) {
+        const char kind = data[pos];
+        uint32_t len;
+        memcpy(&len, data.data() + pos + 1U, sizeof len);
+        pos += 1U + sizeof len;
+        if (data.size() < pos + len)
+            // truncated record
+            break;
+
+        const std::string text(data, pos, len);
+        pos += len;
+
+        switch (kind) {
+            case RK_DEBUG:
+                cl_debug(text.c_str());
+                continue;
+
+            case RK_NOTE:
+                cl_note(text.c_str());
+                continue;
+
+            case RK_WARN:
+                cl_warn(text.c_str());
+                continue;
+
+            case RK_ERROR:
+                cl_error(text.c_str());
+                continue;
+
+            case RK_DONE:
+                return FJS_DONE;
+
+            case RK_RUNTIME:
+                if (fj.termSent)
+                    // stopped by us because of the time limit
+                    return FJS_TIMED_OUT;
+
+                this->killAll();
+                throw std::runtime_error(text);
+
+            case RK_BUDGET:
+                this->killAll();
+                throw BudgetExhaustedException(text);
+        }
+    }
+
+    // the worker has died without telling us how the job has ended
+    return (fj.termSent)
+        ? FJS_TIMED_OUT
+        : FJS_CRASHED;
+}
+
+void ForkPool::Private::killAll()
+{
+    for (ForkJob &fj : this->jobs) {
+        if (-1 == fj.pid)
+            continue;
+
+        kill(fj.pid, SIGKILL);
+        this->finishJob(fj);
+    }
+}
+
+void ForkPool::runAll(unsigned cnt, const TJob &job, const TDone &done)
+{
+    d->jobs.clear();
+    d->jobs.resize(cnt);
+
+    unsigned cntRunning = 0U;
+    unsigned next = 0U;
+    for (unsigned idx = 0U; idx < cnt; ++idx) {
+        // keep the workers busy
+        for (; cntRunning < d->cntWorkers && next < cnt; ++next, ++cntRunning)
+            d->startJob(next, job);
+
+        // wait for the job whose messages are to be emitted now
+        while (!d->jobs[idx].done) {
+            std::vector<struct pollfd> pfds;
+            std::vector<ForkJob *> running;
+            for (ForkJob &fj : d->jobs) {
+                if (-1 == fj.fd)
+                    continue;
+
+                const struct pollfd pfd = { fj.fd, POLLIN, 0 };
+                pfds.push_back(pfd);
+                running.push_back(&fj);
+            }
+
+            const int rv = poll(pfds.data(), pfds.size(),
+                    d->pollTimeout(TClock::now()));
+            if (rv < 0 && EINTR != errno)
+                throw std::runtime_error("ForkPool: poll() failed");
+
+            const TClock::time_point now = TClock::now();
+            for (unsigned i = 0U; i < pfds.size(); ++i) {
+                ForkJob &fj = *running[i];
+                if (pfds[i].revents) {
+                    char buf[0x1000];
+                    const ssize_t len = read(fj.fd, buf, sizeof buf);
+                    if (0 < len)
+                        fj.data.append(buf, len);
+                    else if (!len || EINTR != errno) {
+                        // end of data, the worker is done
+                        d->finishJob(fj);
+                        --cntRunning;
+                        continue;
+                    }
+                }
+
+                d->checkDeadline(fj, now);
+            }
+
+            // start the next jobs as soon as some workers are done
+            for (; cntRunning < d->cntWorkers && next < cnt; ++next)
+            {
+                d->startJob(next, job);
+                ++cntRunning;
+            }
+        }
+
+        // emit the messages received so far even if the worker has crashed
+        ForkJob &fj = d->jobs[idx];
+        EForkJobStatus status = d->replay(fj);
+        if (FJS_DONE == status && fj.crashed && !fj.termSent)
+            status = FJS_CRASHED;
+
+        // release the data as soon as possible
+        std::string().swap(fj.data);
+        done(idx, status);
+    }
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2026 Kamil Dudka <kdudka@redhat.com>
+ *
+ * This file is part of predator.
+ *
+ * predator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * predator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with predator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H_GUARD_FORK_POOL_H
+#define H_GUARD_FORK_POOL_H
+
+/**
+ * @file forkpool.hh
+ * ForkPool - a set of worker processes executing independent jobs
+ */
+
+#include <functional>
+
+/// how a job executed by ForkPool has ended
+enum EForkJobStatus {
+    FJS_DONE,           ///< the job has completed (or thrown an exception)
+    FJS_TIMED_OUT,      ///< the job has been stopped after the time limit
+    FJS_CRASHED         ///< the worker process has died unexpectedly
+};
+
+/**
+ * a set of forked worker processes executing independent jobs.  The messages
+ * emitted by the jobs are streamed from the workers to the parent process,
+ * which emits them in the order of the jobs, so that the output does not depend
+ * on the count of workers.  The messages of a worker that crashes or is killed
+ * are emitted up to that point.  Nothing but the messages is propagated from
+ * the workers back to the parent process.
+ */
+class ForkPool {
+    public:
+        /// a job executed in a worker process
+        typedef std::function<void (unsigned /* idx */)>       TJob;
+
+        /// called in the parent process once the messages of a job are out
+        typedef std::function<void (unsigned, EForkJobStatus)> TDone;
+
+        /**
+         * @param cntWorkers count of worker processes running at a time
+         * @param timeLimit count of seconds after which a job is stopped by
+         * SIGTERM (and killed by SIGKILL if it does not stop), 0 for no limit
+         */
+        ForkPool(unsigned cntWorkers, int timeLimit);
+        ~ForkPool();
+
+        /**
+         * execute job(0), ..., job(cnt - 1), each of them in a new worker
+         * process, and return as soon as all of them are done.  If a job
+         * throws std::runtime_error (or BudgetExhaustedException), the same
+         * exception is thrown in the parent process after emitting the
+         * messages of the job and the remaining jobs are killed, as if the
+         * jobs were executed one by one.
+         */
+        void runAll(unsigned cnt, const TJob &job, const TDone &done);
+
+    private:
+        // copying NOT allowed
+        ForkPool(const ForkPool &);
+        ForkPool& operator=(const ForkPool &);
+
+    private:
+        struct Private;
+        Private *d;
+};
+
+#endif /* H_GUARD_FORK_POOL_H */
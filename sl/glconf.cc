@@ -21,11 +21,17 @@
 #include "glconf.hh"
 
 #include "fixed_point_proxy.hh"
+#include "symgc.hh"
+#include "symprof.hh"
+#include "symstate.hh"
+#include "symsummary.hh"
 
 #include <cl/cl_msg.hh>
 
 #include <algorithm>
 #include <map>
+#include <stdexcept>
+#include <thread>
 #include <vector>
 
 #include <boost/algorithm/string/classification.hpp>
@@ -41,6 +47,7 @@ Options::Options():
     oomSimulation(false),
     memLeakIsError(false),
     skipUserPlots(false),
+    traceFree(false),
     errorRecoveryMode(SE_ERROR_RECOVERY_MODE),
     verifierErrorIsError(false),
     allowCyclicTraceGraph(SE_ALLOW_CYCLIC_TRACE_GRAPH),
@@ -51,7 +58,16 @@ Options::Options():
     stateLiveOrdering(SE_STATE_ON_THE_FLY_ORDERING),
     exitLeaks(SE_EXIT_LEAKS),
     detectContainers(false),
-    fixedPoint(0)
+    threads(1),
+    blockScheduler(SE_BLOCK_SCHEDULER_KIND),
+    garbageCollector(SE_GARBAGE_COLLECTOR_KIND),
+    timeBudget(0),
+    memBudget(0),
+    rootWorkers(1),
+    rootTimeLimit(0),
+    printStats(false),
+    fixedPoint(0),
+    summaryStore(0)
 {
 }
 
@@ -78,11 +94,21 @@ void assumeNoValue(const string &name, const string &value)
 
 void handleDumpFixedPoint(const string &name, const string &value)
 {
-    assumeNoValue(name, value);
-    if (data.fixedPoint)
-        CL_BREAK_IF("we are leaking an instance of FixedPoint::StateByInsn");
+    bool compact = ("compact" == value);
+    if (!compact && !value.empty())
+        CL_WARN("ignoring invalid value of option \"" << name << "\"");
+
+    if (compact && data.detectContainers) {
+        // the objects of the reconstructed heaps get new IDs, which would
+        // break the mapping of container shapes along the trace graph
+        CL_WARN("value \"compact\" is not supported with detect_containers"
+                ", ignoring it");
+        compact = false;
+    }
 
-    data.fixedPoint = new FixedPoint::StateByInsn;
+    // detect_containers implies dump_fixed_point, both of them may be given
+    delete data.fixedPoint;
+    data.fixedPoint = new FixedPoint::StateByInsn(compact);
 }
 
 void handleExitLeaks(const string &name, const string &value)
@@ -213,18 +239,182 @@ void handleNoPlot(const string &name, const string &value)
     data.skipUserPlots = true;
 }
 
+void handleNoTrace(const string &name, const string &value)
+{
+    assumeNoValue(name, value);
+    data.traceFree = true;
+
+    // user plots would include only the collapsed traces
+    data.skipUserPlots = true;
+}
+
 void handleOOM(const string &name, const string &value)
 {
     assumeNoValue(name, value);
     data.oomSimulation = true;
 }
 
+void handlePrintStats(const string &name, const string &value)
+{
+    assumeNoValue(name, value);
+    data.printStats = true;
+}
+
 void handleTrackUninit(const string &name, const string &value)
 {
     assumeNoValue(name, value);
     data.trackUninit = true;
 }
 
+void handleSummaryStore(const string &name, const string &value)
+{
+    if (value.empty()) {
+        CL_WARN("ignoring option \"" << name << "\" without a valid value");
+        return;
+    }
+
+    delete data.summaryStore;
+    data.summaryStore = new SymSummaryStore(value);
+}
+
+void handlePlotArchive(const string &name, const string &value)
+{
+    if (value.empty()) {
+        CL_WARN("ignoring option \"" << name << "\" without a valid value");
+        return;
+    }
+
+    data.plotArchive = value;
+}
+
+void handleProfile(const string &name, const string &value)
+{
+    if (value.empty()) {
+        CL_WARN("ignoring option \"" << name << "\" without a valid value");
+        return;
+    }
+
+    Profiler::enable(value);
+}
+
+void handleThreads(const string &name, const string &value)
+{
+    if (value.empty()) {
+        // use all the available CPUs
+        data.threads = std::thread::hardware_concurrency();
+        if (data.threads < 1)
+            data.threads = 1;
+        return;
+    }
+
+    try {
+        data.threads = boost::lexical_cast<int>(value);
+        if (data.threads < 1)
+            data.threads = 1;
+    }
+    catch (...) {
+        CL_WARN("ignoring option \"" << name << "\" with invalid value");
+        return;
+    }
+}
+
+void handleBudget(int *pDst, const string &name, const string &value)
+{
+    try {
+        *pDst = boost::lexical_cast<int>(value);
+        if (*pDst < 0)
+            throw std::out_of_range("negative budget");
+    }
+    catch (...) {
+        CL_WARN("ignoring option \"" << name << "\" with invalid value");
+        *pDst = 0;
+    }
+}
+
+void handleTimeBudget(const string &name, const string &value)
+{
+    handleBudget(&data.timeBudget, name, value);
+}
+
+void handleMemBudget(const string &name, const string &value)
+{
+    handleBudget(&data.memBudget, name, value);
+}
+
+void handleRootWorkers(const string &name, const string &value)
+{
+    if (value.empty()) {
+        // use all the available CPUs
+        data.rootWorkers = std::thread::hardware_concurrency();
+        if (data.rootWorkers < 1)
+            data.rootWorkers = 1;
+        return;
+    }
+
+    try {
+        data.rootWorkers = boost::lexical_cast<int>(value);
+        if (data.rootWorkers < 1)
+            data.rootWorkers = 1;
+    }
+    catch (...) {
+        CL_WARN("ignoring option \"" << name << "\" with invalid value");
+        return;
+    }
+}
+
+void handleRootTimeLimit(const string &name, const string &value)
+{
+    handleBudget(&data.rootTimeLimit, name, value);
+}
+
+void handleBlockScheduler(const string &name, const string &value)
+{
+    // look for the name of a scheduling policy first
+    for (int kind = 0; kind < BSK_LAST; ++kind) {
+        if (value != blockSchedulerName(EBlockSchedulerKind(kind)))
+            continue;
+
+        data.blockScheduler = kind;
+        return;
+    }
+
+    try {
+        const int kind = boost::lexical_cast<int>(value);
+        if (kind < 0 || BSK_LAST <= kind)
+            throw std::out_of_range("invalid block scheduler");
+
+        data.blockScheduler = kind;
+    }
+    catch (...) {
+        CL_WARN("ignoring option \"" << name << "\" with invalid value");
+        return;
+    }
+}
+
+void handleGarbageCollector(const string &name, const string &value)
+{
+    // look for the name of a garbage collector first
+    for (int kind = 0; kind < GCK_LAST; ++kind) {
+        if (value != garbageCollectorName(EGarbageCollectorKind(kind)))
+            continue;
+
+        data.garbageCollector = kind;
+        return;
+    }
+
+    try {
+        const int kind = boost::lexical_cast<int>(value);
+        if (kind < 0 || GCK_LAST <= kind)
+            throw std::out_of_range("invalid garbage collector");
+
+        data.garbageCollector = kind;
+    }
+    catch (...) {
+        CL_WARN("ignoring option \"" << name << "\" with invalid value");
+        return;
+    }
+}
+
 void handleDetectContainers(const string &name, const string &value)
 {
 #if !SH_PREVENT_AMBIGUOUS_ENT_ID
@@ -245,19 +435,31 @@ ConfigStringParser::ConfigStringParser()
 {
     tbl_["allow_cyclic_trace_graph"]= handleAllowCyclicTraceGraph;
     tbl_["allow_three_way_join"]    = handleAllowThreeWayJoin;
+    tbl_["block_scheduler"]         = handleBlockScheduler;
     tbl_["dump_fixed_point"]        = handleDumpFixedPoint;
     tbl_["detect_containers"]       = handleDetectContainers;
     tbl_["error_label"]             = handleErrorLabel;
     tbl_["exit_leaks"]              = handleExitLeaks;
     tbl_["forbid_heap_replace"]     = handleForbidHeapReplace;
     tbl_["full_error_recovery"]     = handleFullErrorRecovery;
+    tbl_["garbage_collector"]       = handleGarbageCollector;
     tbl_["int_arithmetic_limit"]    = handleIntArithmeticLimit;
     tbl_["join_on_loop_edges_only"] = handleJoinOnLoopEdgesOnly;
+    tbl_["mem_budget"]              = handleMemBudget;
     tbl_["memleak_is_error"]        = handleMemLeakIsError;
     tbl_["no_error_recovery"]       = handleNoErrorRecovery;
     tbl_["no_plot"]                 = handleNoPlot;
+    tbl_["no_trace"]                = handleNoTrace;
     tbl_["oom"]                     = handleOOM;
+    tbl_["plot_archive"]            = handlePlotArchive;
+    tbl_["print_stats"]             = handlePrintStats;
+    tbl_["profile"]                 = handleProfile;
+    tbl_["root_time_limit"]         = handleRootTimeLimit;
+    tbl_["root_workers"]            = handleRootWorkers;
     tbl_["state_live_ordering"]     = handleStateLiveOrdering;
+    tbl_["summary_store"]           = handleSummaryStore;
+    tbl_["threads"]                 = handleThreads;
+    tbl_["time_budget"]             = handleTimeBudget;
     tbl_["track_uninit"]            = handleTrackUninit;
     tbl_["verifier_error_is_error"] = handleVerifierErrorIsError;
 }
@@ -28,6 +28,8 @@ namespace FixedPoint {
     class StateByInsn;
 }
 
+class SymSummaryStore;
+
 namespace GlConf {
 
 struct Options {
@@ -35,9 +37,11 @@ struct Options {
     bool oomSimulation;     ///< enable/disable @b oom @b simulation mode
     bool memLeakIsError;    ///< treat memory leak as an error
     bool skipUserPlots;     ///< ignore all ___sl_plot*() calls
+    bool traceFree;         ///< do not keep the trace graph (see no_trace)
     int errorRecoveryMode;  ///< @copydoc config.h::SE_ERROR_RECOVERY_MODE
     bool verifierErrorIsError; ///< treat reaching __VERIFIER_error() as error
     std::string errLabel;   ///< if not empty, treat reaching the label as error
+    std::string plotArchive;///< if not empty, pack heap plots into this file
     bool allowCyclicTraceGraph; ///< create node with two parents on entailment
     int allowThreeWayJoin;  ///< @copydoc config.h::SE_ALLOW_THREE_WAY_JOIN
     bool forbidHeapReplace; ///< @copydoc config.h::SE_FORBID_HEAP_REPLACE
@@ -46,7 +50,16 @@ struct Options {
     int stateLiveOrdering;  ///< @copydoc config.h::SE_STATE_ON_THE_FLY_ORDERING
     bool exitLeaks;         ///< @copydoc config.h::SE_EXIT_LEAKS
     bool detectContainers;  ///< detect containers and operations over them
+    int threads;            ///< count of threads executing heaps in parallel
+    int blockScheduler;     ///< @copydoc config.h::SE_BLOCK_SCHEDULER_KIND
+    int garbageCollector;   ///< @copydoc config.h::SE_GARBAGE_COLLECTOR_KIND
+    int timeBudget;         ///< stop the analysis after so many seconds
+    int memBudget;          ///< stop the analysis after using so many MiB
+    int rootWorkers;        ///< count of processes executing virtual roots
+    int rootTimeLimit;      ///< stop a virtual root after so many seconds
+    bool printStats;        ///< print the statistics of a run as notes
     FixedPoint::StateByInsn *fixedPoint;  ///< fixed-point plotter (0 if unused)
+    SymSummaryStore *summaryStore;  ///< on-disk call summaries (0 if unused)
 
     Options();
 };
@@ -22,9 +22,9 @@
 
 #include "config.h"
 
+#include <algorithm>
 #include <iostream>
 #include <limits>
-#include <set>
 #include <vector>
 
 enum EDirection {
@@ -32,6 +32,14 @@ enum EDirection {
     D_RIGHT_TO_LEFT
 };
 
+/**
+ * bidirectional mapping of IDs (not necessarily injective in any direction)
+ *
+ * Each direction is kept as a sorted vector of pairs, which makes queries a
+ * binary search over contiguous memory and avoids an allocation per pair.
+ * The mappings are usually small, so the cost of shifting the vector on
+ * insertion is lower than the cost of rebalancing a tree.
+ */
 template <typename TId,
          TId MIN = std::numeric_limits<TId>::min(),
          TId MAX = std::numeric_limits<TId>::max()>
@@ -104,13 +112,24 @@ class IdMapper {
 
     private:
         typedef std::pair<TId, TId>                 TPair;
-        typedef std::set<TPair>                     TSearch;
+        typedef std::vector<TPair>                  TSearch;
         typedef TSearch                             TBidirSearch[2];
         typedef typename TSearch::const_iterator    TIter;
 
         ENotFoundAction             nfa_;
         TBidirSearch                biSearch_;
 
+        /// insert the given pair to the sorted vector, if not already there
+        static bool insertSorted(TSearch &search, const TPair &item) {
+            const typename TSearch::iterator it =
+                std::lower_bound(search.begin(), search.end(), item);
+            if (it != search.end() && *it == item)
+                return false;
+
+            search.insert(it, item);
+            return true;
+        }
+
     public:
         /// STL iterator, always D_LEFT_TO_RIGHT
         typedef typename TSearch::const_iterator const_iterator;
@@ -144,13 +163,14 @@ bool IdMapper<TId, MIN, MAX>::insert(const TId left, const TId right)
 {
     const TPair itemL(left, right);
     const TPair itemR(right, left);
-    CL_BREAK_IF(hasKey(biSearch_[0], itemL) != hasKey(biSearch_[1], itemR));
 
-    const bool changed = biSearch_[D_LEFT_TO_RIGHT].insert(itemL).second;
+    const bool changed = insertSorted(biSearch_[D_LEFT_TO_RIGHT], itemL);
     if (!changed)
         return false;
 
-    biSearch_[D_RIGHT_TO_LEFT].insert(itemR);
+    const bool changedR = insertSorted(biSearch_[D_RIGHT_TO_LEFT], itemR);
+    CL_BREAK_IF(!changedR);
+    (void) changedR;
     return true;
 }
 
@@ -163,7 +183,7 @@ void IdMapper<TId, MIN, MAX>::query(TVector *pDst, const TId id) const
     const TSearch &search = biSearch_[DIR];
 
     const TPair begItem(id, MIN);
-    const TIter beg = search.lower_bound(begItem);
+    const TIter beg = std::lower_bound(search.begin(), search.end(), begItem);
     if (beg == search.end() || beg->first != id) {
         // not found
         switch (nfa_) {
@@ -180,33 +200,28 @@ void IdMapper<TId, MIN, MAX>::query(TVector *pDst, const TId id) const
         }
     }
 
-    // find last (end points one item _beyond_ the last one)
-    const TPair endItem(id, MAX);
-    const TIter end = search.upper_bound(endItem);
-    CL_BREAK_IF(beg == end);
-
-    // copy the image to the given vector
-    for (TIter it = beg; it != end; ++it) {
-        CL_BREAK_IF(id != it->first);
+    // copy the image to the given vector (the pairs are sorted by the ID)
+    for (TIter it = beg; it != search.end() && id == it->first; ++it)
         pDst->push_back(it->second);
-    }
 }
 
 template <typename TId, TId MIN, TId MAX>
 template <EDirection DIR>
 void IdMapper<TId, MIN, MAX>::composite(const IdMapper<TId, MIN, MAX> &by)
 {
-    IdMapper<TId, MIN, MAX> result;
+    // pairs (a, c) of the result in the direction DIR, sorted at the end
+    TSearch result;
 
     // iterate through the mapping of 'this'
     const TSearch &m = biSearch_[DIR];
+    TVector cList;
     for (typename TSearch::const_reference item : m) {
         const TId a = item.first;
         const TId b = item.second;
-        TVector cList;
+        cList.clear();
         by.query<DIR>(&cList, b);
         for (const TId c : cList)
-            result.insert(a, c);
+            result.push_back(TPair(a, c));
     }
 
     if (NFA_RETURN_IDENTITY == nfa_) {
@@ -224,16 +239,27 @@ void IdMapper<TId, MIN, MAX>::composite(const IdMapper<TId, MIN, MAX> &by)
                 this->query<D_LEFT_TO_RIGHT>(&aList, b);
 
             for (const TId a : aList)
-                result.insert(a, c);
+                result.push_back(TPair(a, c));
         }
     }
 
     if (by.nfa_ < nfa_)
         nfa_ = by.nfa_;
 
+    // sort the result in bulk and build the opposite direction of it
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+
+    TSearch inverse;
+    inverse.reserve(result.size());
+    for (typename TSearch::const_reference item : result)
+        inverse.push_back(TPair(item.second, item.first));
+
+    std::sort(inverse.begin(), inverse.end());
+
     // finally replace the mapping of 'this' by the result
-    biSearch_[0].swap(result.biSearch_[D_RIGHT_TO_LEFT == DIR]);
-    biSearch_[1].swap(result.biSearch_[D_LEFT_TO_RIGHT == DIR]);
+    biSearch_[DIR].swap(result);
+    biSearch_[D_LEFT_TO_RIGHT == DIR].swap(inverse);
 }
 
 template <typename TId, TId MIN, TId MAX>
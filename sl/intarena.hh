@@ -22,13 +22,58 @@
 
 #include "config.h"
 
-#include <map>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <set>
 #include <vector>
 
-#define IA_AGGRESSIVE_OPTIMIZATION          0
+/// if 1, record all operations on arenas to intarena-trace.txt (see sl/bench)
+#define IA_RECORD_TRACE                     0
 
-/// ad-hoc implementation;  wastes memory, performance, and human resources
+#if IA_RECORD_TRACE
+#   include <atomic>
+#   include <fstream>
+#   include <mutex>
+#   include <sstream>
+
+/// append a line to intarena-trace.txt, safe to be called from any thread
+inline void iaRecordLine(const std::string &line)
+{
+    static std::mutex lock;
+    static std::ofstream str("intarena-trace.txt");
+
+    std::lock_guard<std::mutex> guard(lock);
+    str << line << '\n';
+}
+
+inline long iaNextTraceId()
+{
+    static std::atomic<long> last(0L);
+    return ++last;
+}
+
+#   define IA_RECORD(what) do {                                             \
+        std::ostringstream str;                                             \
+        str << what;                                                        \
+        iaRecordLine(str.str());                                            \
+    } while (0)
+#else
+#   define IA_RECORD(what) do { } while (0)
+#endif
+
+/**
+ * map of right-open intervals to sets of fields
+ *
+ * The items are kept in a treap ordered by (beg, end, fld), where each node
+ * also keeps the maximal end in its subtree, so that intersects() only descends
+ * to the subtrees that contain an intersecting item.  The priorities of nodes
+ * are derived from their items, which keeps the treap balanced in the expected
+ * case while the layout stays deterministic.  Lookups thus run in O(log n + k)
+ * for k items found, add() runs in O(log n) and sub() in O(log n) per item it
+ * hits.  The nodes are kept in a single vector, so that there is no allocation
+ * per item and copying takes a single allocation.
+ */
 template <typename TInt, typename TFld>
 class IntervalArena {
     public:
@@ -41,12 +86,100 @@ class IntervalArena {
         typedef std::vector<key_type>               TKeySet;
 
     private:
-        typedef std::set<TFld>                      TLeaf;
-        typedef std::map</* beg */ TInt, TLeaf>     TLine;
-        typedef std::map</* end */ TInt, TLine>     TCont;
-        TCont                                       cont_;
+        struct Item {
+            TInt        beg;
+            TInt        end;
+            TFld        fld;
+
+            bool operator<(const Item &ref) const {
+                if (beg != ref.beg)
+                    return (beg < ref.beg);
+                if (end != ref.end)
+                    return (end < ref.end);
+                return (fld < ref.fld);
+            }
+
+            bool operator==(const Item &ref) const {
+                return beg == ref.beg
+                    && end == ref.end
+                    && fld == ref.fld;
+            }
+        };
+
+        typedef std::vector<Item>                   TItemList;
+
+        struct Node {
+            Item        item;
+            TInt        maxEnd;     ///< maximal end of an item in the subtree
+            unsigned    prio;       ///< not lower than the priorities below
+            unsigned    left;
+            unsigned    right;      ///< links the free nodes, too
+        };
+
+        /// nodes of the treap, nodes_[0] stands for an empty subtree
+        std::vector<Node>                           nodes_;
+
+        /// root of the treap, 0 if the arena is empty
+        unsigned                                    root_;
+
+        /// first node of the list of free nodes, 0 if there is none
+        unsigned                                    free_;
+
+#if IA_RECORD_TRACE
+        long                                        traceId_;
+#endif
+
+        static unsigned prioOf(const Item &item);
+        unsigned alloc(const Item &item);
+        void release(unsigned node);
+        void update(unsigned node);
+        void split(unsigned node, const Item &item, unsigned &l, unsigned &r);
+        unsigned merge(unsigned l, unsigned r);
+        void insert(const Item &item);
+        unsigned eraseAt(unsigned node, const Item &item);
+        void collectAt(TItemList &dst, unsigned node, TInt winBeg, TInt winEnd)
+            const;
+        void exactMatchAt(TSet &dst, unsigned node, const key_type &key) const;
+        void reverseLookupAt(TKeySet &dst, unsigned node, TFld fld) const;
 
     public:
+#if IA_RECORD_TRACE
+        IntervalArena():
+            root_(0U),
+            free_(0U),
+            traceId_(iaNextTraceId())
+        {
+            IA_RECORD("n " << traceId_);
+        }
+
+        IntervalArena(const IntervalArena &ref):
+            nodes_(ref.nodes_),
+            root_(ref.root_),
+            free_(ref.free_),
+            traceId_(iaNextTraceId())
+        {
+            IA_RECORD("c " << traceId_ << " " << ref.traceId_);
+        }
+
+        IntervalArena& operator=(const IntervalArena &ref) {
+            nodes_      = ref.nodes_;
+            root_       = ref.root_;
+            free_       = ref.free_;
+            IA_RECORD("a " << traceId_ << " " << ref.traceId_);
+            return *this;
+        }
+
+        ~IntervalArena() {
+            IA_RECORD("d " << traceId_);
+        }
+#else
+        IntervalArena():
+            root_(0U),
+            free_(0U)
+        {
+        }
+#endif
+
         void add(const key_type &, TFld);
         void sub(const key_type &, TFld);
         void intersects(TSet &dst, const key_type &key) const;
@@ -56,7 +189,10 @@ class IntervalArena {
         void reverseLookup(TKeySet &dst, TFld) const;
 
         void clear() {
-            cont_.clear();
+            IA_RECORD("z " << traceId_);
+            nodes_.clear();
+            root_ = 0U;
+            free_ = 0U;
         }
 
         IntervalArena& operator+=(const value_type &item) {
@@ -71,197 +207,308 @@ class IntervalArena {
 };
 
 template <typename TInt, typename TFld>
-void IntervalArena<TInt, TFld>::add(const key_type &key, const TFld fld)
+unsigned IntervalArena<TInt, TFld>::prioOf(const Item &item)
 {
-    const TInt beg = key.first;
-    const TInt end = key.second;
-    CL_BREAK_IF(end <= beg);
-
-    cont_[end][beg].insert(fld);
+    // mix the item the way splitmix64 does
+    uint64_t x = static_cast<uint64_t>(item.beg);
+    x = x * 0x9e3779b97f4a7c15ULL + static_cast<uint64_t>(item.end);
+    x = x * 0x9e3779b97f4a7c15ULL + static_cast<uint64_t>(item.fld);
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return static_cast<unsigned>(x ^ (x >> 31));
 }
 
 template <typename TInt, typename TFld>
-void IntervalArena<TInt, TFld>::sub(const key_type &key, const TFld fld)
+unsigned IntervalArena<TInt, TFld>::alloc(const Item &item)
 {
-    const TInt winBeg = key.first;
-    const TInt winEnd = key.second;
-    CL_BREAK_IF(winEnd <= winBeg);
+    if (nodes_.empty()) {
+        // the empty subtree never intersects anything
+        const TInt min = std::numeric_limits<TInt>::min();
+        const Node nil = { Item(), min, 0U, 0U, 0U };
+        nodes_.push_back(nil);
+    }
 
-    std::vector<value_type> recoverList;
+    const Node node = { item, item.end, prioOf(item), 0U, 0U };
+    if (!free_) {
+        nodes_.push_back(node);
+        return nodes_.size() - 1U;
+    }
 
-    const typename TCont::iterator itEnd = cont_.end();
-    typename TCont::iterator it =
-        cont_.lower_bound(winBeg + /* right-open interval given as key */ 1);
+    const unsigned idx = free_;
+    free_ = nodes_[idx].right;
+    nodes_[idx] = node;
+    return idx;
+}
 
-    while (itEnd != it) {
-        TLine &line = it->second;
-#if !IA_AGGRESSIVE_OPTIMIZATION
-        if (line.empty()) {
-            // skip orphans
-            ++it;
-            continue;
-        }
-#endif
-        typename TLine::iterator lineIt = line.begin();
-        TInt beg = lineIt->first;
-        if (winEnd <= beg) {
-            // we are beyond the window already
-            ++it;
-            continue;
-        }
+template <typename TInt, typename TFld>
+void IntervalArena<TInt, TFld>::release(const unsigned node)
+{
+    nodes_[node].right = free_;
+    free_ = node;
+}
 
-        const TInt end = it->first;
-        bool anyHit = false;
-
-        const typename TLine::iterator lineItEnd = line.end();
-        do {
-            // make sure the basic window axioms hold
-            CL_BREAK_IF(winEnd <= beg);
-            CL_BREAK_IF(end <= winBeg);
-
-            // remove the object from the current leaf (if found)
-            TLeaf &os = lineIt->second;
-            if (os.erase(fld)) {
-                anyHit = true;
-
-                if (beg < winBeg) {
-                    // schedule "the part above" for re-insertion
-                    const key_type key(beg, winBeg);
-                    const value_type item(key, fld);
-                    recoverList.push_back(item);
-                }
-            }
+template <typename TInt, typename TFld>
+void IntervalArena<TInt, TFld>::update(const unsigned node)
+{
+    Node &n = nodes_[node];
+    n.maxEnd = std::max(n.item.end,
+            std::max(nodes_[n.left].maxEnd, nodes_[n.right].maxEnd));
+}
 
-#if IA_AGGRESSIVE_OPTIMIZATION
-            if (os.empty())
-                // FIXME: Can we remove items from std::map during traversal??
-                line.erase(lineIt++);
-            else
-#endif
-            ++lineIt;
+/// split the subtree to the items lower than the given item and the rest
+template <typename TInt, typename TFld>
+void IntervalArena<TInt, TFld>::split(
+        const unsigned              node,
+        const Item                 &item,
+        unsigned                   &l,
+        unsigned                   &r)
+{
+    if (!node) {
+        l = r = 0U;
+        return;
+    }
 
-            if (lineItEnd == lineIt)
-                // end of line
-                break;
+    Node &n = nodes_[node];
+    if (n.item < item) {
+        this->split(n.right, item, n.right, r);
+        l = node;
+    }
+    else {
+        this->split(n.left, item, l, n.left);
+        r = node;
+    }
 
-            beg = lineIt->first;
-        }
-        while (beg < winEnd);
-
-        if (anyHit) {
-            if (winEnd < end) {
-                // schedule "the part beyond" for re-insertion
-                const key_type key(winEnd, end);
-                const value_type item(key, fld);
-                recoverList.push_back(item);
-            }
+    this->update(node);
+}
 
-#if IA_AGGRESSIVE_OPTIMIZATION
-            if (line.empty()) {
-                // FIXME: Can we remove items from std::map during traversal??
-                cont_.erase(it++);
-                continue;
-            }
-#endif
-        }
+/// merge two subtrees, all items of l need to be lower than the items of r
+template <typename TInt, typename TFld>
+unsigned IntervalArena<TInt, TFld>::merge(const unsigned l, const unsigned r)
+{
+    if (!l)
+        return r;
+    if (!r)
+        return l;
+
+    if (nodes_[r].prio < nodes_[l].prio) {
+        const unsigned right = this->merge(nodes_[l].right, r);
+        nodes_[l].right = right;
+        this->update(l);
+        return l;
+    }
+
+    const unsigned left = this->merge(l, nodes_[r].left);
+    nodes_[r].left = left;
+    this->update(r);
+    return r;
+}
 
-        ++it;
+template <typename TInt, typename TFld>
+void IntervalArena<TInt, TFld>::insert(const Item &item)
+{
+    for (unsigned node = root_; node;) {
+        const Item &ref = nodes_[node].item;
+        if (ref == item)
+            // already there
+            return;
+
+        node = (item < ref)
+            ? nodes_[node].left
+            : nodes_[node].right;
     }
 
-    // go through the recoverList and re-insert the missing parts
-    for (const value_type &rItem : recoverList) {
-        const key_type &key = rItem.first;
-        const TFld fld = rItem.second;
-        const TInt beg = key.first;
-        const TInt end = key.second;
+    const unsigned node = this->alloc(item);
+
+    unsigned l, r;
+    this->split(root_, item, l, r);
+    root_ = this->merge(this->merge(l, node), r);
+}
+
+/// remove the given item, which needs to be in the subtree
+template <typename TInt, typename TFld>
+unsigned IntervalArena<TInt, TFld>::eraseAt(
+        const unsigned              node,
+        const Item                 &item)
+{
+    CL_BREAK_IF(!node);
+
+    Node &n = nodes_[node];
+    if (n.item == item) {
+        const unsigned rest = this->merge(n.left, n.right);
+        this->release(node);
+        return rest;
+    }
 
-        cont_[end][beg].insert(fld);
+    if (item < n.item) {
+        const unsigned left = this->eraseAt(n.left, item);
+        nodes_[node].left = left;
+    }
+    else {
+        const unsigned right = this->eraseAt(n.right, item);
+        nodes_[node].right = right;
     }
+
+    this->update(node);
+    return node;
 }
 
+/// collect items that intersect the given window (in sorted order)
 template <typename TInt, typename TFld>
-void IntervalArena<TInt, TFld>::intersects(TSet &dst, const key_type &key) const
+void IntervalArena<TInt, TFld>::collectAt(
+        TItemList                  &dst,
+        const unsigned              node,
+        const TInt                  winBeg,
+        const TInt                  winEnd)
+    const
+{
+    if (!node)
+        return;
+
+    const Node &n = nodes_[node];
+    if (n.maxEnd <= winBeg)
+        // no item of this subtree ends in the window
+        return;
+
+    this->collectAt(dst, n.left, winBeg, winEnd);
+
+    if (winEnd <= n.item.beg)
+        // this item and the ones on the right start beyond the window
+        return;
+
+    if (winBeg < n.item.end)
+        dst.push_back(n.item);
+
+    this->collectAt(dst, n.right, winBeg, winEnd);
+}
+
+template <typename TInt, typename TFld>
+void IntervalArena<TInt, TFld>::add(const key_type &key, const TFld fld)
 {
+    IA_RECORD("+ " << traceId_ << " " << key.first << " " << key.second
+            << " " << static_cast<long>(fld));
+
+    const Item item = { key.first, key.second, fld };
+    CL_BREAK_IF(item.end <= item.beg);
+    this->insert(item);
+}
+
+template <typename TInt, typename TFld>
+void IntervalArena<TInt, TFld>::sub(const key_type &key, const TFld fld)
+{
+    IA_RECORD("- " << traceId_ << " " << key.first << " " << key.second
+            << " " << static_cast<long>(fld));
+
     const TInt winBeg = key.first;
     const TInt winEnd = key.second;
     CL_BREAK_IF(winEnd <= winBeg);
 
-    typename TCont::const_iterator it =
-        cont_.lower_bound(winBeg + /* right-open interval given as key */ 1);
+    if (!root_)
+        return;
 
-    for (; cont_.end() != it; ++it) {
-        const TLine &line = it->second;
-#if !IA_AGGRESSIVE_OPTIMIZATION
-        if (line.empty())
-            // skip orphans
-            continue;
-#endif
-        typename TLine::const_iterator lineIt = line.begin();
-        TInt beg = lineIt->first;
-        if (winEnd <= beg)
-            // we are beyond the window already
-            continue;
+    TItemList hits;
+    this->collectAt(hits, root_, winBeg, winEnd);
 
-        const typename TLine::const_iterator lineItEnd = line.end();
-        do {
-            // make sure the basic window axioms hold
-            CL_BREAK_IF(winEnd <= beg);
-            CL_BREAK_IF(/* end */ it->first <= winBeg);
+    TItemList recoverList;
+    for (const Item &item : hits) {
+        if (fld != item.fld)
+            continue;
 
-            const TLeaf &os = lineIt->second;
-            std::copy(os.begin(), os.end(), std::inserter(dst, dst.begin()));
+        root_ = this->eraseAt(root_, item);
 
-            // increment for next wheel
-            if (lineItEnd == ++lineIt)
-                // end of line
-                break;
+        if (item.beg < winBeg) {
+            // schedule "the part above" for re-insertion
+            const Item above = { item.beg, winBeg, fld };
+            recoverList.push_back(above);
+        }
 
-            beg = lineIt->first;
+        if (winEnd < item.end) {
+            // schedule "the part beyond" for re-insertion
+            const Item beyond = { winEnd, item.end, fld };
+            recoverList.push_back(beyond);
         }
-        while (beg < winEnd);
     }
+
+    for (const Item &item : recoverList)
+        this->insert(item);
 }
 
-// FIXME: brute-force method
-// FIXME: no assumptions can be made about the output format
 template <typename TInt, typename TFld>
-void IntervalArena<TInt, TFld>::reverseLookup(TKeySet &dst, const TFld fld)
+void IntervalArena<TInt, TFld>::intersects(TSet &dst, const key_type &key) const
+{
+    IA_RECORD("i " << traceId_ << " " << key.first << " " << key.second);
+    CL_BREAK_IF(key.second <= key.first);
+
+    if (!root_)
+        return;
+
+    TItemList hits;
+    this->collectAt(hits, root_, key.first, key.second);
+    for (const Item &item : hits)
+        dst.insert(item.fld);
+}
+
+template <typename TInt, typename TFld>
+void IntervalArena<TInt, TFld>::reverseLookupAt(
+        TKeySet                    &dst,
+        const unsigned              node,
+        const TFld                  fld)
     const
 {
-    key_type key;
+    if (!node)
+        return;
 
-    for (typename TCont::const_reference item : cont_) {
-        key/* end */.second = item/* end */.first;
-        const TLine &line = item.second;
+    const Node &n = nodes_[node];
+    this->reverseLookupAt(dst, n.left, fld);
 
-        for (typename TLine::const_reference lineItem : line) {
-            const TLeaf &leaf = lineItem.second;
-            if (!hasKey(leaf, fld))
-                continue;
+    if (fld == n.item.fld)
+        dst.push_back(key_type(n.item.beg, n.item.end));
 
-            key/* beg */.first = lineItem/* beg */.first;
-            dst.push_back(key);
-        }
-    }
+    this->reverseLookupAt(dst, n.right, fld);
 }
 
+// FIXME: linear scan, there is no index by fields
+// FIXME: no assumptions can be made about the output format
 template <typename TInt, typename TFld>
-void IntervalArena<TInt, TFld>::exactMatch(TSet &dst, const key_type &key) const
+void IntervalArena<TInt, TFld>::reverseLookup(TKeySet &dst, const TFld fld)
+    const
+{
+    IA_RECORD("r " << traceId_ << " " << static_cast<long>(fld));
+    this->reverseLookupAt(dst, root_, fld);
+}
+
+template <typename TInt, typename TFld>
+void IntervalArena<TInt, TFld>::exactMatchAt(
+        TSet                       &dst,
+        const unsigned              node,
+        const key_type             &key)
+    const
 {
-    typedef typename TCont::const_iterator TEndIt;
-    const TEndIt itEnd = cont_.find(/* end */ key.second);
-    if (cont_.end() == itEnd)
-        // upper bound not found
+    if (!node)
         return;
 
-    const TLine &line = itEnd->second;
-    const typename TLine::const_iterator itBeg = line.find(/* beg */ key.first);
-    if (line.end() == itBeg)
-        // lower bound not found
+    const Node &n = nodes_[node];
+    const key_type ref(n.item.beg, n.item.end);
+    if (key < ref) {
+        this->exactMatchAt(dst, n.left, key);
         return;
+    }
 
-    const TLeaf &leaf = itBeg->second;
-    std::copy(leaf.begin(), leaf.end(), std::inserter(dst, dst.begin()));
+    if (ref < key) {
+        this->exactMatchAt(dst, n.right, key);
+        return;
+    }
+
+    // items with the same key may be found in both subtrees
+    this->exactMatchAt(dst, n.left, key);
+    dst.insert(n.item.fld);
+    this->exactMatchAt(dst, n.right, key);
+}
+
+template <typename TInt, typename TFld>
+void IntervalArena<TInt, TFld>::exactMatch(TSet &dst, const key_type &key) const
+{
+    IA_RECORD("x " << traceId_ << " " << key.first << " " << key.second);
+    this->exactMatchAt(dst, root_, key);
 }
 
 #endif /* H_GUARD_INTARENA_H */
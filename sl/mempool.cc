@@ -0,0 +1,228 @@
+/*
+ * Copyright (C) 2026 Kamil Dudka <kdudka@redhat.com>
+ *
+ * This file is part of predator.
+ *
+ * predator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * predator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with predator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include "mempool.hh"
+
+#include <cl/cl_msg.hh>
+
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <vector>
+
+namespace MemPool {
+
+// objects are 16-byte aligned, bigger objects are left to the global new
+static const size_t GRANULARITY     = 0x10;
+static const size_t MAX_POOLED_SIZE = 0x100;
+static const size_t CHUNK_SIZE      = 0x10000;
+static const unsigned CNT_CLASSES   = MAX_POOLED_SIZE / GRANULARITY;
+
+struct FreeItem {
+    FreeItem                   *next;
+};
+
+struct KindStats {
+    std::atomic<long>           cntAlive;
+    std::atomic<long>           bytesAlive;
+    std::atomic<long>           bytesPeak;
+};
+
+// shared among all threads
+static struct {
+    std::mutex                  chunksLock;
+    std::vector<void *>         chunks;
+    std::atomic<unsigned>       gen{1U};
+    KindStats                   stats[MPK_TOTAL];
+} gl;
+
+// free lists of the current thread, dropped when gen does not match gl.gen
+static thread_local struct {
+    unsigned                    gen;
+    FreeItem                   *freeList[CNT_CLASSES];
+    unsigned long               cntAllocs;
+} tc;
+
+static const char *kindNames[MPK_TOTAL] = {
+    "uniform blocks",
+    "fields",
+    "values",
+    "range values",
+    "composite values",
+    "custom values",
+    "regions",
+    "base addresses",
+    "trace nodes",
+    "predicate nodes"
+};
+
+static inline bool isPooled(const size_t size)
+{
+    return SH_MEM_POOL && size && size <= MAX_POOLED_SIZE;
+}
+
+static inline FreeItem *&freeListOf(const size_t size)
+{
+    const unsigned gen = gl.gen.load(std::memory_order_relaxed);
+    if (tc.gen != gen) {
+        // the pools have been reset since the last use by this thread
+        for (FreeItem *&head : tc.freeList)
+            head = 0;
+
+        tc.gen = gen;
+    }
+
+    return tc.freeList[(size - 1U) / GRANULARITY];
+}
+
+static FreeItem* allocChunk(const size_t size)
+{
+    void *chunk = std::malloc(CHUNK_SIZE);
+    if (!chunk)
+        throw std::bad_alloc();
+
+    {
+        std::lock_guard<std::mutex> lock(gl.chunksLock);
+        gl.chunks.push_back(chunk);
+    }
+
+    // split the chunk into a list of items of the size class
+    const size_t itemSize = GRANULARITY * (1U + (size - 1U) / GRANULARITY);
+    const size_t cnt = CHUNK_SIZE / itemSize;
+    char *const raw = static_cast<char *>(chunk);
+    for (size_t i = 0U; i < cnt; ++i) {
+        FreeItem *item = reinterpret_cast<FreeItem *>(raw + i * itemSize);
+        item->next = (i + 1U < cnt)
+            ? reinterpret_cast<FreeItem *>(raw + (i + 1U) * itemSize)
+            : 0;
+    }
+
+    return static_cast<FreeItem *>(chunk);
+}
+
+void* alloc(const size_t size, const EMemPoolKind kind)
+{
+    ++tc.cntAllocs;
+
+    KindStats &st = gl.stats[kind];
+    st.cntAlive.fetch_add(1L, std::memory_order_relaxed);
+    const long bytes = size + st.bytesAlive.fetch_add(size,
+            std::memory_order_relaxed);
+
+    long peak = st.bytesPeak.load(std::memory_order_relaxed);
+    while (peak < bytes && !st.bytesPeak.compare_exchange_weak(peak, bytes,
+                std::memory_order_relaxed))
+        ;
+
+    if (!isPooled(size))
+        return ::operator new(size);
+
+    FreeItem *&head = freeListOf(size);
+    if (!head)
+        head = allocChunk(size);
+
+    FreeItem *item = head;
+    head = item->next;
+    return item;
+}
+
+void release(void *ptr, const size_t size, const EMemPoolKind kind)
+{
+    if (!ptr)
+        return;
+
+    KindStats &st = gl.stats[kind];
+    st.cntAlive.fetch_sub(1L, std::memory_order_relaxed);
+    st.bytesAlive.fetch_sub(size, std::memory_order_relaxed);
+
+    if (!isPooled(size)) {
+        ::operator delete(ptr);
+        return;
+    }
+
+    // the item joins the free list of the current thread
+    FreeItem *&head = freeListOf(size);
+    FreeItem *item = static_cast<FreeItem *>(ptr);
+    item->next = head;
+    head = item;
+}
+
+unsigned long threadAllocCount()
+{
+    return tc.cntAllocs;
+}
+
+bool reset()
+{
+    long cntAlive = 0L;
+    for (const KindStats &st : gl.stats)
+        cntAlive += st.cntAlive.load(std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(gl.chunksLock);
+    if (cntAlive) {
+        CL_DEBUG("MemPool: " << cntAlive << " objects still allocated, "
+                << gl.chunks.size() << " chunks kept");
+        return false;
+    }
+
+    CL_DEBUG("MemPool: releasing " << gl.chunks.size() << " chunks");
+    for (void *chunk : gl.chunks)
+        std::free(chunk);
+
+    gl.chunks.clear();
+
+    // make all threads drop their free lists on the next use
+    gl.gen.fetch_add(1U, std::memory_order_relaxed);
+    return true;
+}
+
+void printUsage()
+{
+    std::ostringstream str;
+    str << std::fixed << std::setprecision(2);
+
+    size_t cntChunks;
+    {
+        std::lock_guard<std::mutex> lock(gl.chunksLock);
+        cntChunks = gl.chunks.size();
+    }
+
+    const float MB = static_cast<float>(1U << 20);
+    str << (cntChunks * CHUNK_SIZE / MB) << " MB in pools";
+
+    for (int kind = 0; kind < MPK_TOTAL; ++kind) {
+        const KindStats &st = gl.stats[kind];
+        const long peak = st.bytesPeak.load(std::memory_order_relaxed);
+        if (!peak)
+            continue;
+
+        str << ", " << kindNames[kind] << ": "
+            << st.cntAlive.load(std::memory_order_relaxed) << " ("
+            << (st.bytesAlive.load(std::memory_order_relaxed) / MB)
+            << " MB, peak " << (peak / MB) << " MB)";
+    }
+
+    CL_DEBUG("MemPool: " << str.str());
+}
+
+} // namespace MemPool
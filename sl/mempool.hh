@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026 Kamil Dudka <kdudka@redhat.com>
+ *
+ * This file is part of predator.
+ *
+ * predator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * predator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with predator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H_GUARD_MEM_POOL_H
+#define H_GUARD_MEM_POOL_H
+
+/**
+ * @file mempool.hh
+ * MemPool - size-class pool allocator of small objects with per-kind counters
+ */
+
+#include <cstddef>
+
+/// kinds of objects allocated by MemPool (used for statistics only)
+enum EMemPoolKind {
+    MPK_UNIFORM_BLOCK,
+    MPK_FIELD,
+    MPK_VALUE,
+    MPK_RANGE_VALUE,
+    MPK_COMP_VALUE,
+    MPK_CUSTOM_VALUE,
+    MPK_REGION,
+    MPK_BASE_ADDR,
+    MPK_TRACE_NODE,
+    MPK_PRED_NODE,
+    MPK_TOTAL
+};
+
+namespace MemPool {
+
+/// allocate an object of the given size and kind
+void* alloc(size_t size, EMemPoolKind kind);
+
+/// return an object allocated by alloc() back to the pool
+void release(void *ptr, size_t size, EMemPoolKind kind);
+
+/// count of the calls of alloc() made by the calling thread so far
+unsigned long threadAllocCount();
+
+/**
+ * give all the memory of the pools back to the system
+ * @note nothing is released if there are any objects still allocated
+ * @attention no other thread may use the pools while this is running
+ * @return true if the memory has been released
+ */
+bool reset();
+
+/// print count and size of allocated objects per kind using CL_DEBUG()
+void printUsage();
+
+} // namespace MemPool
+
+/// define class-specific operator new/delete, which use MemPool
+#define MEM_POOL_ALLOCATED(kind)                                            \
+    static void* operator new(size_t size) {                                \
+        return MemPool::alloc(size, kind);                                  \
+    }                                                                       \
+                                                                            \
+    static void operator delete(void *ptr, size_t size) {                   \
+        MemPool::release(ptr, size, kind);                                  \
+    }
+
+#endif /* H_GUARD_MEM_POOL_H */
@@ -0,0 +1,387 @@
+/*
+ * Copyright (C) 2026 Kamil Dudka <kdudka@redhat.com>
+ *
+ * This file is part of predator.
+ *
+ * predator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * predator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with predator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H_GUARD_PERSISTENT_H
+#define H_GUARD_PERSISTENT_H
+
+/**
+ * @file persistent.hh
+ * persistent ordered containers, which share their nodes with their copies
+ */
+
+#include "config.h"
+#include "mempool.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <utility>
+#include <vector>
+
+/// extract the key of an item stored in PersistentTree
+template <class TKey>
+struct PersistentSetKeyOf {
+    const TKey& operator()(const TKey &item) const {
+        return item;
+    }
+};
+
+/// @copydoc PersistentSetKeyOf
+template <class TKey, class TVal>
+struct PersistentMapKeyOf {
+    const TKey& operator()(const std::pair<TKey, TVal> &item) const {
+        return item.first;
+    }
+};
+
+/**
+ * persistent AVL tree with path copying
+ *
+ * Copying a tree takes O(1) time since the copy shares all the nodes with the
+ * original.  The nodes are never modified once created.  Insertion and removal
+ * copy the nodes on the path from the root to the affected node, O(log n) in
+ * total, and keep the rest shared with the other copies of the tree.  The
+ * reference counters of the nodes are atomic, so that copies of a tree can be
+ * used by different threads.
+ */
+template <class TItem, class TKey, class TKeyOf, class TLess>
+class PersistentTree {
+    private:
+        struct Node {
+            std::atomic<unsigned>       refCnt;
+            int                         height;
+            Node                       *left;   ///< owned reference
+            Node                       *right;  ///< owned reference
+            const TItem                 item;
+
+            /// take ownership of the references l and r
+            Node(const TItem &item_, Node *l, Node *r):
+                refCnt(1U),
+                height(1 + std::max(heightOf(l), heightOf(r))),
+                left(l),
+                right(r),
+                item(item_)
+            {
+            }
+
+            MEM_POOL_ALLOCATED(MPK_PRED_NODE)
+        };
+
+        Node                           *root_;  ///< owned reference
+        size_t                          size_;
+
+        static int heightOf(const Node *node) {
+            return (node) ? node->height : 0;
+        }
+
+        static Node* acquire(Node *node) {
+            if (node)
+                node->refCnt.fetch_add(1U, std::memory_order_relaxed);
+
+            return node;
+        }
+
+        static void release(Node *node) {
+            while (node) {
+                if (1U != node->refCnt.fetch_sub(1U, std::memory_order_acq_rel))
+                    // still shared with another tree
+                    return;
+
+                // release the right sub-tree recursively, the left one in place
+                Node *left = node->left;
+                release(node->right);
+                delete node;
+                node = left;
+            }
+        }
+
+        /// create a balanced node out of the item and owned references l and r
+        static Node* balance(const TItem &item, Node *l, Node *r) {
+            if (heightOf(r) + 1 < heightOf(l)) {
+                // the left sub-tree is too high, decompose it
+                Node *ll = acquire(l->left);
+                Node *lr = acquire(l->right);
+                const TItem lItem(l->item);
+                release(l);
+
+                if (heightOf(lr) <= heightOf(ll))
+                    // single rotation
+                    return new Node(lItem, ll, new Node(item, lr, r));
+
+                // double rotation
+                Node *lrl = acquire(lr->left);
+                Node *lrr = acquire(lr->right);
+                const TItem lrItem(lr->item);
+                release(lr);
+                return new Node(lrItem,
+                        new Node(lItem, ll, lrl),
+                        new Node(item, lrr, r));
+            }
+
+            if (heightOf(l) + 1 < heightOf(r)) {
+                // the right sub-tree is too high, decompose it
+                Node *rl = acquire(r->left);
+                Node *rr = acquire(r->right);
+                const TItem rItem(r->item);
+                release(r);
+
+                if (heightOf(rl) <= heightOf(rr))
+                    // single rotation
+                    return new Node(rItem, new Node(item, l, rl), rr);
+
+                // double rotation
+                Node *rll = acquire(rl->left);
+                Node *rlr = acquire(rl->right);
+                const TItem rlItem(rl->item);
+                release(rl);
+                return new Node(rlItem,
+                        new Node(item, l, rll),
+                        new Node(rItem, rlr, rr));
+            }
+
+            return new Node(item, l, r);
+        }
+
+        /// return an owned copy of node with item inserted (not yet there)
+        static Node* insertAt(Node *node, const TItem &item) {
+            if (!node)
+                return new Node(item, 0, 0);
+
+            const TKeyOf keyOf;
+            if (TLess()(keyOf(item), keyOf(node->item)))
+                return balance(node->item,
+                        insertAt(node->left, item),
+                        acquire(node->right));
+            else
+                return balance(node->item,
+                        acquire(node->left),
+                        insertAt(node->right, item));
+        }
+
+        /// return an owned copy of node with its leftmost item removed
+        static Node* eraseMin(Node *node) {
+            if (!node->left)
+                return acquire(node->right);
+
+            return balance(node->item,
+                    eraseMin(node->left),
+                    acquire(node->right));
+        }
+
+        /// return an owned copy of node with key removed (known to be there)
+        static Node* eraseAt(Node *node, const TKey &key) {
+            const TKeyOf keyOf;
+            const TLess less;
+            if (less(key, keyOf(node->item)))
+                return balance(node->item,
+                        eraseAt(node->left, key),
+                        acquire(node->right));
+
+            if (less(keyOf(node->item), key))
+                return balance(node->item,
+                        acquire(node->left),
+                        eraseAt(node->right, key));
+
+            if (!node->right)
+                return acquire(node->left);
+
+            // replace the item by its successor
+            const Node *succ = node->right;
+            while (succ->left)
+                succ = succ->left;
+
+            return balance(succ->item,
+                    acquire(node->left),
+                    eraseMin(node->right));
+        }
+
+    public:
+        typedef TKey                                        key_type;
+        typedef TItem                                       value_type;
+        typedef const TItem                                &const_reference;
+
+        /// in-order iterator over a tree, invalidated by modification of it
+        class const_iterator {
+            private:
+                /// nodes whose items (and right sub-trees) are yet to be seen
+                std::vector<const Node *>   stack_;
+
+                void pushLeftSpine(const Node *node) {
+                    for (; node; node = node->left)
+                        stack_.push_back(node);
+                }
+
+                friend class PersistentTree;
+
+            public:
+                const TItem& operator*() const {
+                    return stack_.back()->item;
+                }
+
+                const TItem* operator->() const {
+                    return &stack_.back()->item;
+                }
+
+                const_iterator& operator++() {
+                    const Node *node = stack_.back();
+                    stack_.pop_back();
+                    this->pushLeftSpine(node->right);
+                    return *this;
+                }
+
+                bool operator==(const const_iterator &other) const {
+                    if (stack_.empty() || other.stack_.empty())
+                        return stack_.empty() == other.stack_.empty();
+
+                    return stack_.back() == other.stack_.back();
+                }
+
+                bool operator!=(const const_iterator &other) const {
+                    return !operator==(other);
+                }
+        };
+
+    public:
+        PersistentTree():
+            root_(0),
+            size_(0)
+        {
+        }
+
+        PersistentTree(const PersistentTree &ref):
+            root_(acquire(ref.root_)),
+            size_(ref.size_)
+        {
+        }
+
+        PersistentTree& operator=(const PersistentTree &ref) {
+            Node *root = acquire(ref.root_);
+            release(root_);
+            root_ = root;
+            size_ = ref.size_;
+            return *this;
+        }
+
+        ~PersistentTree() {
+            release(root_);
+        }
+
+        size_t size()                   const { return size_;  }
+        bool empty()                    const { return !size_; }
+
+        const_iterator begin() const {
+            const_iterator it;
+            it.pushLeftSpine(root_);
+            return it;
+        }
+
+        const_iterator end() const {
+            return const_iterator();
+        }
+
+        const_iterator find(const TKey &key) const {
+            const TKeyOf keyOf;
+            const TLess less;
+
+            const_iterator it;
+            const Node *node = root_;
+            while (node) {
+                if (less(key, keyOf(node->item))) {
+                    // the node comes after the items of its left sub-tree
+                    it.stack_.push_back(node);
+                    node = node->left;
+                }
+                else if (less(keyOf(node->item), key))
+                    node = node->right;
+                else {
+                    it.stack_.push_back(node);
+                    return it;
+                }
+            }
+
+            return this->end();
+        }
+
+        /// return the item with the given key, 0 if there is no such item
+        const TItem* lookup(const TKey &key) const {
+            const TKeyOf keyOf;
+            const TLess less;
+
+            const Node *node = root_;
+            while (node) {
+                if (less(key, keyOf(node->item)))
+                    node = node->left;
+                else if (less(keyOf(node->item), key))
+                    node = node->right;
+                else
+                    return &node->item;
+            }
+
+            return 0;
+        }
+
+        /// insert the item unless its key is already in, like std::set does
+        bool /* inserted */ insert(const TItem &item) {
+            if (this->lookup(TKeyOf()(item)))
+                return false;
+
+            Node *root = insertAt(root_, item);
+            release(root_);
+            root_ = root;
+            ++size_;
+            return true;
+        }
+
+        /// remove the item with the given key, return count of removed items
+        size_t erase(const TKey &key) {
+            if (!this->lookup(key))
+                return 0;
+
+            Node *root = eraseAt(root_, key);
+            release(root_);
+            root_ = root;
+            --size_;
+            return 1;
+        }
+
+        void clear() {
+            release(root_);
+            root_ = 0;
+            size_ = 0;
+        }
+};
+
+/// set of keys, see PersistentTree for details
+template <class TKey, class TLess = std::less<TKey> >
+class PersistentSet:
+    public PersistentTree<TKey, TKey, PersistentSetKeyOf<TKey>, TLess>
+{
+};
+
+/// map of keys to values, see PersistentTree for details
+template <class TKey, class TVal, class TLess = std::less<TKey> >
+class PersistentMap:
+    public PersistentTree<std::pair<TKey, TVal>, TKey,
+                          PersistentMapKeyOf<TKey, TVal>, TLess>
+{
+    public:
+        typedef TVal                                        mapped_type;
+};
+
+#endif /* H_GUARD_PERSISTENT_H */
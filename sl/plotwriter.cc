@@ -0,0 +1,477 @@
+/*
+ * Copyright (C) 2026 Kamil Dudka <kdudka@redhat.com>
+ *
+ * This file is part of predator.
+ *
+ * predator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * predator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with predator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include "plotwriter.hh"
+
+#include <cl/cl_msg.hh>
+
+#include "glconf.hh"
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include <boost/functional/hash.hpp>
+
+namespace PlotWriter {
+
+/// a plot waiting for the background thread
+struct Job {
+    std::string                 fileName;
+    std::string                 head;
+    std::string                 body;
+};
+
+/// where the first plot with a given head and body has been stored
+struct Stored {
+    std::string                 fileName;
+    std::string                 head;
+    std::streamoff              offset;     ///< offset of the data in archive
+    size_t                      size;       ///< size of the head and body
+};
+
+/// a line of the index of the archive
+struct IndexItem {
+    std::streamoff              offset;
+    size_t                      size;
+    std::string                 fileName;
+};
+
+// (hash of head and body, length of body), compared byte by byte on a match
+typedef std::pair<size_t, size_t>                   TContentKey;
+
+struct Writer {
+    std::mutex                  lock;
+    std::condition_variable     wakeWriter; ///< a job queued or stopping
+    std::condition_variable     wakeOthers; ///< a job done
+    std::deque<Job>             queue;
+    size_t                      queuedBytes;
+    bool                        busy;       ///< a job is being written
+    bool                        stopping;
+    bool                        ok;         ///< no failure since last flush
+    std::vector<std::string>    errors;     ///< failures not reported yet
+    std::thread                *thread;
+    pid_t                       pid;        ///< process running the thread
+
+    // used only by the background thread, or while it is idle
+    std::map<TContentKey, Stored> stored;
+    std::string                 archiveName;
+    std::fstream                archive;
+    std::streamoff              archiveEnd; ///< end of the last plot member
+    time_t                      mtime;
+    std::vector<IndexItem>      index;
+
+    Writer():
+        queuedBytes(0U),
+        busy(false),
+        stopping(false),
+        ok(true),
+        thread(0),
+        pid(getpid()),
+        archiveEnd(0),
+        mtime(time(0))
+    {
+    }
+};
+
+// created on the first write() in each process
+static Writer *gl;
+static std::mutex glLock;
+
+// /////////////////////////////////////////////////////////////////////////////
+// tar archive in the GNU format, which is understood by all common tar tools
+static const size_t tarBlock = 512U;
+
+static void tarOctal(char *dst, const size_t len, const unsigned long num)
+{
+    // len - 1 octal digits followed by NUL
+    snprintf(dst, len, "%0*lo", static_cast<int>(len - 1U), num);
+}
+
+static void tarAppendHeader(
+        std::string                &dst,
+        const std::string          &name,
+        const char                  type,
+        const size_t                size,
+        const std::string          &link,
+        const time_t                mtime)
+{
+    char hdr[tarBlock];
+    memset(hdr, 0, sizeof hdr);
+    strncpy(hdr + 0, name.c_str(), 100);
+    tarOctal(hdr + 100, 8, 0644UL);
+    tarOctal(hdr + 108, 8, 0UL);
+    tarOctal(hdr + 116, 8, 0UL);
+    tarOctal(hdr + 124, 12, size);
+    tarOctal(hdr + 136, 12, mtime);
+    hdr[156] = type;
+    strncpy(hdr + 157, link.c_str(), 100);
+    memcpy(hdr + 257, "ustar  ", 8);
+
+    // the checksum is computed with the checksum field filled by spaces
+    memset(hdr + 148, ' ', 8);
+    unsigned long sum = 0UL;
+    for (const char c : hdr)
+        sum += static_cast<unsigned char>(c);
+    snprintf(hdr + 148, 7, "%06lo", sum);
+
+    dst.append(hdr, sizeof hdr);
+}
+
+static void tarAppendPadding(std::string &dst)
+{
+    const size_t rest = dst.size() % tarBlock;
+    if (rest)
+        dst.append(tarBlock - rest, '\0');
+}
+
+/// append a member of the given type, its name may be longer than 100 chars
+static void tarAppendMember(
+        std::string                &dst,
+        const std::string          &name,
+        const char                  type,
+        const size_t                size,
+        const std::string          &link,
+        const time_t                mtime)
+{
+    static const char *longName = "././@LongLink";
+
+    if (100U < link.size()) {
+        tarAppendHeader(dst, longName, 'K', link.size() + 1U, "", mtime);
+        dst.append(link.c_str(), link.size() + 1U);
+        tarAppendPadding(dst);
+    }
+
+    if (100U < name.size()) {
+        tarAppendHeader(dst, longName, 'L', name.size() + 1U, "", mtime);
+        dst.append(name.c_str(), name.size() + 1U);
+        tarAppendPadding(dst);
+    }
+
+    tarAppendHeader(dst, name, type, size, link, mtime);
+}
+
+static bool writeArchive(Writer *w, const std::string &data)
+{
+    w->archive.seekp(w->archiveEnd);
+    w->archive.write(data.data(), data.size());
+    return !!w->archive;
+}
+
+/// append the index and the end-of-archive marker, overwritten by next plot
+static bool finishArchive(Writer *w)
+{
+    std::ostringstream str;
+    for (const IndexItem &item : w->index)
+        str << item.offset << " " << item.size << " " << item.fileName << "\n";
+
+    const std::string text(str.str());
+
+    std::string buf;
+    tarAppendMember(buf, "index.txt", '0', text.size(), "", w->mtime);
+    buf += text;
+    tarAppendPadding(buf);
+    buf.append(2U * tarBlock, '\0');
+
+    return writeArchive(w, buf)
+        && w->archive.flush();
+}
+
+// /////////////////////////////////////////////////////////////////////////////
+// implementation of the background thread
+static bool storeMember(
+        Writer                     *w,
+        const Job                  &job,
+        const TContentKey          &key,
+        const Stored               *dup)
+{
+    std::string buf;
+    IndexItem item;
+    item.fileName = job.fileName;
+
+    if (dup) {
+        // a hard link to the first member with the same content
+        tarAppendMember(buf, job.fileName, '1', 0U, dup->fileName, w->mtime);
+        item.offset = dup->offset;
+        item.size = dup->size;
+    }
+    else {
+        item.size = job.head.size() + job.body.size();
+        tarAppendMember(buf, job.fileName, '0', item.size, "", w->mtime);
+        item.offset = w->archiveEnd + buf.size();
+        buf += job.head;
+        buf += job.body;
+        tarAppendPadding(buf);
+    }
+
+    if (!writeArchive(w, buf))
+        return false;
+
+    w->archiveEnd += buf.size();
+    w->index.push_back(item);
+
+    if (!dup) {
+        const Stored st{job.fileName, job.head, item.offset, item.size};
+        w->stored.insert(std::make_pair(key, st));
+    }
+
+    return true;
+}
+
+static bool storeFile(
+        Writer                     *w,
+        const Job                  &job,
+        const TContentKey          &key,
+        const Stored               *dup)
+{
+    if (dup) {
+        if (dup->fileName == job.fileName)
+            // already there
+            return true;
+
+        // replace the file (if any) by a hard link to the first copy
+        unlink(job.fileName.c_str());
+        if (!link(dup->fileName.c_str(), job.fileName.c_str()))
+            return true;
+
+        // hard links not supported, write a copy of the plot
+    }
+
+    std::fstream out(job.fileName.c_str(), std::ios::out);
+    out << job.head << job.body;
+    out.close();
+    if (!out)
+        return false;
+
+    if (!dup)
+        // the first plot with this key (if it was a collision) is kept
+        w->stored.insert(std::make_pair(key,
+                    Stored{job.fileName, job.head, 0, 0}));
+
+    return true;
+}
+
+/// read back the content of a plot stored before
+static bool readStored(Writer *w, const Stored &st, std::string *pDst)
+{
+    if (w->archiveName.empty()) {
+        std::ifstream in(st.fileName.c_str(), std::ios::binary);
+        std::ostringstream str;
+        str << in.rdbuf();
+        *pDst = str.str();
+        return !!in;
+    }
+
+    pDst->resize(st.size);
+    w->archive.seekg(st.offset);
+    w->archive.read(&(*pDst)[0], st.size);
+    if (w->archive)
+        return true;
+
+    w->archive.clear();
+    return false;
+}
+
+static void store(Writer *w, const Job &job, std::string *pErr)
+{
+    size_t hash = std::hash<std::string>()(job.body);
+    boost::hash_combine(hash, job.head);
+    const TContentKey key(hash, job.body.size());
+
+    const Stored *dup = 0;
+    const std::map<TContentKey, Stored>::const_iterator it =
+        w->stored.find(key);
+
+    // the heads are short, compare them first
+    const size_t headSize = job.head.size();
+    std::string stored;
+    if (w->stored.end() != it
+            && it->second.head == job.head
+            && readStored(w, it->second, &stored)
+            && stored.size() == headSize + job.body.size()
+            && !stored.compare(headSize, std::string::npos, job.body))
+        // not just a collision of hashes
+        dup = &it->second;
+
+    if (w->archiveName.empty()) {
+        if (!storeFile(w, job, key, dup))
+            *pErr = "unable to write file '" + job.fileName + "'";
+    }
+    else if (!w->archive.is_open()) {
+        *pErr = "unable to write '" + job.fileName + "' to archive '"
+            + w->archiveName + "'";
+    }
+    else if (!storeMember(w, job, key, dup)) {
+        *pErr = "unable to write '" + job.fileName + "' to archive '"
+            + w->archiveName + "'";
+        w->archive.clear();
+    }
+}
+
+static void run(Writer *w)
+{
+    std::unique_lock<std::mutex> guard(w->lock);
+    for (;;) {
+        while (w->queue.empty() && !w->stopping)
+            w->wakeWriter.wait(guard);
+
+        if (w->queue.empty())
+            // stopping
+            return;
+
+        const Job job(std::move(w->queue.front()));
+        w->queue.pop_front();
+        w->busy = true;
+        guard.unlock();
+
+        std::string err;
+        store(w, job, &err);
+
+        guard.lock();
+        w->queuedBytes -= job.head.size() + job.body.size();
+        w->busy = false;
+        if (!err.empty()) {
+            w->errors.push_back(err);
+            w->ok = false;
+        }
+
+        w->wakeOthers.notify_all();
+    }
+}
+
+// /////////////////////////////////////////////////////////////////////////////
+// implementation of the public API
+static Writer* writer()
+{
+    std::lock_guard<std::mutex> guard(glLock);
+    if (gl && gl->pid == getpid())
+        return gl;
+
+    Writer *w = new Writer;
+    if (gl) {
+        // we run in a process forked after flush(), where the thread of gl
+        // does not exist, take over the loose files stored by the parent
+        // (the worker processes are not used with an archive)
+        w->stored = gl->stored;
+    }
+    else if (!GlConf::data.plotArchive.empty()) {
+        w->archiveName = GlConf::data.plotArchive;
+        w->archive.open(w->archiveName.c_str(), std::ios::in | std::ios::out
+                | std::ios::trunc | std::ios::binary);
+    }
+
+    w->thread = new std::thread(run, w);
+    gl = w;
+    return w;
+}
+
+static void reportErrors(Writer *w, std::unique_lock<std::mutex> &guard)
+{
+    std::vector<std::string> errors;
+    errors.swap(w->errors);
+    guard.unlock();
+
+    for (const std::string &err : errors)
+        CL_ERROR(err);
+}
+
+void write(const std::string &fileName, std::string head, std::string body)
+{
+    Writer *w = writer();
+    std::unique_lock<std::mutex> guard(w->lock);
+
+    // do not let the queue grow without limits if the disk is too slow
+    while (SE_PLOT_QUEUE_LIMIT < w->queuedBytes)
+        w->wakeOthers.wait(guard);
+
+    w->queuedBytes += head.size() + body.size();
+    w->queue.push_back(Job());
+    Job &job = w->queue.back();
+    job.fileName = fileName;
+    job.head.swap(head);
+    job.body.swap(body);
+    w->wakeWriter.notify_one();
+
+    reportErrors(w, guard);
+}
+
+bool flush()
+{
+    Writer *w;
+    {
+        std::lock_guard<std::mutex> guard(glLock);
+        w = gl;
+    }
+
+    if (!w || w->pid != getpid())
+        // nothing has been written by this process
+        return true;
+
+    std::unique_lock<std::mutex> guard(w->lock);
+    while (!w->queue.empty() || w->busy)
+        w->wakeOthers.wait(guard);
+
+    if (w->archive.is_open() && !finishArchive(w)) {
+        w->errors.push_back("unable to write archive '"
+                + w->archiveName + "'");
+        w->ok = false;
+        w->archive.clear();
+    }
+
+    const bool ok = w->ok;
+    w->ok = true;
+    reportErrors(w, guard);
+    return ok;
+}
+
+bool stop()
+{
+    const bool ok = flush();
+
+    std::lock_guard<std::mutex> guard(glLock);
+    Writer *w = gl;
+    if (!w || w->pid != getpid())
+        return ok;
+
+    {
+        std::lock_guard<std::mutex> wGuard(w->lock);
+        w->stopping = true;
+        w->wakeWriter.notify_one();
+    }
+
+    w->thread->join();
+    delete w->thread;
+    delete w;
+    gl = 0;
+    return ok;
+}
+
+} // namespace PlotWriter
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2026 Kamil Dudka <kdudka@redhat.com>
+ *
+ * This file is part of predator.
+ *
+ * predator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * predator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with predator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H_GUARD_PLOT_WRITER_H
+#define H_GUARD_PLOT_WRITER_H
+
+/**
+ * @file plotwriter.hh
+ * PlotWriter - background writer of heap plots rendered to memory
+ */
+
+#include <string>
+
+/**
+ * Heap plots are rendered to memory by the analysis and handed over to a
+ * background thread, which writes them to the disk.  Each plot consists of a
+ * head, which does not depend on the unique name of the plot, and a body.
+ * Plots with the same head and body are stored only once, the duplicates
+ * become hard links to the first copy.
+ * If GlConf::Options::plotArchive is set, all the plots are packed into a
+ * single tar archive instead of loose files.  The archive ends with a member
+ * named @b index.txt, which lists the offset and size of the data of each plot
+ * in the archive, followed by the name of the plot.
+ */
+namespace PlotWriter {
+
+/**
+ * queue a plot to be written as fileName, plots with the same head and body
+ * are stored only once (the body is compared byte by byte with the stored one)
+ * @note the plots are written in the order in which they have been queued
+ */
+void write(const std::string &fileName, std::string head, std::string body);
+
+/**
+ * wait until all the queued plots are written and the archive (if any) is
+ * complete, report the failures as errors
+ * @return true if no plot has failed to be written since the last flush()
+ */
+bool flush();
+
+/// flush the plots and stop the background thread, to be called on exit
+bool stop();
+
+} // namespace PlotWriter
+
+#endif /* H_GUARD_PLOT_WRITER_H */
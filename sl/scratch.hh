@@ -0,0 +1,240 @@
+/*
+ * Copyright (C) 2026 Kamil Dudka <kdudka@redhat.com>
+ *
+ * This file is part of predator.
+ *
+ * predator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * predator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with predator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H_GUARD_SCRATCH_H
+#define H_GUARD_SCRATCH_H
+
+/**
+ * @file scratch.hh
+ * hash-based containers meant to be cleared and reused many times, such that
+ * clear() runs in O(size) and keeps all the memory allocated so far
+ */
+
+#include "config.h"
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+/// extract the key of an item stored in ScratchHashTable
+template <class TKey>
+struct ScratchSetKeyOf {
+    const TKey& operator()(const TKey &item) const {
+        return item;
+    }
+};
+
+/// @copydoc ScratchSetKeyOf
+template <class TKey, class TVal>
+struct ScratchMapKeyOf {
+    const TKey& operator()(const std::pair<TKey, TVal> &item) const {
+        return item.first;
+    }
+};
+
+/**
+ * open-addressing hash table (linear probing) over items stored in a vector
+ *
+ * The items are kept in the order of insertion.  The slots of the table are
+ * stamped by a generation counter, so that clear() only destroys the items
+ * and bumps the counter, instead of wiping all the slots.  Items cannot be
+ * erased one by one.  Iterators are invalidated by insertion.
+ */
+template <class TItem, class TKey, class TKeyOf, class THash>
+class ScratchHashTable {
+    public:
+        typedef TKey                                        key_type;
+        typedef TItem                                       value_type;
+        typedef typename std::vector<TItem>::iterator       iterator;
+        typedef typename std::vector<TItem>::const_iterator const_iterator;
+
+    private:
+        struct Slot {
+            unsigned                    gen;    ///< empty unless equal to gen_
+            unsigned                    idx;    ///< index into items_
+        };
+
+        std::vector<TItem>              items_;
+        std::vector<Slot>               slots_; ///< size is a power of two
+        unsigned                        gen_;
+
+        /// return the slot that holds the key, or the empty slot for it
+        unsigned probe(const TKey &key) const {
+            const TKeyOf keyOf;
+            const unsigned mask = slots_.size() - 1U;
+            unsigned pos = THash()(key) & mask;
+            for (;;) {
+                const Slot &slot = slots_[pos];
+                if (slot.gen != gen_ || keyOf(items_[slot.idx]) == key)
+                    return pos;
+
+                pos = (pos + 1U) & mask;
+            }
+        }
+
+        /// double the count of slots and index the items again
+        void grow() {
+            const size_t cnt = (slots_.empty())
+                ? 0x10
+                : (slots_.size() << 1);
+
+            slots_.assign(cnt, Slot{ 0U, 0U });
+            gen_ = 1U;
+
+            const TKeyOf keyOf;
+            for (unsigned idx = 0U; idx < items_.size(); ++idx) {
+                const unsigned pos = this->probe(keyOf(items_[idx]));
+                slots_[pos] = Slot{ gen_, idx };
+            }
+        }
+
+    public:
+        ScratchHashTable():
+            gen_(1U)
+        {
+        }
+
+        size_t size()                   const { return items_.size();  }
+        bool empty()                    const { return items_.empty(); }
+
+        iterator begin()                      { return items_.begin(); }
+        iterator end()                        { return items_.end();   }
+        const_iterator begin()          const { return items_.begin(); }
+        const_iterator end()            const { return items_.end();   }
+
+        /// return the nth item in the order of insertion
+        const TItem& operator[](unsigned nth) const {
+            return items_[nth];
+        }
+
+        const_iterator find(const TKey &key) const {
+            if (items_.empty())
+                return items_.end();
+
+            const Slot &slot = slots_[this->probe(key)];
+            if (slot.gen != gen_)
+                return items_.end();
+
+            return items_.begin() + slot.idx;
+        }
+
+        iterator find(const TKey &key) {
+            const const_iterator it =
+                static_cast<const ScratchHashTable *>(this)->find(key);
+
+            return items_.begin() + (it - items_.cbegin());
+        }
+
+        /// insert the item unless its key is already in, like std::set does
+        std::pair<iterator, bool> insert(const TItem &item) {
+            // keep the load factor at most 1/2
+            if (slots_.size() < ((items_.size() + 1U) << 1))
+                this->grow();
+
+            const TKeyOf keyOf;
+            Slot &slot = slots_[this->probe(keyOf(item))];
+            if (slot.gen == gen_)
+                return std::make_pair(items_.begin() + slot.idx, false);
+
+            slot.gen = gen_;
+            slot.idx = items_.size();
+            items_.push_back(item);
+            return std::make_pair(items_.end() - 1, true);
+        }
+
+        void clear() {
+            items_.clear();
+            if (++gen_)
+                return;
+
+            // the generation counter has wrapped around, wipe all the slots
+            slots_.assign(slots_.size(), Slot{ 0U, 0U });
+            gen_ = 1U;
+        }
+};
+
+/// set of keys, see ScratchHashTable for details
+template <class TKey, class THash = std::hash<TKey> >
+class ScratchHashSet:
+    public ScratchHashTable<TKey, TKey, ScratchSetKeyOf<TKey>, THash>
+{
+};
+
+/// map of keys to values, see ScratchHashTable for details
+template <class TKey, class TVal, class THash = std::hash<TKey> >
+class ScratchHashMap:
+    public ScratchHashTable<std::pair<TKey, TVal>, TKey,
+                            ScratchMapKeyOf<TKey, TVal>, THash>
+{
+    public:
+        typedef TVal                                        mapped_type;
+
+        TVal& operator[](const TKey &key) {
+            return this->insert(std::make_pair(key, TVal())).first->second;
+        }
+};
+
+/// DFS work list like WorkList<T>, built upon ScratchHashSet
+template <class T, class THash = std::hash<T> >
+class ScratchWorkList {
+    public:
+        typedef T value_type;
+
+    private:
+        ScratchHashSet<T, THash>        seen_;
+        std::vector<unsigned>           todo_;  ///< indices into seen_
+
+    public:
+        bool next(T &dst) {
+            if (todo_.empty())
+                return false;
+
+            dst = seen_[todo_.back()];
+            todo_.pop_back();
+            return true;
+        }
+
+        bool schedule(const T &item) {
+            if (!seen_.insert(item).second)
+                return false;
+
+            todo_.push_back(seen_.size() - 1U);
+            return true;
+        }
+
+        bool seen(const T &item) const {
+            return seen_.end() != seen_.find(item);
+        }
+
+        unsigned cntSeen() const { return seen_.size(); }
+        unsigned cntTodo() const { return todo_.size(); }
+
+        /// return the nth item waiting to be processed, 0 <= nth < cntTodo()
+        const T& todo(unsigned nth) const {
+            CL_BREAK_IF(todo_.size() <= nth);
+            return seen_[todo_[nth]];
+        }
+
+        void clear() {
+            seen_.clear();
+            todo_.clear();
+        }
+};
+
+#endif /* H_GUARD_SCRATCH_H */
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2026 Kamil Dudka <kdudka@redhat.com>
+ *
+ * This file is part of predator.
+ *
+ * predator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * predator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with predator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file slsnap.cc
+ * standalone driver that runs Predator on a code snapshot written by the
+ * compiler plug-in (option dump-snapshot), without a compiler in the loop
+ */
+
+#include "config.h"
+
+#include <cl/code_listener.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <unistd.h>
+
+static void usage(const char *self)
+{
+    fprintf(stderr, "Usage: %s [-a ANALYZER_ARGS] [-v VERBOSITY] SNAPSHOT\n",
+            self);
+}
+
+int main(int argc, char *argv[])
+{
+    std::string args;
+    int verbose = 0;
+
+    int opt;
+    while (-1 != (opt = getopt(argc, argv, "a:v:h"))) {
+        switch (opt) {
+            case 'a':
+                args = optarg;
+                break;
+
+            case 'v':
+                verbose = atoi(optarg);
+                break;
+
+            default:
+                usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (optind + 1 != argc) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // messages are printed the same way as by the compiler plug-in
+    cl_global_init_defaults(/* app_name */ NULL, verbose);
+
+    // the snapshot already went through the code listener filters
+    const std::string config = "listener=\"easy\" listener_args=\""
+        + args + "\"";
+
+    struct cl_code_listener *cl = cl_code_listener_create(config.c_str());
+    if (!cl) {
+        cl_global_cleanup();
+        return EXIT_FAILURE;
+    }
+
+    const bool ok = cl_snapshot_replay(cl, argv[optind]);
+    cl_global_cleanup();
+
+    return (ok)
+        ? EXIT_SUCCESS
+        : EXIT_FAILURE;
+}
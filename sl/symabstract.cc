@@ -31,6 +31,7 @@
 #include "symjoin.hh"
 #include "symdiscover.hh"
 #include "symgc.hh"
+#include "symprof.hh"
 #include "symseg.hh"
 #include "symutil.hh"
 #include "symtrace.hh"
@@ -470,6 +471,8 @@ TMinLen spliceOutSegmentIfNeeded(
 
 void abstractIfNeeded(SymHeap &sh)
 {
+    ProfScope prof(PP_ABSTRACT_IF_NEEDED);
+
 #if SE_DISABLE_SLS && SE_DISABLE_DLS
     return;
 #endif
@@ -477,11 +480,14 @@ void abstractIfNeeded(SymHeap &sh)
     while (discoverBestAbstraction(&shape, sh)) {
         if (!applyAbstraction(sh, shape))
             // the best abstraction given is unfortunately not good enough
-            break;
+            return;
 
         // some part of the symbolic heap has just been successfully abstracted,
         // let's look if there remains anything else suitable for abstraction
     }
+
+    // nothing left to abstract, next time look only near the objects changed
+    sh.clearTouchedObjs();
 }
 
 void concretizeObj(
@@ -40,9 +40,11 @@
 #include "symtrace.hh"
 #include "util.hh"
 
+#include <algorithm>
 #include <cstring>
 #include <libgen.h>
 #include <map>
+#include <vector>
 
 typedef const struct cl_loc     *TLoc;
 typedef const struct cl_operand &TOp;
@@ -948,11 +950,12 @@ bool handleAssume(
     return true;
 }
 
-bool handleNondetInt(
+bool handleNondetCore(
         SymState                                    &dst,
         SymExecCore                                 &core,
         const CodeStorage::Insn                     &insn,
-        const char                                  *name)
+        const char                                  *name,
+        const bool                                  isUnsigned)
 {
     const CodeStorage::TOperandList &opList = insn.operands;
     if (2 != opList.size()) {
@@ -964,13 +967,7 @@ bool handleNondetInt(
     CL_DEBUG_MSG(&insn.loc, "executing " << name << "()");
     TValId val;
 
-    static const char namePrefixUnsigned[] = "__VERIFIER_nondet_u";
-    static const size_t namePrefixLength = sizeof(namePrefixUnsigned) - 1U;
-    std::string namePrefix(name);
-    if (namePrefixLength < namePrefix.size())
-        namePrefix.resize(namePrefixLength);
-
-    if (std::string(namePrefixUnsigned) == namePrefix) {
+    if (isUnsigned) {
         // an unsigned value
         const IR::Range unsignedRng = {
             /* lo        */ 0,
@@ -995,6 +992,24 @@ bool handleNondetInt(
     return true;
 }
 
+bool handleNondetInt(
+        SymState                                    &dst,
+        SymExecCore                                 &core,
+        const CodeStorage::Insn                     &insn,
+        const char                                  *name)
+{
+    return handleNondetCore(dst, core, insn, name, /* isUnsigned */ false);
+}
+
+bool handleNondetUnsigned(
+        SymState                                    &dst,
+        SymExecCore                                 &core,
+        const CodeStorage::Insn                     &insn,
+        const char                                  *name)
+{
+    return handleNondetCore(dst, core, insn, name, /* isUnsigned */ true);
+}
+
 bool handlePlot(
         SymState                                    &dst,
         SymExecCore                                 &core,
@@ -1220,7 +1235,18 @@ bool handleError(
 // singleton
 class BuiltInTable {
     public:
-        typedef const CodeStorage::Insn             &TInsn;
+        typedef bool (*THandler)(
+                SymState                            &dst,
+                SymExecCore                         &core,
+                const CodeStorage::Insn             &insn,
+                const char                          *name);
+
+        /// a built-in function resolved for a particular function uid
+        struct Slot {
+            THandler                                hdl;
+            const TOpIdxList                       *derefs;
+            const char                             *name;
+        };
 
     public:
         static BuiltInTable* inst() {
@@ -1229,14 +1255,22 @@ class BuiltInTable {
                 : (inst_ = new BuiltInTable);
         }
 
-        bool handleBuiltIn(
-                SymState                            &dst,
-                SymExecCore                         &core,
-                TInsn                                insn,
-                const char                          *name)
-            const;
+        void resolve(TStorRef stor);
 
-        const TOpIdxList& lookForDerefs(const char *name) const;
+        /// return the slot of a resolved built-in, or 0 if uid is not one
+        const Slot* slotByUid(const cl_uid_t uid) const {
+            // without resolveBuiltIns(), nothing would be seen as a built-in
+            CL_BREAK_IF(!resolved_);
+
+            const size_t idx = static_cast<size_t>(uid - uidOffset_);
+            if (slots_.size() <= idx)
+                return 0;
+
+            const Slot *slot = &slots_[idx];
+            return (slot->name)
+                ? slot
+                : 0;
+        }
 
         // TODO: rename and hide
         const TOpIdxList                            emp_;
@@ -1244,25 +1278,31 @@ class BuiltInTable {
     private:
         BuiltInTable();
 
-        static BuiltInTable* inst_;
+        THandler lookForHandler(const char *name) const;
+        const TOpIdxList& lookForDerefs(const char *name) const;
 
-        typedef bool (*THandler)(
-                SymState                            &dst,
-                SymExecCore                         &core,
-                const CodeStorage::Insn             &insn,
-                const char                          *name);
+        static BuiltInTable* inst_;
 
         typedef std::map<std::string, THandler>     TMap;
         TMap                                        tbl_;
 
         typedef std::map<std::string, TOpIdxList>   TDerefMap;
         TDerefMap                                   der_;
+
+        /// resolved built-ins indexed by (uid - uidOffset_)
+        std::vector<Slot>                           slots_;
+        cl_uid_t                                    uidOffset_;
+
+        /// true once resolve() has been called
+        bool                                        resolved_;
 };
 
 BuiltInTable *BuiltInTable::inst_;
 
 /// register built-ins
-BuiltInTable::BuiltInTable()
+BuiltInTable::BuiltInTable():
+    uidOffset_(0),
+    resolved_(false)
 {
     // GCC built-in stack allocation
     tbl_["__builtin_alloca"] /* before GCC 4.7.0 */ = handleAlloca;
@@ -1374,43 +1414,26 @@ BuiltInTable::BuiltInTable()
     der_["__strncpy_chk"]          .push_back(/* src  */ 3);
 }
 
-bool BuiltInTable::handleBuiltIn(
-        SymState                                    &dst,
-        SymExecCore                                 &core,
-        const CodeStorage::Insn                     &insn,
-        const char                                  *name)
-    const
+BuiltInTable::THandler BuiltInTable::lookForHandler(const char *name) const
 {
-    THandler hdl;
-
     TMap::const_iterator it = tbl_.find(name);
-    if (tbl_.end() == it) {
-        static const char namePrefixNondet[] = "__VERIFIER_nondet";
-        static const char namePrefixObjSize[] = "llvm.objectsize.i";
-
-        static_assert(sizeof(namePrefixNondet) == sizeof(namePrefixObjSize),
-            "Prefix names must be same length");
-
-        static const size_t namePrefixLength = sizeof(namePrefixNondet) - 1U;
-        std::string namePrefix(name);
-        if (namePrefixLength < namePrefix.size())
-            namePrefix.resize(namePrefixLength);
-
-        if (std::string(namePrefixNondet) == namePrefix)
-            hdl = handleNondetInt;
-        else if (std::string(namePrefixObjSize) == namePrefix)
-            hdl = handleNoOp;
-        else
-            // no fnc name matched as built-in
-            return false;
-    }
-    else
-        hdl = it->second;
+    if (tbl_.end() != it)
+        return it->second;
 
-    SymHeap &sh = core.sh();
-    sh.traceUpdate(new Trace::InsnNode(sh.traceNode(), &insn, /* bin */ true));
+    static const char namePrefixNondetU[] = "__VERIFIER_nondet_u";
+    if (!strncmp(name, namePrefixNondetU, sizeof(namePrefixNondetU) - 1U))
+        return handleNondetUnsigned;
 
-    return hdl(dst, core, insn, name);
+    static const char namePrefixNondet[] = "__VERIFIER_nondet";
+    if (!strncmp(name, namePrefixNondet, sizeof(namePrefixNondet) - 1U))
+        return handleNondetInt;
+
+    static const char namePrefixObjSize[] = "llvm.objectsize.i";
+    if (!strncmp(name, namePrefixObjSize, sizeof(namePrefixObjSize) - 1U))
+        return handleNoOp;
+
+    // no fnc name matched as built-in
+    return 0;
 }
 
 const TOpIdxList& BuiltInTable::lookForDerefs(const char *name) const
@@ -1423,27 +1446,68 @@ const TOpIdxList& BuiltInTable::lookForDerefs(const char *name) const
     return it->second;
 }
 
-bool fncNameFromOp(
-        const char                                **pName,
+void BuiltInTable::resolve(TStorRef stor)
+{
+    slots_.clear();
+    uidOffset_ = 0;
+    resolved_ = true;
+
+    // only external functions are candidates for built-in functions
+    typedef std::pair<cl_uid_t, const CodeStorage::Fnc *> TItem;
+    std::vector<TItem> cands;
+    for (const CodeStorage::Fnc *fnc : stor.fncs) {
+        if (!fnc->def.data.cst.data.cst_fnc.is_extern)
+            continue;
+
+        if (!nameOf(*fnc))
+            continue;
+
+        cands.push_back(TItem(uidOf(*fnc), fnc));
+    }
+
+    if (cands.empty())
+        return;
+
+    cl_uid_t uidMin = cands.front().first;
+    cl_uid_t uidMax = uidMin;
+    for (const TItem &item : cands) {
+        uidMin = std::min(uidMin, item.first);
+        uidMax = std::max(uidMax, item.first);
+    }
+
+    const Slot empty = { 0, &emp_, 0 };
+    uidOffset_ = uidMin;
+    slots_.resize(uidMax - uidMin + 1, empty);
+
+    for (const TItem &item : cands) {
+        const char *name = nameOf(*item.second);
+        const THandler hdl = this->lookForHandler(name);
+        const TOpIdxList &derefs = this->lookForDerefs(name);
+        if (!hdl && derefs.empty())
+            // not a built-in
+            continue;
+
+        Slot &slot = slots_[item.first - uidOffset_];
+        slot.hdl    = hdl;
+        slot.derefs = &derefs;
+        slot.name   = name;
+    }
+}
+
+const BuiltInTable::Slot* slotByOp(
         SymExecCore                                 &core,
         const struct cl_operand                     &op)
 {
     cl_uid_t uid;
     if (!core.fncFromOperand(&uid, op))
-        return false;
+        return 0;
 
-    TStorRef stor = core.sh().stor();
-    const CodeStorage::Fnc *fnc = stor.fncs[uid];
-    if (!fnc->def.data.cst.data.cst_fnc.is_extern)
-        // only external functions are candidates for built-in functions
-        return false;
-
-    const char *name = nameOf(*fnc);
-    if (!name)
-        return false;
+    return BuiltInTable::inst()->slotByUid(uid);
+}
 
-    *pName = name;
-    return true;
+void resolveBuiltIns(TStorRef stor)
+{
+    BuiltInTable::inst()->resolve(stor);
 }
 
 bool handleBuiltIn(
@@ -1451,23 +1515,25 @@ bool handleBuiltIn(
         SymExecCore                                 &core,
         const CodeStorage::Insn                     &insn)
 {
-    const char *name;
-    if (!fncNameFromOp(&name, core, insn.operands[/* fnc */ 1]))
+    const BuiltInTable::Slot *slot =
+        slotByOp(core, insn.operands[/* fnc */ 1]);
+    if (!slot || !slot->hdl)
         return false;
 
-    const BuiltInTable *tbl = BuiltInTable::inst();
-    return tbl->handleBuiltIn(dst, core, insn, name);
+    SymHeap &sh = core.sh();
+    sh.traceUpdate(new Trace::InsnNode(sh.traceNode(), &insn, /* bin */ true));
+
+    return slot->hdl(dst, core, insn, slot->name);
 }
 
 const TOpIdxList& opsWithDerefSemanticsInCallInsn(
         SymExecCore                                 &core,
         const CodeStorage::Insn                     &insn)
 {
-    const BuiltInTable *tbl = BuiltInTable::inst();
-
-    const char *name;
-    if (!fncNameFromOp(&name, core, insn.operands[/* fnc */ 1]))
-        return tbl->emp_;
+    const BuiltInTable::Slot *slot =
+        slotByOp(core, insn.operands[/* fnc */ 1]);
+    if (!slot)
+        return BuiltInTable::inst()->emp_;
 
-    return tbl->lookForDerefs(name);
+    return *slot->derefs;
 }
@@ -32,8 +32,17 @@ class SymState;
 
 namespace CodeStorage {
     struct Insn;
+    struct Storage;
 }
 
+/**
+ * look up the built-ins among the external functions of the given code storage
+ * so that handleBuiltIn() and opsWithDerefSemanticsInCallInsn() need only to
+ * index a table by the uid of the called function.  This has to be called
+ * before the symbolic execution is started on the given code storage.
+ */
+void resolveBuiltIns(const CodeStorage::Storage &stor);
+
 /// list of indexes of operands in an instruction
 typedef std::vector<unsigned /* idx */>         TOpIdxList;
 
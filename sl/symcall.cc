@@ -32,7 +32,9 @@
 #include "symheap.hh"
 #include "symjoin.hh"
 #include "symproc.hh"
+#include "symprof.hh"
 #include "symstate.hh"
+#include "symsummary.hh"
 #include "symutil.hh"
 #include "symtrace.hh"
 #include "util.hh"
@@ -125,12 +127,14 @@ int PerFncCache::lookupCore(const SymHeap &sh)
     EJoinStatus     status;
     SymHeap         result(sh.stor(), new Trace::TransientNode("PerFncCache"));
     const int       cnt = huni_.size();
+    const THeapIdent ident = heapIdentOf(sh, joinFingerprint(sh));
     int             idx;
 
     // try join
     for(idx = 0; idx < cnt; ++idx) {
         const SymHeap &shIn = huni_[idx];
-        if (!joinSymHeaps(&status, &result, shIn, sh))
+        if (!joinSymHeapsCached(&status, &result, huni_.identOf(idx), shIn,
+                    ident, sh))
             // join failed with this heap, try the next one
             continue;
 
@@ -208,6 +212,7 @@ struct SymCallCache::Private {
     SymBackTrace                bt;
 
     void importGlVar(SymHeap &sh, const CVar &cv);
+    void taintCtxStack();
     void resolveHeapCut(TCVarList &cut, SymHeap &sh, TFncRef fnc);
     SymCallCtx* getCallCtx(const SymHeap &entry, TFncRef fnc);
 
@@ -227,6 +232,8 @@ struct SymCallCtx::Private {
     const struct cl_operand     *dst;
     SymHeapList                 rawResults;
     int                         nestLevel;
+    int                         cntIssuesOnEntry;
+    bool                        hadIssues;
     bool                        computed;
     bool                        flushed;
 
@@ -241,6 +248,8 @@ struct SymCallCtx::Private {
                 new Trace::TransientNode("SymCallCtx::Private::entry")),
         callFrame(cd_->bt.stor(),
                 new Trace::TransientNode("SymCallCtx::Private::callFrame")),
+        cntIssuesOnEntry(0),
+        hadIssues(false),
         computed(false),
         flushed(false)
     {
@@ -419,6 +428,21 @@ void SymCallCtx::flushCallResults(SymState &dst)
     CL_BREAK_IF(this != d->cd->ctxStack.back());
     d->cd->ctxStack.pop_back();
 
+    if (!d->computed) {
+        // a warning or error reported by the call would not be reported again
+        // if its results were taken from SymSummaryStore in a later run
+        if (cl_msg_cnt_issues() != d->cntIssuesOnEntry)
+            d->hadIssues = true;
+
+        SymSummaryStore *const store = GlConf::data.summaryStore;
+        if (store && !d->hadIssues)
+            store->insert(*d->fnc, d->entry, d->rawResults);
+    }
+
+    if (d->hadIssues)
+        // the callers depend on the reported issues, too
+        d->cd->taintCtxStack();
+
     // go through the results and make them of the form that the caller likes
     const unsigned cnt = d->rawResults.size();
     for (unsigned i = 0; i < cnt; ++i) {
@@ -552,6 +576,13 @@ void pushGlVar(SymHeap &dst, const SymHeap &glSubHeap, const CVar &cv)
     joinHeapsByCVars(&dst, &glSubHeap);
 }
 
+/// prevent the calls being executed from being stored in SymSummaryStore
+void SymCallCache::Private::taintCtxStack()
+{
+    for (SymCallCtx *ctx : this->ctxStack)
+        ctx->d->hadIssues = true;
+}
+
 void SymCallCache::Private::importGlVar(SymHeap &entry, const CVar &cv)
 {
     const int cnt = this->ctxStack.size();
@@ -730,6 +761,17 @@ SymCallCtx* SymCallCache::Private::getCallCtx(const SymHeap &entry, TFncRef fnc)
         ctx->d->entry   = entry;
         Trace::waiveCloneOperation(ctx->d->entry);
 
+        SymSummaryStore *const store = GlConf::data.summaryStore;
+        if (store && store->lookup(ctx->d->rawResults, fnc, ctx->d->entry,
+                    entry.traceNode()))
+        {
+            // results loaded from a previous run, no need to execute the call
+            ctx->d->computed = true;
+            ctx->d->flushed  = true;
+        }
+        else
+            ctx->d->cntIssuesOnEntry = cl_msg_cnt_issues();
+
         // enter ctx stack
         this->ctxStack.push_back(ctx);
         return ctx;
@@ -751,6 +793,10 @@ SymCallCtx* SymCallCache::Private::getCallCtx(const SymHeap &entry, TFncRef fnc)
         return 0;
     }
 
+    if (ctx->d->hadIssues)
+        // the issues reported by the cached call are not reported again
+        this->taintCtxStack();
+
     // enter ctx stack
     this->ctxStack.push_back(ctx);
 
@@ -763,6 +809,8 @@ SymCallCtx* SymCallCache::getCallCtx(
         const CodeStorage::Fnc          &fnc,
         const CodeStorage::Insn         &insn)
 {
+    ProfScope prof(PP_GET_CALL_CTX);
+
     const struct cl_loc *loc = &insn.loc;
     CL_DEBUG_MSG(loc, "SymCallCache is looking for " << nameOf(fnc) << "()...");
 
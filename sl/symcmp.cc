@@ -23,13 +23,19 @@
 #include <cl/cl_msg.hh>
 
 #include "symbt.hh"
+#include "symprof.hh"
 #include "symseg.hh"
 #include "symutil.hh"
 #include "util.hh"
 #include "worklist.hh"
 
+#include <algorithm>
+#include <atomic>
+#include <set>
 #include <tuple>
 
+#include <boost/functional/hash.hpp>
+
 bool matchOffsets(
         const SymHeapCore       &sh1,
         const SymHeapCore       &sh2,
@@ -336,13 +342,57 @@ class VarScheduleVisitor {
         }
 };
 
-bool areEqual(
+// statistics of areEqual(), updated by multiple threads
+static struct {
+    std::atomic<unsigned long>  calls;
+    std::atomic<unsigned long>  exitPoints;
+    std::atomic<unsigned long>  programVars;
+    std::atomic<unsigned long>  preds;
+} eqStats;
+
+void readAreEqualStats(AreEqualStats *pDst)
+{
+    pDst->calls         = eqStats.calls.load(std::memory_order_relaxed);
+    pDst->exitPoints    = eqStats.exitPoints.load(std::memory_order_relaxed);
+    pDst->programVars   = eqStats.programVars.load(std::memory_order_relaxed);
+    pDst->preds         = eqStats.preds.load(std::memory_order_relaxed);
+}
+
+/// O(1) check of the properties that have to match if areEqual() holds
+static bool /* mismatch */ rejectEarly(
         const SymHeap           &sh1,
         const SymHeap           &sh2)
 {
-    if (!areEqual(sh1.exitPoint(), sh2.exitPoint()))
-        return false;
+    const std::memory_order relaxed = std::memory_order_relaxed;
+
+    if (!areEqual(sh1.exitPoint(), sh2.exitPoint())) {
+        eqStats.exitPoints.fetch_add(1UL, relaxed);
+        return true;
+    }
+
+    // traverseProgramVarsGeneric() requires the same sets of variables
+    if (sh1.cntProgramVars() != sh2.cntProgramVars()
+            || sh1.hashOfProgramVars() != sh2.hashOfProgramVars())
+    {
+        eqStats.programVars.fetch_add(1UL, relaxed);
+        return true;
+    }
+
+    // matchPreds() maps the predicates injectively in both directions
+    if (sh1.cntNeqs() != sh2.cntNeqs()
+            || sh1.cntCoincidences() != sh2.cntCoincidences())
+    {
+        eqStats.preds.fetch_add(1UL, relaxed);
+        return true;
+    }
+
+    return false;
+}
 
+static bool areEqualCore(
+        const SymHeap           &sh1,
+        const SymHeap           &sh2)
+{
     SymHeap &sh1Writable = const_cast<SymHeap &>(sh1);
     SymHeap &sh2Writable = const_cast<SymHeap &>(sh2);
 
@@ -373,3 +423,122 @@ bool areEqual(
     return sh1.matchPreds(sh2, vMap[0])
         && sh2.matchPreds(sh1, vMap[1]);
 }
+
+bool areEqual(
+        const SymHeap           &sh1,
+        const SymHeap           &sh2)
+{
+    ProfScope prof(PP_ARE_EQUAL);
+    eqStats.calls.fetch_add(1UL, std::memory_order_relaxed);
+
+    if (rejectEarly(sh1, sh2)) {
+        // the full comparison would fail anyway (it ignores exit points)
+        CL_BREAK_IF(areEqual(sh1.exitPoint(), sh2.exitPoint())
+                && areEqualCore(sh1, sh2));
+        return false;
+    }
+
+    return areEqualCore(sh1, sh2);
+}
+
+void hashObject(
+        size_t                  *pSeed,
+        const SymHeap           &sh,
+        const TObjId            obj,
+        const unsigned          depth)
+{
+    using boost::hash_combine;
+    size_t seed = 0;
+    hash_combine(seed, depth);
+
+    // these properties are compared by matchRoots() and cmpValues()
+    const bool isValid = sh.isValid(obj);
+    hash_combine(seed, isValid);
+
+    const TSizeRange size = sh.objSize(obj);
+    hash_combine(seed, size.lo);
+    hash_combine(seed, size.hi);
+
+    hash_combine(seed, sh.isAnonStackObj(obj));
+    hash_combine(seed, sh.objProtoLevel(obj));
+
+    if (isValid) {
+        const EObjKind kind = sh.objKind(obj);
+        hash_combine(seed, static_cast<int>(kind));
+        if (OK_REGION != kind)
+            hash_combine(seed, sh.segMinLength(obj));
+    }
+
+    *pSeed = seed;
+}
+
+THeapFingerprint heapFingerprint(const SymHeap &sh)
+{
+    using boost::hash_combine;
+    size_t seed = 0;
+
+    // areEqual() does not match NULL exit point with a non-NULL one
+    hash_combine(seed, !!sh.exitPoint());
+
+    // roots of the traversal are the same as in areEqual(), except OBJ_RETURN,
+    // which areEqual() traverses if it has an estimated type in @b either heap
+    TObjList todo;
+
+    // program variables have to match exactly
+    TObjList vars;
+    sh.gatherObjects(vars, isProgramVar);
+    TCVarSet cVars;
+    for (const TObjId obj : vars) {
+        if (OBJ_RETURN == obj || sh.isAnonStackObj(obj))
+            continue;
+
+        cVars.insert(sh.cVarByObject(obj));
+        todo.push_back(obj);
+    }
+
+    for (const CVar &cv : cVars) {
+        hash_combine(seed, cv.uid);
+        hash_combine(seed, cv.inst);
+    }
+
+    // matchPreds() maps the predicates injectively in both directions
+    hash_combine(seed, sh.cntNeqs());
+    hash_combine(seed, sh.cntCoincidences());
+
+    // breadth-first search of the objects reachable via live fields
+    std::set<TObjId> seen(todo.begin(), todo.end());
+    seen.insert(OBJ_RETURN);
+    std::vector<size_t> objHashes;
+    for (unsigned depth = 0U; !todo.empty(); ++depth) {
+        TObjList next;
+        for (const TObjId obj : todo) {
+            size_t objHash;
+            hashObject(&objHash, sh, obj, depth);
+            objHashes.push_back(objHash);
+
+            if (!sh.isValid(obj))
+                continue;
+
+            FldList fields;
+            sh.gatherLiveFields(fields, obj);
+            for (const FldHandle &fld : fields) {
+                const TValId val = fld.value();
+                if (val <= VAL_NULL || !isAnyDataArea(sh.valTarget(val)))
+                    continue;
+
+                const TObjId target = sh.objByAddr(val);
+                if (insertOnce(seen, target))
+                    next.push_back(target);
+            }
+        }
+
+        todo.swap(next);
+    }
+
+    // the order of objects is not preserved by isomorphism
+    std::sort(objHashes.begin(), objHashes.end());
+    boost::hash_range(seed, objHashes.begin(), objHashes.end());
+
+    // zero is reserved for "not computed yet"
+    return (seed) ? seed : 1U;
+}
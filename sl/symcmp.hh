@@ -32,11 +32,42 @@
 /// either intra-heap or inter-heap value mapping
 typedef TValMap                                             TValMapBidir[2];
 
-/// @todo some dox
+/**
+ * return true if the given heaps are isomorphic.  The heaps that differ in the
+ * counters kept by SymHeapCore (program variables, predicates), or in their
+ * exit points, are refused in O(1) time without traversing them.
+ */
 bool areEqual(
         const SymHeap           &sh1,
         const SymHeap           &sh2);
 
+/// counts of areEqual() calls and of the calls refused in O(1) time
+struct AreEqualStats {
+    unsigned long   calls;          ///< all calls of areEqual()
+    unsigned long   exitPoints;     ///< refused due to exit point mismatch
+    unsigned long   programVars;    ///< refused due to program var mismatch
+    unsigned long   preds;          ///< refused due to count of predicates
+};
+
+/// read the statistics of areEqual() collected so far
+void readAreEqualStats(AreEqualStats *pDst);
+
+/// hash of a symbolic heap that is invariant under graph isomorphism
+typedef size_t                                              THeapFingerprint;
+
+/**
+ * compute a fingerprint of the given symbolic heap such that two heaps with
+ * distinct fingerprints are guaranteed to be @b not equal in terms of areEqual()
+ *
+ * The fingerprint covers the exit point, program variables, count of extra
+ * predicates and the properties of objects reachable from program variables
+ * (grouped by their distance from program variables).  OBJ_RETURN is not
+ * traversed because areEqual() does not always compare it.  The fingerprint is
+ * never zero, which can thus be used by the callers to denote "not computed
+ * yet".
+ */
+THeapFingerprint heapFingerprint(const SymHeap &sh);
+
 inline bool checkNonPosValues(int a, int b)
 {
     if (0 < a && 0 < b)
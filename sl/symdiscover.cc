@@ -27,11 +27,14 @@
 #include "prototype.hh"
 #include "symcmp.hh"
 #include "symjoin.hh"
+#include "symprof.hh"
 #include "symseg.hh"
 #include "symutil.hh"
 #include "util.hh"
+#include "worklist.hh"
 
 #include <algorithm>                // for std::copy()
+#include <iterator>
 #include <set>
 
 // costs are now hard-wired in the paper, so they were removed from config.h
@@ -673,13 +676,37 @@ bool selectBestAbstraction(
     return true;
 }
 
-bool discoverBestAbstraction(Shape *pDst, SymHeap &sh)
+/// gather heap objects that can reach an object changed since the last scan
+bool /* known */ gatherObjsNearTouchedObjs(TObjSet &dst, SymHeap &sh)
+{
+    TObjSet touched;
+    if (!sh.gatherTouchedObjs(touched))
+        return false;
+
+    // segDiscover() of an entry sees only objects reachable from the entry
+    WorkList<TObjId> wl;
+    for (const TObjId obj : touched)
+        wl.schedule(obj);
+
+    TObjId obj;
+    while (wl.next(obj)) {
+        if (sh.isValid(obj) && isOnHeap(sh.objStorClass(obj)))
+            dst.insert(obj);
+
+        FldList refs;
+        sh.pointedBy(refs, obj);
+        for (const FldHandle &fld : refs)
+            wl.schedule(fld.obj());
+    }
+
+    return true;
+}
+
+bool discoverAmongObjs(Shape *pDst, SymHeap &sh, const TObjList &heapObjs)
 {
     TSegCandidateList candidates;
 
     // go through all potential segment entries
-    TObjList heapObjs;
-    sh.gatherObjects(heapObjs, isOnHeap);
     for (const TObjId obj : heapObjs) {
         /// probe neighbouring objects
         SegCandidate segc;
@@ -695,3 +722,37 @@ bool discoverBestAbstraction(Shape *pDst, SymHeap &sh)
 
     return selectBestAbstraction(pDst, sh, candidates);
 }
+
+bool discoverBestAbstraction(Shape *pDst, SymHeap &sh)
+{
+    ProfScope prof(PP_DISCOVER_BEST_ABSTRACTION);
+
+    TObjList heapObjs;
+    TObjSet near;
+    const bool nearOnly = gatherObjsNearTouchedObjs(near, sh);
+    if (nearOnly)
+        // the last scan found nothing, so only entries near changes can succeed
+        std::copy(near.begin(), near.end(), std::back_inserter(heapObjs));
+    else
+        // changes since the last scan are unknown, go through all objects
+        sh.gatherObjects(heapObjs, isOnHeap);
+
+    const bool found = discoverAmongObjs(pDst, sh, heapObjs);
+
+#ifndef NDEBUG
+    if (!nearOnly)
+        return found;
+
+    // check that the scan of all objects would give the same result
+    SymHeap shAll(sh);
+    shAll.forkEntIds();
+    TObjList allObjs;
+    shAll.gatherObjects(allObjs, isOnHeap);
+    Shape shapeAll;
+    const bool foundAll = discoverAmongObjs(&shapeAll, shAll, allObjs);
+    CL_BREAK_IF(found != foundAll);
+    CL_BREAK_IF(found && *pDst != shapeAll);
+#endif
+
+    return found;
+}
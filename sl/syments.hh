@@ -24,13 +24,15 @@
 
 #include "util.hh"
 
+#include <atomic>
 #include <vector>
 
 #if SH_COPY_ON_WRITE
+/// reference counter safe to be shared among threads (see GlConf::Options)
 class RefCounter {
     private:
         typedef int TCnt;
-        TCnt cnt_;
+        std::atomic<TCnt> cnt_;
 
     public:
         /// initialize to 1
@@ -47,36 +49,29 @@ class RefCounter {
 
         /// initialize to 1, even if the source has another value
         RefCounter& operator=(const RefCounter &) {
-            cnt_ = 1;
+            cnt_.store(1, std::memory_order_relaxed);
             return *this;
         }
 
         /// the destruction is only allowed with reference count equal to zero
         ~RefCounter() {
-            CL_BREAK_IF(cnt_);
+            CL_BREAK_IF(cnt_.load(std::memory_order_relaxed));
         }
 
         bool isShared() const {
-            CL_BREAK_IF(cnt_ < 1);
-            return (1 < cnt_);
+            const TCnt cnt = cnt_.load(std::memory_order_acquire);
+            CL_BREAK_IF(cnt < 1);
+            return (1 < cnt);
         }
 
         bool /* needCloning */ enter() {
-            CL_BREAK_IF(cnt_ < 1);
-            ++cnt_;
+            CL_BREAK_IF(cnt_.load(std::memory_order_relaxed) < 1);
+            cnt_.fetch_add(1, std::memory_order_relaxed);
             return false;
         }
 
-        bool /* needCloning */ requireExclusivity() {
-            if (!this->isShared())
-                return false;
-
-            --cnt_;
-            return true;
-        }
-
         bool /* wasLast */ leave() {
-            return !(--cnt_);
+            return (1 == cnt_.fetch_sub(1, std::memory_order_acq_rel));
         }
 
 }; // class RefCounter
@@ -94,10 +89,6 @@ class RefCounter {
             return true;
         }
 
-        bool /* needCloning */ requireExclusivity() {
-            return false;
-        }
-
         bool /* wasLast */ leave() {
             return true;
         }
@@ -145,8 +136,14 @@ template <enum ERefCntObjKind TKind> struct RefCntLib {
     }
 
     template <class T> static void requireExclusivity(T *&ptr) {
-        if (/* needCloning */ ptr->refCnt.requireExclusivity())
-            RefCntUtil<TKind>::clone(ptr);
+        if (!ptr->refCnt.isShared())
+            return;
+
+        // clone the object before leaving it as it may be destroyed by
+        // another thread as soon as we leave it
+        T *orig = ptr;
+        RefCntUtil<TKind>::clone(ptr);
+        RefCntLib<TKind>::leave(orig);
     }
 };
 
@@ -162,6 +159,15 @@ struct EntCounter {
 #endif
 };
 
+/**
+ * persistent vector of entity pointers, shared among SymHeap instances
+ *
+ * The pointers are kept in fixed-size chunks (see SH_ENT_STORE_CHUNK_SIZE),
+ * which are reference-counted on their own.  A copy of EntStore only copies
+ * the (much shorter) vector of chunk pointers.  A chunk is cloned as soon as
+ * it is about to be changed while shared, so the cost of SymHeap cloning is
+ * proportional to the count of chunks changed since, not to the heap size.
+ */
 template <class TBaseEnt>
 class EntStore {
     public:
@@ -176,7 +182,7 @@ class EntStore {
 
         template <typename TId> TId lastId() const {
             // we need to be careful with integral arithmetic on enums
-            const long last = -1L + ents_.size();
+            const long last = -1L + size_;
             return static_cast<TId>(last);
         }
 
@@ -193,17 +199,76 @@ class EntStore {
         template <class TEnt, typename TId>
         inline void getEntRW(TEnt **, TId id);
 
+        /// stop sharing the counter of entity IDs with other instances
+        inline void forkEntCounter();
+
     private:
         // intentionally not implemented
         EntStore& operator=(const EntStore &);
 
-        std::vector<TBaseEnt *>                 ents_;
+        static const unsigned CHUNK_SIZE = SH_ENT_STORE_CHUNK_SIZE;
+
+        struct Chunk {
+            RefCounter          refCnt;
+            TBaseEnt           *ents[CHUNK_SIZE];
+
+            Chunk() {
+                for (TBaseEnt *&ent : ents)
+                    ent = 0;
+            }
+
+            /// each entity is referenced by one more chunk now
+            Chunk(const Chunk &ref) {
+                for (unsigned i = 0; i < CHUNK_SIZE; ++i) {
+                    TBaseEnt *ent = ref.ents[i];
+                    if (ent)
+                        RefCntLib<RCO_VIRTUAL>::enter(ent);
+
+                    ents[i] = ent;
+                }
+            }
+
+            ~Chunk() {
+                for (TBaseEnt *ent : ents)
+                    if (ent)
+                        RefCntLib<RCO_VIRTUAL>::leave(ent);
+            }
+
+            private:
+                // intentionally not implemented
+                Chunk& operator=(const Chunk &);
+        };
+
+        /// return a reference to the slot of the given ID for reading
+        template <typename TId> TBaseEnt *const& slotRO(const TId id) const {
+            const long idx = static_cast<long>(id);
+            const Chunk *chunk = chunks_[idx / CHUNK_SIZE];
+            return chunk->ents[idx % CHUNK_SIZE];
+        }
+
+        /// return a reference to the slot of the given ID for writing
+        template <typename TId> inline TBaseEnt *& slotRW(TId id);
+
+        std::vector<Chunk *>                    chunks_;
+        long                                    size_;
         EntCounter                             *entCnt_;
 };
 
 
 // /////////////////////////////////////////////////////////////////////////////
 // implementation of EntStore
+template <class TBaseEnt>
+template <typename TId>
+TBaseEnt *& EntStore<TBaseEnt>::slotRW(const TId id)
+{
+    const long idx = static_cast<long>(id);
+
+    // clone the chunk if it is shared with another instance of EntStore
+    Chunk *&chunk = chunks_[idx / CHUNK_SIZE];
+    RefCntLib<RCO_NON_VIRT>::requireExclusivity(chunk);
+    return chunk->ents[idx % CHUNK_SIZE];
+}
+
 template <class TBaseEnt>
 template <typename TId>
 TId EntStore<TBaseEnt>::assignId(TBaseEnt *ptr)
@@ -211,12 +276,11 @@ TId EntStore<TBaseEnt>::assignId(TBaseEnt *ptr)
     CL_BREAK_IF(ptr->refCnt.isShared());
 #if SH_PREVENT_AMBIGUOUS_ENT_ID
     const TId id = static_cast<TId>(entCnt_->entCnt);
-    this->assignId(id, ptr);
-    return id;
 #else
-    this->ents_.push_back(ptr);
-    return this->lastId<TId>();
+    const TId id = static_cast<TId>(size_);
 #endif
+    this->assignId(id, ptr);
+    return id;
 }
 
 template <class TBaseEnt>
@@ -226,10 +290,13 @@ void EntStore<TBaseEnt>::assignId(const TId id, TBaseEnt *ptr)
     CL_BREAK_IF(ptr->refCnt.isShared());
 
     // make sure we have enough space allocated
-    if (this->lastId<TId>() < id)
-        ents_.resize(id + 1, 0);
+    if (this->lastId<TId>() < id) {
+        size_ = 1L + id;
+        while (chunks_.size() * CHUNK_SIZE < static_cast<unsigned long>(size_))
+            chunks_.push_back(new Chunk);
+    }
 
-    TBaseEnt *&ref = ents_[id];
+    TBaseEnt *&ref = this->slotRW(id);
 
     // if this fails, you wanted to overwrite pointer to a valid entity
     CL_BREAK_IF(ref);
@@ -246,7 +313,7 @@ template <class TBaseEnt>
 template <typename TId>
 void EntStore<TBaseEnt>::releaseEnt(const TId id)
 {
-    RefCntLib<RCO_VIRTUAL>::leave(ents_[id]);
+    RefCntLib<RCO_VIRTUAL>::leave(this->slotRW(id));
 }
 
 template <class TBaseEnt>
@@ -256,20 +323,22 @@ bool EntStore<TBaseEnt>::isValidEnt(const TId id) const
     if (this->outOfRange(id))
         return false;
 
-    return !!ents_[id];
+    return !!this->slotRO(id);
 }
 
 template <class TBaseEnt>
-EntStore<TBaseEnt>::EntStore()
+EntStore<TBaseEnt>::EntStore():
+    size_(0L)
 #if SH_PREVENT_AMBIGUOUS_ENT_ID
-    : entCnt_(new EntCounter)
+    , entCnt_(new EntCounter)
 #endif
 {
 }
 
 template <class TBaseEnt>
 EntStore<TBaseEnt>::EntStore(const EntStore &ref):
-    ents_(ref.ents_)
+    chunks_(ref.chunks_),
+    size_(ref.size_)
 #if SH_PREVENT_AMBIGUOUS_ENT_ID
     , entCnt_(ref.entCnt_)
 #endif
@@ -277,9 +346,8 @@ EntStore<TBaseEnt>::EntStore(const EntStore &ref):
 #if SH_PREVENT_AMBIGUOUS_ENT_ID
     RefCntLib<RCO_NON_VIRT>::enter(entCnt_);
 #endif
-    for (TBaseEnt *&ent : ents_)
-        if (ent)
-            RefCntLib<RCO_VIRTUAL>::enter(ent);
+    for (Chunk *&chunk : chunks_)
+        RefCntLib<RCO_NON_VIRT>::enter(chunk);
 }
 
 template <class TBaseEnt>
@@ -288,9 +356,16 @@ EntStore<TBaseEnt>::~EntStore()
 #if SH_PREVENT_AMBIGUOUS_ENT_ID
     RefCntLib<RCO_NON_VIRT>::leave(entCnt_);
 #endif
-    for (TBaseEnt *ent : ents_)
-        if (ent)
-            RefCntLib<RCO_VIRTUAL>::leave(ent);
+    for (Chunk *&chunk : chunks_)
+        RefCntLib<RCO_NON_VIRT>::leave(chunk);
+}
+
+template <class TBaseEnt>
+void EntStore<TBaseEnt>::forkEntCounter()
+{
+#if SH_PREVENT_AMBIGUOUS_ENT_ID
+    RefCntLib<RCO_NON_VIRT>::requireExclusivity(entCnt_);
+#endif
 }
 
 template <class TBaseEnt>
@@ -301,7 +376,7 @@ inline const TBaseEnt* EntStore<TBaseEnt>::getEntRO(const TId id)
     CL_BREAK_IF(this->outOfRange(id));
 
     // if this fails, the ID is no longer valid
-    const TBaseEnt *ptr = ents_[id];
+    const TBaseEnt *ptr = this->slotRO(id);
     CL_BREAK_IF(!ptr);
     return ptr;
 }
@@ -313,7 +388,8 @@ inline TBaseEnt* EntStore<TBaseEnt>::getEntRW(const TId id)
 #ifndef NDEBUG
     this->getEntRO(id);
 #endif
-    TBaseEnt *&entRW = ents_[id];
+    // the entity may still be shared with other chunks after this
+    TBaseEnt *&entRW = this->slotRW(id);
     RefCntLib<RCO_VIRTUAL>::requireExclusivity(entRW);
     return entRW;
 }
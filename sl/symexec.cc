@@ -25,6 +25,7 @@
 #include <cl/clutil.hh>
 #include <cl/memdebug.hh>
 #include <cl/storage.hh>
+#include <cl/thread_pool.hh>
 
 #include "fixed_point_proxy.hh"
 #include "glconf.hh"
@@ -33,15 +34,22 @@
 #include "symcall.hh"
 #include "symdebug.hh"
 #include "symproc.hh"
+#include "symprof.hh"
 #include "symstate.hh"
 #include "symutil.hh"
 #include "symtrace.hh"
 #include "util.hh"
 
+#include <chrono>
+#include <exception>
+#include <fstream>
 #include <queue>
 #include <set>
 #include <sstream>
 #include <stdexcept>
+#include <unordered_set>
+
+#include <unistd.h>
 
 LOCAL_DEBUG_PLOTTER(nondetCond, DEBUG_SE_NONDET_COND)
 
@@ -53,6 +61,111 @@ bool installSignalHandlers(void)
         && SignalCatcher::install(SIGTERM);
 }
 
+// /////////////////////////////////////////////////////////////////////////////
+// anytime mode
+typedef std::chrono::steady_clock                   TBudgetClock;
+
+static struct {
+    bool                                            active;
+    TBudgetClock::time_point                        start;
+    TBudgetClock::time_point                        lastMemCheck;
+    bool                                            memUnavailable;
+    std::unordered_set<const CodeStorage::Block *>  reachedBlocks;
+    std::unordered_set<const CodeStorage::Fnc *>    reachedFncs;
+} budget;
+
+void startBudgets()
+{
+    const GlConf::Options &opts = GlConf::data;
+    budget.active = (0 < opts.timeBudget) || (0 < opts.memBudget);
+    budget.start = TBudgetClock::now();
+    budget.lastMemCheck = budget.start;
+    budget.memUnavailable = false;
+    budget.reachedBlocks.clear();
+    budget.reachedFncs.clear();
+}
+
+// resident set size of the process, used if memdebug is compiled out
+static bool rssMemUsage(ssize_t *pDst)
+{
+    std::ifstream str("/proc/self/statm");
+    long size, resident;
+    if (!(str >> size >> resident))
+        return false;
+
+    *pDst = static_cast<ssize_t>(resident) * sysconf(_SC_PAGESIZE);
+    return true;
+}
+
+static void checkBudgets()
+{
+    if (!budget.active)
+        return;
+
+    const GlConf::Options &opts = GlConf::data;
+    const TBudgetClock::time_point now = TBudgetClock::now();
+    if (0 < opts.timeBudget
+            && std::chrono::seconds(opts.timeBudget) <= now - budget.start)
+    {
+        std::ostringstream str;
+        str << "time budget of " << opts.timeBudget << " s exhausted";
+        throw BudgetExhaustedException(str.str());
+    }
+
+    if (opts.memBudget <= 0 || budget.memUnavailable
+            || now - budget.lastMemCheck < std::chrono::milliseconds(
+                SE_MEM_BUDGET_CHECK_INTERVAL))
+        return;
+
+    budget.lastMemCheck = now;
+
+    ssize_t cb;
+    if (!currentMemUsage(&cb) && !rssMemUsage(&cb)) {
+        CL_WARN("memory usage is not available, mem_budget is ignored");
+        budget.memUnavailable = true;
+        return;
+    }
+
+    if (cb < (static_cast<ssize_t>(opts.memBudget) << /* MiB */ 20))
+        return;
+
+    std::ostringstream str;
+    str << "memory budget of " << opts.memBudget << " MB exhausted";
+    throw BudgetExhaustedException(str.str());
+}
+
+static void reachBlock(
+        const CodeStorage::Fnc          *fnc,
+        const CodeStorage::Block        *bb)
+{
+    if (!budget.active)
+        return;
+
+    budget.reachedFncs.insert(fnc);
+    budget.reachedBlocks.insert(bb);
+}
+
+void printIncompleteVerdict(
+        const CodeStorage::Storage      &stor,
+        const BudgetExhaustedException  &reason)
+{
+    unsigned cntBlocks = 0U;
+    unsigned cntFncs = 0U;
+    for (const CodeStorage::Fnc *fnc : stor.fncs) {
+        if (!isDefined(*fnc))
+            continue;
+
+        cntBlocks += fnc->cfg.size();
+        ++cntFncs;
+    }
+
+    CL_NOTE("verdict: incomplete (" << reason.what()
+            << "), reached blocks: " << budget.reachedBlocks.size()
+            << "/" << cntBlocks
+            << ", reached functions: " << budget.reachedFncs.size()
+            << "/" << cntFncs);
+}
+
 // /////////////////////////////////////////////////////////////////////////////
 // ExecStack
 class SymExecEngine;
@@ -69,11 +182,7 @@ typedef std::deque<ExecStackItem> TExecStack;
 // SymExec
 class SymExec: public IStatsProvider {
     public:
-        SymExec(const CodeStorage::Storage &stor):
-            stor_(stor),
-            callCache_(stor)
-        {
-        }
+        SymExec(const CodeStorage::Storage &stor);
 
         /// just to avoid memory leakage in case an exception falls through
         ~SymExec();
@@ -98,6 +207,7 @@ class SymExec: public IStatsProvider {
         const CodeStorage::Storage              &stor_;
         SymCallCache                            callCache_;
         TExecStack                              execStack_;
+        ThreadPool                              *pool_;
 };
 
 // /////////////////////////////////////////////////////////////////////////////
@@ -108,11 +218,13 @@ class SymExecEngine: public IStatsProvider {
                 SymState                &results,
                 const SymHeap           &entry,
                 const IStatsProvider    &stats,
-                SymBackTrace            &bt):
+                SymBackTrace            &bt,
+                ThreadPool              *pool):
             stor_(entry.stor()),
             bt_(bt),
             dst_(results),
             stats_(stats),
+            pool_(pool),
             sched_(stateMap_),
             block_(0),
             insnIdx_(0),
@@ -140,6 +252,7 @@ class SymExecEngine: public IStatsProvider {
         SymBackTrace                    &bt_;
         SymState                        &dst_;
         const IStatsProvider            &stats_;
+        ThreadPool                      *pool_;
         std::string                     fncName_;
         TObjType                        fncReturnType_;
 
@@ -185,7 +298,9 @@ class SymExecEngine: public IStatsProvider {
         void execReturn();
         void execCondInsn();
         void execTermInsn();
+        bool execNontermInsnCore(SymState &dst, SymHeap &sh, bool *pFatal);
         bool execNontermInsn();
+        bool execInsnInParallel();
         bool execInsn();
         bool execBlock();
         void processPendingSignals();
@@ -315,6 +430,10 @@ void SymExecEngine::updateState(SymHeap &sh, const CodeStorage::Block *ofBlock)
     if (!GlConf::data.joinOnLoopEdgesOnly)
         closingLoop = true;
 
+    if (GlConf::data.traceFree)
+        // release the trace built while executing the current block
+        Trace::collapse(sh);
+
     // update _target_ state and check if anything has changed
     if (stateMap_.insert(ofBlock, sh, closingLoop)) {
         const SymStateMarked &target = stateMap_[ofBlock];
@@ -588,7 +707,11 @@ void SymExecEngine::execTermInsn()
     }
 }
 
-bool /* handled */ SymExecEngine::execNontermInsn()
+/// @param sh a fresh clone of the heap to execute the instruction on
+bool /* handled */ SymExecEngine::execNontermInsnCore(
+        SymState                    &dst,
+        SymHeap                     &sh,
+        bool                        *pFatal)
 {
     const CodeStorage::Insn *insn = block_->operator[](insnIdx_);
 
@@ -596,8 +719,6 @@ bool /* handled */ SymExecEngine::execNontermInsn()
     const SymExecCoreParams ep(GlConf::data);
 
     // working area for non-terminal instructions
-    const SymHeap &origin = localState_[heapIdx_];
-    SymHeap sh(origin);
     SymExecCore core(sh, &bt_, ep);
     core.setLocation(lw_);
 
@@ -605,12 +726,25 @@ bool /* handled */ SymExecEngine::execNontermInsn()
     Trace::waiveCloneOperation(sh);
 
     // execute the instruction
-    if (!core.exec(nextLocalState_, *insn)) {
+    if (!core.exec(dst, *insn)) {
         CL_BREAK_IF(CL_INSN_CALL != insn->code);
         return false;
     }
 
-    if (core.hasFatalError())
+    *pFatal = core.hasFatalError();
+    return /* insn handled */ true;
+}
+
+bool /* handled */ SymExecEngine::execNontermInsn()
+{
+    const SymHeap &origin = localState_[heapIdx_];
+    SymHeap sh(origin);
+
+    bool fatal;
+    if (!this->execNontermInsnCore(nextLocalState_, sh, &fatal))
+        return false;
+
+    if (fatal)
         // suppress the annoying warnings 'end of foo() not reached' since we
         // have already told user that there was something more serious going on
         endReached_ = true;
@@ -638,6 +772,109 @@ bool /* handled */ SymExecEngine::handleExitPoint(const SymHeap &origin)
     return true;
 }
 
+/// results of a single heap executed by a thread of ThreadPool
+struct ParallelHeapJob {
+    bool                    active;     ///< false if the heap is already done
+    bool                    scheduled;  ///< true if executed by ThreadPool
+    bool                    fatal;      ///< see SymProc::hasFatalError()
+    SymHeapList             dst;        ///< results of the instruction
+    cl_msg_list             msgs;       ///< messages emitted by the thread
+    std::exception_ptr      error;      ///< exception thrown by the thread
+
+    ParallelHeapJob():
+        active(false),
+        scheduled(false),
+        fatal(false)
+    {
+    }
+};
+
+bool /* complete */ SymExecEngine::execInsnInParallel()
+{
+    const CodeStorage::Insn *insn = block_->operator[](insnIdx_);
+    CL_BREAK_IF(heapIdx_);
+
+    // used only if (0 == insnIdx_)
+    SymStateMarked &origin = stateMap_[block_];
+
+    // pick the heaps to be executed the same way as execInsn() does
+    const unsigned hCnt = localState_.size();
+    std::vector<ParallelHeapJob> jobs(hCnt);
+    for (unsigned idx = 0U; idx < hCnt; ++idx) {
+        if (!insnIdx_) {
+            if (origin.isDone(idx))
+                continue;
+
+            origin.setDone(idx);
+        }
+
+        const SymHeap &sh = localState_[idx];
+        if (GlConf::data.fixedPoint)
+            GlConf::data.fixedPoint->insert(insn, sh,
+                    bt_.countOccurrencesOfTopFnc());
+
+        ParallelHeapJob &job = jobs[idx];
+        job.active = true;
+
+        // exit points are handled sequentially while merging the results
+        job.scheduled = !sh.exitPoint();
+    }
+
+    // execute the instruction on all scheduled heaps in parallel
+    pool_->runAll(hCnt, [this, &jobs](const unsigned idx) {
+        ParallelHeapJob &job = jobs[idx];
+        if (!job.scheduled)
+            return;
+
+        cl_msg_capture(&job.msgs);
+        try {
+            // keep the IDs of new entities independent of the other threads
+            SymHeap sh(localState_[idx]);
+            sh.forkEntIds();
+
+            const bool handled = this->execNontermInsnCore(job.dst, sh,
+                    &job.fatal);
+            CL_BREAK_IF(!handled);
+            (void) handled;
+        }
+        catch (...) {
+            job.error = std::current_exception();
+        }
+        cl_msg_capture(0);
+    });
+
+    // merge the results in the order of heaps, as if executed sequentially
+    for (heapIdx_ = 0U; heapIdx_ < hCnt; ++heapIdx_) {
+        ParallelHeapJob &job = jobs[heapIdx_];
+        if (!job.active)
+            continue;
+
+        CL_DEBUG_MSG(lw_, "*** processing block " << block_->name()
+                     << ", heap #" << heapIdx_
+                     << " (initial size of state was " << hCnt << ")");
+
+        // time to respond to a single pending signal
+        this->processPendingSignals();
+
+        if (this->handleExitPoint(localState_[heapIdx_]))
+            // program exited on this execution path, go directly to the caller
+            continue;
+
+        cl_msg_replay(job.msgs);
+        if (job.error)
+            std::rethrow_exception(job.error);
+
+        nextLocalState_.splice(job.dst);
+        if (job.fatal)
+            // see execNontermInsn()
+            endReached_ = true;
+    }
+
+    // completed execution of the given insn
+    heapIdx_ = 0;
+    return true;
+}
+
 bool /* complete */ SymExecEngine::execInsn()
 {
     const CodeStorage::Insn *insn = block_->operator[](insnIdx_);
@@ -665,6 +902,11 @@ bool /* complete */ SymExecEngine::execInsn()
         }
     }
 
+    if (pool_ && !isTerm && !nextInsnIsCond && CL_INSN_CALL != insn->code
+            && 1 < localState_.size())
+        // the heaps are independent of each other until they reach stateMap_
+        return this->execInsnInParallel();
+
     // used only if (0 == insnIdx_)
     SymStateMarked &origin = stateMap_[block_];
 
@@ -684,7 +926,8 @@ bool /* complete */ SymExecEngine::execInsn()
 
         // capture fixed-point for plotting if configured to do so
         if (GlConf::data.fixedPoint)
-            GlConf::data.fixedPoint->insert(insn, localState_[heapIdx_]);
+            GlConf::data.fixedPoint->insert(insn, localState_[heapIdx_],
+                    bt_.countOccurrencesOfTopFnc());
 
         if (nextInsnIsCond)
             // this is going to be handled in execCondInsn() right away
@@ -811,6 +1054,7 @@ void SymExecEngine::joinCallResults()
 bool /* complete */ SymExecEngine::run()
 {
     const CodeStorage::Fnc fnc = *bt_.topFnc();
+    ProfScope prof(PP_RUN_FNC, bt_.topFnc());
 
     if (waiting_) {
         // pick up results of the pending call
@@ -834,6 +1078,7 @@ bool /* complete */ SymExecEngine::run()
         // update location info and ptracer
         const CodeStorage::Insn *first = block_->front();
         lw_ = &first->loc;
+        reachBlock(bt_.topFnc(), block_);
 
         // enter the basic block
         const std::string &name = block_->name();
@@ -1010,6 +1255,9 @@ void SymExecEngine::forceEndReached()
 
 void SymExecEngine::processPendingSignals()
 {
+    // stop as soon as a budget of the anytime mode runs out
+    checkBudgets();
+
     int signum;
     if (!SignalCatcher::caught(&signum))
         return;
@@ -1091,6 +1339,25 @@ thr_reached:
 
 // /////////////////////////////////////////////////////////////////////////////
 // SymExec implementation
+SymExec::SymExec(const CodeStorage::Storage &stor):
+    stor_(stor),
+    callCache_(stor),
+    pool_(0)
+{
+    const int cntThreads = GlConf::data.threads;
+    if (cntThreads < 2)
+        return;
+
+    if (GlConf::data.detectContainers) {
+        // FixedPoint::StateByInsn relies on the serial order of entity IDs
+        CL_WARN("option \"threads\" is not supported with "
+                "\"detect_containers\", running single-threaded");
+        return;
+    }
+
+    pool_ = new ThreadPool(cntThreads);
+}
+
 SymExec::~SymExec()
 {
     // NOTE this is actually the right direction (from top of the backtrace)
@@ -1103,6 +1370,11 @@ SymExec::~SymExec()
         delete item.eng;
         printMemUsage("SymExecEngine::~SymExecEngine");
     }
+
+    delete pool_;
+
+    // the join cache may refer to the trace graph
+    clearJoinCache();
 }
 
 const CodeStorage::Fnc* SymExec::resolveCallInsn(
@@ -1184,7 +1456,8 @@ void SymExec::enterCall(SymCallCtx *ctx, SymState &results)
             ctx->rawResults(),
             ctx->entry(),
             /* IStatsProvider */ *this,
-            callCache_.bt());
+            callCache_.bt(),
+            pool_);
 
     // initialize a stack item
     ExecStackItem item;
@@ -1203,6 +1476,8 @@ void SymExec::execFnc(
         const CodeStorage::Insn         &insn,
         const CodeStorage::Fnc          &fnc)
 {
+    ProfScope prof(PP_EXEC_FNC, &fnc);
+
     // get call context for the root function
     SymCallCtx *ctx = callCache_.getCallCtx(entry, fnc, insn);
     CL_BREAK_IF(!ctx || !ctx->needExec());
@@ -1280,6 +1555,7 @@ void SymExec::execFnc(
 void SymExec::printStats() const
 {
     // TODO: print SymCallCache stats here as soon as we have implemented some
+    printSymStateStats();
 
     for (const ExecStackItem &item : execStack_) {
         const IStatsProvider *provider = item.eng;
@@ -1327,7 +1603,15 @@ void execute(
     insn.operands[1] = fnc.def;
 
     // run the symbolic execution
-    execTopCall(results, entry, insn, fnc);
+    try {
+        execTopCall(results, entry, insn, fnc);
+    }
+    catch (...) {
+        // the caller may run us again, see execFnc() in cl_symexec.cc
+        SignalCatcher::cleanup();
+        throw;
+    }
+
     printMemUsage("SymExec::~SymExec");
 
     // uninstall signal handlers
@@ -25,6 +25,9 @@
  * SymExec - top level algorithm of the @b symbolic @b execution
  */
 
+#include <stdexcept>
+#include <string>
+
 class SymHeap;
 class SymState;
 
@@ -38,4 +41,27 @@ void execute(
         const SymHeap                   &entry,
         const CodeStorage::Fnc          &fnc);
 
+/// thrown by execute() once a budget of the anytime mode runs out
+class BudgetExhaustedException: public std::runtime_error {
+    public:
+        BudgetExhaustedException(const std::string &what):
+            std::runtime_error(what)
+        {
+        }
+};
+
+/**
+ * start counting the time and memory budgets of the anytime mode given by the
+ * options time_budget and mem_budget, nothing happens if none is given
+ */
+void startBudgets();
+
+/**
+ * emit the @b incomplete verdict along with the count of basic blocks and
+ * functions reached by symbolic execution before the budget has run out
+ */
+void printIncompleteVerdict(
+        const CodeStorage::Storage      &stor,
+        const BudgetExhaustedException  &reason);
+
 #endif /* H_GUARD_SYM_EXEC_H */
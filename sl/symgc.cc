@@ -22,14 +22,29 @@
 
 #include <cl/cl_msg.hh>
 
+#include "glconf.hh"
 #include "symheap.hh"
 #include "symplot.hh"
+#include "symprof.hh"
 #include "symseg.hh"
 #include "symutil.hh"
 #include "worklist.hh"
 
 #include <stack>
 
+const char* garbageCollectorName(const EGarbageCollectorKind kind)
+{
+    switch (kind) {
+        case GCK_BACKWARD:          return "backward";
+        case GCK_MARK:              return "mark";
+        case GCK_INCREMENTAL:       return "incremental";
+        case GCK_LAST:              break;
+    }
+
+    CL_BREAK_IF("invalid call of garbageCollectorName()");
+    return "unknown";
+}
+
 void gatherReferredRoots(TObjSet &dst, SymHeap &sh, TObjId obj)
 {
     FldList ptrs;
@@ -47,6 +62,16 @@ void gatherReferredRoots(TObjSet &dst, SymHeap &sh, TObjId obj)
     }
 }
 
+/// true for objects that are live no matter whether anything points to them
+bool isRootObj(SymHeap &sh, TObjId obj)
+{
+    const EStorageClass code = sh.objStorClass(obj);
+    return !isOnHeap(code)
+        // non-heap objects cannot be JUNK
+        // ... but anonymous stack objects need to be traversed!
+        && !sh.isAnonStackObj(obj);
+}
+
 bool isJunk(SymHeap &sh, TObjId obj)
 {
     if (!sh.isValid(obj))
@@ -58,11 +83,7 @@ bool isJunk(SymHeap &sh, TObjId obj)
     while (wl.next(obj)) {
         CL_BREAK_IF(!sh.isValid(obj));
 
-        const EStorageClass code = sh.objStorClass(obj);
-        if (!isOnHeap(code)
-            // non-heap objects cannot be JUNK
-            // ... but anonymous stack objects need to be traversed!
-                && !sh.isAnonStackObj(obj))
+        if (isRootObj(sh, obj))
             return false;
 
         // go through all referrers
@@ -75,7 +96,148 @@ bool isJunk(SymHeap &sh, TObjId obj)
     return true;
 }
 
-bool gcCore(SymHeap &sh, TObjId obj, TObjSet *leakObjs, bool sharedOnly)
+/**
+ * tells junk objects from live ones the way GlConf::Options::garbageCollector
+ * says.  The answers are remembered until the oracle is destroyed, which is
+ * fine as long as the heap is changed only by removal of junk in between since
+ * that does not change reachability of the other objects.
+ *
+ * GCK_MARK marks all objects reachable from the root objects at once, forward
+ * over live pointer fields.  Anonymous stack objects are marked only if they
+ * are reachable, as isJunk() does not treat them as root objects either.
+ * GCK_INCREMENTAL walks backwards like isJunk() does, but only through the
+ * objects not visited yet.  Once a walk finds no root object, all the objects
+ * it has visited are junk, so that each object of a junk data structure is
+ * visited only once, no matter how many junk candidates it is reachable from.
+ */
+class JunkOracle {
+    public:
+        JunkOracle(SymHeap &sh):
+            sh_(sh),
+            kind_(static_cast<EGarbageCollectorKind>(
+                        GlConf::data.garbageCollector)),
+            markedAll_(false)
+        {
+        }
+
+        bool isJunk(TObjId obj);
+
+    private:
+        SymHeap                            &sh_;
+        const EGarbageCollectorKind         kind_;
+        bool                                markedAll_;
+        TObjSet                             live_;
+        TObjSet                             junk_;
+
+        void markAll();
+        bool isJunkIncremental(TObjId obj);
+};
+
+static bool isNotOnHeap(const EStorageClass code)
+{
+    return !isOnHeap(code);
+}
+
+void JunkOracle::markAll()
+{
+    // start from the same root objects as isJunk() looks for
+    TObjList objs;
+    sh_.gatherObjects(objs, isNotOnHeap);
+
+    TObjList todo;
+    for (const TObjId obj : objs)
+        if (isRootObj(sh_, obj))
+            todo.push_back(obj);
+
+    // mark forward over live pointer fields, i.e. the edges isJunk() follows
+    // backwards via pointedBy()
+    while (!todo.empty()) {
+        const TObjId obj = todo.back();
+        todo.pop_back();
+        if (!insertOnce(live_, obj))
+            continue;
+
+        FldList fields;
+        sh_.gatherLiveFields(fields, obj);
+        for (const FldHandle &fld : fields) {
+            const TValId val = fld.value();
+            if (val <= 0)
+                continue;
+
+            const TObjId target = sh_.objByAddr(val);
+            if (sh_.isValid(target))
+                todo.push_back(target);
+        }
+    }
+
+    markedAll_ = true;
+}
+
+bool JunkOracle::isJunkIncremental(const TObjId obj)
+{
+    if (hasKey(junk_, obj))
+        return true;
+
+    if (hasKey(live_, obj))
+        return false;
+
+    TObjList visited;
+    WorkList<TObjId> wl(obj);
+    TObjId cur;
+    while (wl.next(cur)) {
+        CL_BREAK_IF(!sh_.isValid(cur));
+
+        if (hasKey(junk_, cur))
+            // no root object can be reached this way
+            continue;
+
+        if (hasKey(live_, cur) || isRootObj(sh_, cur)) {
+            live_.insert(obj);
+            return false;
+        }
+
+        visited.push_back(cur);
+
+        // go through all referrers
+        FldList refs;
+        sh_.pointedBy(refs, cur);
+        for (const FldHandle &fld : refs)
+            wl.schedule(fld.obj());
+    }
+
+    junk_.insert(visited.begin(), visited.end());
+    return true;
+}
+
+bool JunkOracle::isJunk(const TObjId obj)
+{
+    if (GCK_BACKWARD == kind_)
+        return ::isJunk(sh_, obj);
+
+    if (!sh_.isValid(obj))
+        // this object is already freed
+        return false;
+
+    bool junk;
+    if (GCK_INCREMENTAL == kind_)
+        junk = this->isJunkIncremental(obj);
+    else {
+        if (!markedAll_)
+            this->markAll();
+
+        junk = !hasKey(live_, obj) && !isRootObj(sh_, obj);
+    }
+
+    CL_BREAK_IF(junk != ::isJunk(sh_, obj));
+    return junk;
+}
+
+bool gcCore(
+        SymHeap                 &sh,
+        TObjId                   obj,
+        TObjSet                 *leakObjs,
+        bool                     sharedOnly,
+        JunkOracle              &oracle)
 {
     if (OBJ_INVALID == obj)
         return false;
@@ -88,7 +250,7 @@ bool gcCore(SymHeap &sh, TObjId obj, TObjSet *leakObjs, bool sharedOnly)
 
     WorkList<TObjId> wl(obj);
     while (wl.next(obj)) {
-        if (!isJunk(sh, obj))
+        if (!oracle.isJunk(obj))
             // not a junk, keep going...
             continue;
 
@@ -124,12 +286,29 @@ skip_root:
 
 bool collectJunk(SymHeap &sh, TObjId obj, TObjSet *leakObjs)
 {
-    return gcCore(sh, obj, leakObjs, /* sharedOnly */ false);
+    ProfScope prof(PP_COLLECT_JUNK);
+    JunkOracle oracle(sh);
+    return gcCore(sh, obj, leakObjs, /* sharedOnly */ false, oracle);
+}
+
+bool collectJunkFrom(SymHeap &sh, const TObjList &objs, TObjSet *leakObjs)
+{
+    ProfScope prof(PP_COLLECT_JUNK);
+    JunkOracle oracle(sh);
+
+    bool leaking = false;
+    for (const TObjId obj : objs) {
+        if (gcCore(sh, obj, leakObjs, /* sharedOnly */ false, oracle))
+            leaking = true;
+    }
+
+    return leaking;
 }
 
 bool collectSharedJunk(SymHeap &sh, TObjId obj, TObjSet *leakObjs)
 {
-    return gcCore(sh, obj, leakObjs, /* sharedOnly */ true);
+    JunkOracle oracle(sh);
+    return gcCore(sh, obj, leakObjs, /* sharedOnly */ true, oracle);
 }
 
 bool destroyObjectAndCollectJunk(
@@ -147,13 +326,8 @@ bool destroyObjectAndCollectJunk(
     sh.objInvalidate(obj);
 
     // now check for memory leakage
-    bool leaking = false;
-    for (const TObjId obj : refs) {
-        if (collectJunk(sh, obj, leakObjs))
-            leaking = true;
-    }
-
-    return leaking;
+    const TObjList objs(refs.begin(), refs.end());
+    return collectJunkFrom(sh, objs, leakObjs);
 }
 
 // /////////////////////////////////////////////////////////////////////////////
@@ -34,9 +34,23 @@
     CL_BREAK_IF("REQUIRE_GC_ACTIVITY has not been successful");                \
 } while (0)
 
+/// garbage collector, see config.h::SE_GARBAGE_COLLECTOR_KIND for details
+enum EGarbageCollectorKind {
+    GCK_BACKWARD = 0,               ///< walk back from each junk candidate
+    GCK_MARK,                       ///< mark from program variables, sweep
+    GCK_INCREMENTAL,                ///< mark only the affected region
+    GCK_LAST
+};
+
+/// name of the given garbage collector as accepted by GlConf
+const char* garbageCollectorName(EGarbageCollectorKind);
+
 /// collect and remove all junk reachable from the given object
 bool /* found */ collectJunk(SymHeap &sh, TObjId obj, TObjSet *leakObjs = 0);
 
+/// same as collectJunk() called for each of the given objects in turn
+bool collectJunkFrom(SymHeap &sh, const TObjList &objs, TObjSet *leakObjs = 0);
+
 /// same as collectJunk(), but does not consider prototypes to be junk objects
 bool collectSharedJunk(SymHeap &sh, TObjId obj, TObjSet *leakObjs = 0);
 
@@ -59,14 +73,11 @@ class LeakMonitor {
 
         template <class TCont>
         bool collectJunkFrom(const TCont &killedPtrs) {
-            bool leaking = false;
-            for (TValId val : killedPtrs) {
-                const TObjId obj = sh_.objByAddr(val);
-                if (collectJunk(sh_, obj, &leakObjs_))
-                    leaking = true;
-            }
-
-            return leaking;
+            TObjList objs;
+            for (TValId val : killedPtrs)
+                objs.push_back(sh_.objByAddr(val));
+
+            return ::collectJunkFrom(sh_, objs, &leakObjs_);
         }
 
         bool /* leaking */ destroyObject(const TObjId obj) {
@@ -26,6 +26,7 @@
 #include <cl/storage.hh>
 
 #include "intarena.hh"
+#include "mempool.hh"
 #include "symbt.hh"
 #include "syments.hh"
 #include "sympred.hh"
@@ -44,6 +45,8 @@
 #include <set>
 #include <typeinfo>
 
+#include <boost/functional/hash.hpp>
+
 template <class TCont> typename TCont::value_type::second_type&
 assignInvalidIfNotFound(
         TCont                                           &cont,
@@ -120,51 +123,74 @@ class CVarMap {
         RefCounter refCnt;
 
     private:
-        typedef std::map<CVar, TObjId>              TCont;
+        typedef PersistentMap<CVar, TObjId>         TCont;
         TCont                                       cont_;
+        size_t                                      hash_;
+
+        static size_t hashOf(const CVar &cVar) {
+            size_t seed = 0;
+            boost::hash_combine(seed, cVar.uid);
+            boost::hash_combine(seed, cVar.inst);
+            return seed;
+        }
 
     public:
+        CVarMap():
+            hash_(0)
+        {
+        }
+
         void insert(CVar cVar, TObjId val) {
             // check for mapping redefinition
             CL_BREAK_IF(hasKey(cont_, cVar));
 
             // define mapping
-            cont_[cVar] = val;
+            cont_.insert(std::make_pair(cVar, val));
+            hash_ += hashOf(cVar);
         }
 
         void remove(CVar cVar) {
             if (1 != cont_.erase(cVar))
                 CL_BREAK_IF("offset detected in CVarMap::remove()");
+            else
+                hash_ -= hashOf(cVar);
+        }
+
+        unsigned size() const {
+            return cont_.size();
+        }
+
+        /// the sum does not depend on the order of insertions and removals
+        size_t hash() const {
+            return hash_;
         }
 
         TObjId find(const CVar &cVar) {
             // regular lookup
-            TCont::iterator iter = cont_.find(cVar);
-            const bool found = (cont_.end() != iter);
+            const TCont::value_type *item = cont_.lookup(cVar);
             if (!cVar.inst) {
                 // gl variable explicitly requested
-                return (found)
-                    ? iter->second
+                return (item)
+                    ? item->second
                     : OBJ_INVALID;
             }
 
             // automatic fallback to gl variable
             CVar gl = cVar;
             gl.inst = /* global variable */ 0;
-            TCont::iterator iterGl = cont_.find(gl);
-            const bool foundGl = (cont_.end() != iterGl);
+            const TCont::value_type *itemGl = cont_.lookup(gl);
 
-            if (!found && !foundGl)
+            if (!item && !itemGl)
                 // not found anywhere
                 return OBJ_INVALID;
 
             // check for clash on uid among lc/gl variable
-            CL_BREAK_IF(found && foundGl);
+            CL_BREAK_IF(item && itemGl);
 
-            if (found)
-                return iter->second;
-            else /* if (foundGl) */
-                return iterGl->second;
+            if (item)
+                return item->second;
+            else /* if (itemGl) */
+                return itemGl->second;
         }
 };
 
@@ -377,6 +403,8 @@ AbstractHeapEntity* AbstractHeapEntity::clone() const
 }
 
 struct BlockEntity: public AbstractHeapEntity {
+    MEM_POOL_ALLOCATED(MPK_UNIFORM_BLOCK)
+
     EBlockKind                  code;
     TObjId                      obj;
     TOffset                     off;
@@ -409,6 +437,8 @@ struct BlockEntity: public AbstractHeapEntity {
 };
 
 struct FieldOfObj: public BlockEntity {
+    MEM_POOL_ALLOCATED(MPK_FIELD)
+
     TObjType                    clt;
     int                         extRefCnt;
 
@@ -425,6 +455,8 @@ struct FieldOfObj: public BlockEntity {
 };
 
 struct BaseValue: public AbstractHeapEntity {
+    MEM_POOL_ALLOCATED(MPK_VALUE)
+
     EValueTarget                    code;
     EValueOrigin                    origin;
     TValId                          valRoot;
@@ -475,6 +507,8 @@ struct AnchorValue: public ReferableValue {
 };
 
 struct RangeValue: public AnchorValue {
+    MEM_POOL_ALLOCATED(MPK_RANGE_VALUE)
+
     IR::Range                       range;
 
     RangeValue(const IR::Range &range_):
@@ -489,6 +523,8 @@ struct RangeValue: public AnchorValue {
 };
 
 struct CompValue: public BaseValue {
+    MEM_POOL_ALLOCATED(MPK_COMP_VALUE)
+
     TFldId                          compObj;
 
     // cppcheck-suppress uninitMemberVar
@@ -503,6 +539,8 @@ struct CompValue: public BaseValue {
 };
 
 struct InternalCustomValue: public ReferableValue {
+    MEM_POOL_ALLOCATED(MPK_CUSTOM_VALUE)
+
     CustomValue                     customData;
 
     InternalCustomValue(EValueTarget code_, EValueOrigin origin_):
@@ -516,6 +554,8 @@ struct InternalCustomValue: public ReferableValue {
 };
 
 struct Region: public AbstractHeapEntity {
+    MEM_POOL_ALLOCATED(MPK_REGION)
+
     EStorageClass                   code;
     CVar                            cVar;
     CallInst                        anonStackOf;
@@ -543,6 +583,8 @@ struct Region: public AbstractHeapEntity {
 };
 
 struct BaseAddress: public AnchorValue {
+    MEM_POOL_ALLOCATED(MPK_BASE_ADDR)
+
     TObjId                          obj;
     ETargetSpecifier                ts;
 
@@ -629,6 +671,8 @@ struct SymHeapCore::Private {
     CustomValueMapper              *cValueMap;
     CoincidenceDb                  *coinDb;
     NeqDb                          *neqDb;
+    PersistentSet<TObjId>           touchedObjs;
+    bool                            touchedAll;
 
     inline TFldId assignId(BlockEntity *);
     inline TValId assignId(BaseValue *);
@@ -711,11 +755,48 @@ struct SymHeapCore::Private {
             const TObjType          clt,
             IMatchPolicy           *policy);
 
+    inline void touchObj(TObjId);
+    void touchUsersOf(TValId);
+    void touchAll();
+
     private:
         // intentionally not implemented
         Private& operator=(const Private &);
 };
 
+inline void SymHeapCore::Private::touchObj(const TObjId obj)
+{
+    if (!this->touchedAll)
+        this->touchedObjs.insert(obj);
+}
+
+void SymHeapCore::Private::touchUsersOf(const TValId val)
+{
+    if (this->touchedAll || val <= 0)
+        return;
+
+    const BaseValue *valData;
+    this->ents.getEntRO(&valData, val);
+    for (const TFldId fld : valData->usedBy) {
+        const BlockEntity *blData;
+        this->ents.getEntRO(&blData, fld);
+        this->touchObj(blData->obj);
+    }
+
+    if (!isAnyDataArea(valData->code))
+        return;
+
+    const BaseAddress *rootData;
+    this->ents.getEntRO(&rootData, valData->valRoot);
+    this->touchObj(rootData->obj);
+}
+
+void SymHeapCore::Private::touchAll()
+{
+    this->touchedAll = true;
+    this->touchedObjs.clear();
+}
+
 inline TValId SymHeapCore::Private::assignId(BaseValue *valData)
 {
     const TValId val = this->ents.assignId<TValId>(valData);
@@ -754,6 +835,7 @@ bool /* wasPtr */ SymHeapCore::Private::releaseValueOf(TFldId fld, TValId val)
             CL_DEBUG("releaseValueOf() kills an orphan Neq predicate");
             RefCntLib<RCO_NON_VIRT>::requireExclusivity(this->neqDb);
             this->neqDb->del(valNeq, val);
+            this->touchUsersOf(valNeq);
         }
     }
 
@@ -769,6 +851,7 @@ bool /* wasPtr */ SymHeapCore::Private::releaseValueOf(TFldId fld, TValId val)
     // jump to region
     Region *regData;
     this->ents.getEntRW(&regData, rootData->obj);
+    this->touchObj(rootData->obj);
 
     if (1 != regData->usedByGl.erase(fld))
         CL_BREAK_IF("SymHeapCore::Private::releaseValueOf(): offset detected");
@@ -798,6 +881,7 @@ void SymHeapCore::Private::registerValueOf(TFldId fld, TValId val)
     // update usedByGl
     Region *regData;
     this->ents.getEntRW(&regData, rootData->obj);
+    this->touchObj(rootData->obj);
     regData->usedByGl.insert(fld);
 }
 
@@ -935,6 +1019,7 @@ void SymHeapCore::Private::splitBlockByObject(
     CL_BREAK_IF(obj != hbData->obj);
     Region *rootData;
     this->ents.getEntRW(&rootData, obj);
+    this->touchObj(obj);
 
     // check up to now arena consistency
     CL_BREAK_IF(!this->chkArenaConsistency(rootData, /* mayOverlap */ true));
@@ -1216,6 +1301,7 @@ void SymHeapCore::Private::reinterpretObjData(
     const TObjId obj = oldData->obj;
     Region *rootData;
     this->ents.getEntRW(&rootData, obj);
+    this->touchObj(obj);
     CL_BREAK_IF(!this->chkArenaConsistency(rootData, /* mayOverlap */ true));
 
     this->ents.getEntRW(&blData, fld);
@@ -1282,6 +1368,7 @@ void SymHeapCore::Private::setValueOf(
     const TObjId obj = fldData->obj;
     Region *rootData;
     this->ents.getEntRW(&rootData, obj);
+    this->touchObj(obj);
 
     // (re)insert self into the arena if not there
     TArena &arena = rootData->arena;
@@ -1311,6 +1398,7 @@ TFldId SymHeapCore::Private::fldCreate(
     // read object data
     Region *rootData;
     this->ents.getEntRW(&rootData, obj);
+    this->touchObj(obj);
 
     // map the region occupied by the object
     rootData->arena += createArenaItem(off, clt->size, fld);
@@ -1335,6 +1423,7 @@ void SymHeapCore::Private::fldDestroy(TFldId fld, bool removeVal, bool detach)
         // properly remove the object from grid and arena
         Region *rootData;
         this->ents.getEntRW(&rootData, blData->obj);
+        this->touchObj(blData->obj);
         CL_BREAK_IF(!this->chkArenaConsistency(rootData, /* overlap */true));
 
         // remove the object from arena unless we are destroying everything
@@ -1480,6 +1569,7 @@ void SymHeapCore::Private::transferBlock(
     Region *objDataDst;
     const TObjId objDst = rootValDataDst->obj;
     this->ents.getEntRW(&objDataDst, objDst);
+    this->touchObj(objDst);
 
     // go through overlaps and copy the live ones
     for (const TFldId objSrc : overlaps) {
@@ -1523,7 +1613,8 @@ SymHeapCore::Private::Private(Trace::Node *trace):
     cVarMap     (new CVarMap),
     cValueMap   (new CustomValueMapper),
     coinDb      (new CoincidenceDb),
-    neqDb       (new NeqDb)
+    neqDb       (new NeqDb),
+    touchedAll  (true)
 {
 }
 
@@ -1535,7 +1626,9 @@ SymHeapCore::Private::Private(const SymHeapCore::Private &ref):
     cVarMap     (ref.cVarMap),
     cValueMap   (ref.cValueMap),
     coinDb      (ref.coinDb),
-    neqDb       (ref.neqDb)
+    neqDb       (ref.neqDb),
+    touchedObjs (ref.touchedObjs),
+    touchedAll  (ref.touchedAll)
 {
     RefCntLib<RCO_NON_VIRT>::enter(this->liveObjs);
     RefCntLib<RCO_NON_VIRT>::enter(this->cVarMap);
@@ -1567,6 +1660,7 @@ TValId SymHeapCore::Private::fldInit(TFldId fld)
     const TObjId obj = fldData->obj;
     Region *rootData;
     this->ents.getEntRW(&rootData, obj);
+    this->touchObj(obj);
     CL_BREAK_IF(!this->chkArenaConsistency(rootData));
 
     const TArena &arena = rootData->arena;
@@ -1717,6 +1811,11 @@ unsigned SymHeapCore::lastId() const
     return d->ents.lastId<unsigned>();
 }
 
+void SymHeapCore::forkEntIds()
+{
+    d->ents.forkEntCounter();
+}
+
 TFldId SymHeapCore::Private::copySingleLiveBlock(
         const TObjId                objDst,
         Region                     *objDataDst,
@@ -1775,6 +1874,7 @@ TObjId SymHeapCore::objClone(TObjId obj)
     const TObjId dup = d->assignId(new Region(objDataSrc->code));
     Region *objDataDst;
     d->ents.getEntRW(&objDataDst, dup);
+    d->touchObj(dup);
 
     // duplicate root metadata
     objDataDst->cVar                = objDataSrc->cVar;
@@ -2015,6 +2115,7 @@ void SymHeapCore::setValOfField(TFldId fld, TValId val, TValSet *killedPtrs)
     // mark the destination object as live
     Region *regData;
     d->ents.getEntRW(&regData, fldData->obj);
+    d->touchObj(fldData->obj);
     regData->liveFields[fld] = bkFromClt(clt);
 
     // now set the value
@@ -2038,6 +2139,7 @@ TFldId SymHeapCore::Private::writeUniformBlock(
     // jump to region
     Region *regData;
     this->ents.getEntRW(&regData, obj);
+    this->touchObj(obj);
 
     // check up to now arena consistency
     CL_BREAK_IF(!this->chkArenaConsistency(regData));
@@ -2117,6 +2219,7 @@ void SymHeapCore::copyBlockOfRawMemory(
     // jump to region
     Region *regDataDst;
     d->ents.getEntRW(&regDataDst, rootDataDst->obj);
+    d->touchObj(rootDataDst->obj);
 
     // check up to now arena consistency
     CL_BREAK_IF(!d->chkArenaConsistency(regDataDst));
@@ -2348,6 +2451,7 @@ void SymHeapCore::Private::trimCustomValue(TValId val, const IR::Range &win)
 
     // update range of the anchor
     const TOffset off = valData->offRoot;
+    this->touchUsersOf(anchor);
     IR::Range &rngAnchor = anchorData->customData.rng();
     rngAnchor = win - IR::rngFromNum(off);
 
@@ -2360,6 +2464,7 @@ void SymHeapCore::Private::trimCustomValue(TValId val, const IR::Range &win)
     for (const TValId depVal : deps) {
         InternalCustomValue *depData;
         this->ents.getEntRW(&depData, depVal);
+        this->touchUsersOf(depVal);
 
         // update the dependent value
         IR::Range &rngDep = depData->customData.rng();
@@ -2524,6 +2629,8 @@ TValId SymHeapCore::valShift(TValId valToShift, TValId shiftBy)
     const TValId valSum = this->valByOffset(valResult, -offTotal);
     RefCntLib<RCO_NON_VIRT>::requireExclusivity(d->coinDb);
     d->coinDb->add(anchor1, anchor2, valSum);
+    d->touchUsersOf(anchor1);
+    d->touchUsersOf(anchor2);
 
     // NOTE: valResult is what the caller asks for (valSum is what we track)
     return valResult;
@@ -2564,6 +2671,9 @@ void SymHeapCore::valRestrictRange(TValId val, IR::Range win)
     d->ents.getEntRW(&rangeData, anchor);
     IR::Range &range = rangeData->range;
 
+    // the offset range is shared by all values derived from the anchor
+    d->touchAll();
+
     // translate the given window to our root coords
     win -= IR::rngFromNum(shift);
 
@@ -2612,6 +2722,8 @@ void SymHeapCore::Private::bindValues(TValId v1, TValId v2, TValId valSum)
 
     RefCntLib<RCO_NON_VIRT>::requireExclusivity(this->coinDb);
     this->coinDb->add(anchor1, anchor2, valSum);
+    this->touchUsersOf(anchor1);
+    this->touchUsersOf(anchor2);
 }
 
 TValId SymHeapCore::diffPointers(const TValId v1, const TValId v2)
@@ -2668,6 +2780,7 @@ TValId SymHeapCore::addrOfTarget(TObjId obj, ETargetSpecifier ts, TOffset off)
         // register the base address by the target object
         Region *objDataRW;
         d->ents.getEntRW(&objDataRW, obj);
+        d->touchObj(obj);
         objDataRW->addrByTS[ts] = base;
     }
     else
@@ -2734,7 +2847,9 @@ void SymHeapCore::rewriteTargetOfBase(TValId root, TObjId objNew)
     // resolve old/new object data
     Region *regDataOld, *regDataNew;
     d->ents.getEntRW(&regDataOld, objOld);
+    d->touchObj(objOld);
     d->ents.getEntRW(&regDataNew, objNew);
+    d->touchObj(objNew);
 
     // move the address from objOld to objNew
     const ETargetSpecifier ts = rootData->ts;
@@ -2754,9 +2869,11 @@ void SymHeapCore::rewriteTargetOfBase(TValId root, TObjId objNew)
         // resolve base address
         const BaseValue *valData;
         d->ents.getEntRO(&valData, val);
-        if (valData->valRoot == root)
+        if (valData->valRoot == root) {
             // reference moved
             regDataNew->usedByGl.insert(fld);
+            d->touchObj(fldData->obj);
+        }
         else
             unrelatedFlds.insert(fld);
     }
@@ -2940,6 +3057,8 @@ void SymHeapCore::addNeq(TValId v1, TValId v2)
     }
 
     d->neqDb->add(v1, v2);
+    d->touchUsersOf(v1);
+    d->touchUsersOf(v2);
 }
 
 void SymHeapCore::delNeq(TValId v1, TValId v2)
@@ -2948,6 +3067,8 @@ void SymHeapCore::delNeq(TValId v1, TValId v2)
 
     RefCntLib<RCO_NON_VIRT>::requireExclusivity(d->neqDb);
     d->neqDb->del(v1, v2);
+    d->touchUsersOf(v1);
+    d->touchUsersOf(v2);
 }
 
 void SymHeapCore::gatherRelatedValues(TValList &dst, TValId val) const
@@ -3058,6 +3179,26 @@ bool SymHeapCore::matchPreds(
     return true;
 }
 
+unsigned SymHeapCore::cntNeqs() const
+{
+    return d->neqDb->size();
+}
+
+unsigned SymHeapCore::cntCoincidences() const
+{
+    return d->coinDb->size();
+}
+
+unsigned SymHeapCore::cntProgramVars() const
+{
+    return d->cVarMap->size();
+}
+
+size_t SymHeapCore::hashOfProgramVars() const
+{
+    return d->cVarMap->hash();
+}
+
 TObjId SymHeapCore::objByField(TFldId fld) const
 {
     if (fld < 0)
@@ -3323,6 +3464,7 @@ TObjId SymHeapCore::regionByVar(CVar cv, bool createIfNeeded)
     obj = d->assignId(new Region(code));
     Region *rootData;
     d->ents.getEntRW(&rootData, obj);
+    d->touchObj(obj);
 
     // initialize metadata
     rootData->cVar = cv;
@@ -3365,6 +3507,28 @@ void SymHeapCore::gatherObjects(TObjList &dst, bool (*filter)(EStorageClass))
     }
 }
 
+bool SymHeapCore::gatherTouchedObjs(TObjSet &dst) const
+{
+    if (d->touchedAll)
+        return false;
+
+    for (const TObjId obj : d->touchedObjs)
+        dst.insert(obj);
+
+    return true;
+}
+
+void SymHeapCore::clearTouchedObjs()
+{
+    d->touchedObjs.clear();
+    d->touchedAll = false;
+}
+
+void SymHeapCore::objTouch(TObjId obj)
+{
+    d->touchObj(obj);
+}
+
 TFldId SymHeapCore::valGetComposite(TValId val) const
 {
     const BaseValue *valData;
@@ -3384,6 +3548,7 @@ TObjId SymHeapCore::stackAlloc(const TSizeRange &size, const CallInst &from)
     const TObjId reg = d->assignId(new Region(SC_ON_STACK));
     Region *rootData;
     d->ents.getEntRW(&rootData, reg);
+    d->touchObj(reg);
 
     // initialize meta-data
     rootData->anonStackOf = from;
@@ -3426,6 +3591,7 @@ TObjId SymHeapCore::heapAlloc(const TSizeRange &size)
     const TObjId reg = d->assignId(new Region(SC_ON_HEAP));
     Region *rootData;
     d->ents.getEntRW(&rootData, reg);
+    d->touchObj(reg);
 
     // mark the root as live
     RefCntLib<RCO_NON_VIRT>::requireExclusivity(d->liveObjs);
@@ -3462,6 +3628,7 @@ void SymHeapCore::objSetSize(TObjId obj, const TSizeRange &newSize)
     CL_BREAK_IF(newSize.lo < IR::Int0);
     Region *regData;
     d->ents.getEntRW(&regData, obj);
+    d->touchObj(obj);
     CL_BREAK_IF(!regData);
 
     const TSizeRange size = regData->size;
@@ -3548,6 +3715,7 @@ void SymHeapCore::objSetEstimatedType(TObjId obj, TObjType clt)
 {
     Region *rootData;
     d->ents.getEntRW(&rootData, obj);
+    d->touchObj(obj);
 
     if (OBJ_RETURN == obj) {
         // destroy any stale OBJ_RETURN object
@@ -3576,6 +3744,7 @@ void SymHeapCore::objInvalidate(TObjId obj)
     // mark the region as invalid
     Region *rootData;
     d->ents.getEntRW(&rootData, obj);
+    d->touchObj(obj);
     rootData->isValid = false;
 
     if (OBJ_RETURN == obj)
@@ -3700,6 +3869,7 @@ void SymHeapCore::objSetProtoLevel(TObjId obj, TProtoLevel level)
 
     Region *regData;
     d->ents.getEntRW(&regData, obj);
+    d->touchObj(obj);
     regData->protoLevel = level;
 }
 
@@ -3779,6 +3949,14 @@ void SymHeap::swap(SymHeapCore &baseRef)
     swapValues(this->d, ref.d);
 }
 
+void SymHeap::forkEntIds()
+{
+    SymHeapCore::forkEntIds();
+
+    RefCntLib<RCO_NON_VIRT>::requireExclusivity(d);
+    d->absRoots.forkEntCounter();
+}
+
 TObjId SymHeap::objClone(TObjId obj)
 {
     const TObjId dup = SymHeapCore::objClone(obj);
@@ -3822,6 +4000,7 @@ void SymHeap::objSetAbstract(
     CL_BREAK_IF(OK_SEE_THROUGH == kind && off.prev != off.next);
 
     RefCntLib<RCO_NON_VIRT>::requireExclusivity(d);
+    this->objTouch(obj);
 
     if (d->absRoots.isValidEnt(obj)) {
         // the object already exists, just update its properties
@@ -3843,6 +4022,7 @@ void SymHeap::objSetConcrete(TObjId obj)
 {
     CL_DEBUG("SymHeap::objSetConcrete() is taking place...");
     RefCntLib<RCO_NON_VIRT>::requireExclusivity(d);
+    this->objTouch(obj);
 
     // unregister an abstract object
     d->absRoots.releaseEnt(obj);
@@ -3884,6 +4064,7 @@ TMinLen SymHeap::segMinLength(TObjId seg) const
 void SymHeap::segSetMinLength(TObjId seg, TMinLen len)
 {
     RefCntLib<RCO_NON_VIRT>::requireExclusivity(d);
+    this->objTouch(seg);
 
     AbstractObject *aData = d->absRoots.getEntRW(seg);
 
@@ -394,6 +394,14 @@ class SymHeapCore {
         /// the last assigned ID of a heap entity (not necessarily still valid)
         unsigned lastId() const;
 
+        /**
+         * stop sharing the counter of entity IDs with the heaps this one has
+         * been cloned from, such that the IDs assigned to new entities do not
+         * depend on what is going on in the other heaps (used by the threads
+         * of SymExecEngine to keep the IDs deterministic)
+         */
+        virtual void forkEntIds();
+
     public:
         /**
          * collect all objects having the given value inside
@@ -449,6 +457,18 @@ class SymHeapCore {
                 bool                         nonZeroOnly = false)
             const;
 
+        /// return count of explicit Neq predicates, O(1)
+        unsigned cntNeqs() const;
+
+        /// return count of coincidence predicates, O(1)
+        unsigned cntCoincidences() const;
+
+        /// return count of live program variables (except OBJ_RETURN), O(1)
+        unsigned cntProgramVars() const;
+
+        /// return a hash of the set of live program variables, O(1)
+        size_t hashOfProgramVars() const;
+
     public:
         /// translate the given address by the given offset
         TValId valByOffset(TValId, TOffset offset);
@@ -523,6 +543,12 @@ class SymHeapCore {
         /// return the list of objects satisfying the given filtering predicate
         void gatherObjects(TObjList &dst, bool (*)(EStorageClass) = 0) const;
 
+        /// objects changed since the last clearTouchedObjs(), false if unknown
+        bool gatherTouchedObjs(TObjSet &dst) const;
+
+        /// start tracking the objects changed from now on
+        void clearTouchedObjs();
+
         /// list of live fields (including ptrs) inside the given object
         void gatherLiveFields(FldList &dst, TObjId) const;
 
@@ -609,6 +635,9 @@ class SymHeapCore {
         TObjType fieldType(TFldId fld) const;
         void setValOfField(TFldId fld, TValId val, TValSet *killedPtrs = 0);
 
+        /// count the object as changed, see gatherTouchedObjs()
+        void objTouch(TObjId);
+
     protected:
         TStorRef stor_;
 
@@ -882,6 +911,7 @@ class SymHeap: public SymHeapCore {
 
     public:
         // just overrides (inherits the dox)
+        virtual void forkEntIds();
         virtual void objInvalidate(TObjId);
         virtual TObjId objClone(TObjId);
 
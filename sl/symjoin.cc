@@ -23,19 +23,38 @@
 #include <cl/cl_msg.hh>
 #include <cl/cldebug.hh>
 #include <cl/clutil.hh>
+#include <cl/storage.hh>
 
 #include "glconf.hh"
 #include "prototype.hh"
+#include "scratch.hh"
 #include "shape.hh"
 #include "symcmp.hh"
+#include "symbt.hh"
 #include "symgc.hh"
 #include "symplot.hh"
+#include "symprof.hh"
 #include "symseg.hh"
 #include "symutil.hh"
 #include "symtrace.hh"
 #include "worklist.hh"
 #include "util.hh"
 
+#include <memory>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+
+/// if 1, record the operations on join contexts to symjoin-trace.txt (sl/bench)
+#define SJ_RECORD_TRACE                     0
+
+#if SJ_RECORD_TRACE
+#   include <atomic>
+#   include <fstream>
+#   include <mutex>
+#   include <sstream>
+#endif
+
 static bool debuggingSymJoin = static_cast<bool>(DEBUG_SYMJOIN);
 
 #define SJ_DEBUG(msg) do {                                                  \
@@ -99,22 +118,151 @@ struct SchedItem {
     }
 };
 
-// needed by std::set
-inline bool operator<(const SchedItem &a, const SchedItem &b)
+// needed by ScratchHashSet, fldDst is intentionally ignored
+inline bool operator==(const SchedItem &a, const SchedItem &b)
 {
-    RETURN_IF_COMPARED(a, b, fld1);
-    RETURN_IF_COMPARED(a, b, fld2);
-    return (a.ldiff < b.ldiff);
+    return (a.fld1 == b.fld1)
+        && (a.fld2 == b.fld2)
+        && (a.ldiff == b.ldiff);
 }
 
+// needed by ScratchHashSet
+struct SchedItemHash {
+    size_t operator()(const SchedItem &item) const {
+        using boost::hash_combine;
+        size_t seed = 0;
+        hash_combine(seed, item.fld1.fieldId());
+        hash_combine(seed, item.fld2.fieldId());
+        hash_combine(seed, item.ldiff);
+        return seed;
+    }
+};
+
 typedef std::pair<FldHandle /* dst */, FldHandle /* gt */>      TCloneItem;
 typedef WorkList<TCloneItem>                                    TCloneWorkList;
 
-typedef WorkList<SchedItem>                                     TWorkList;
+typedef ScratchWorkList<SchedItem, SchedItemHash>               TSchedList;
 
 typedef TObjMap                                                 TObjMapBidir[2];
 
-typedef std::map<TValPair /* (v1, v2) */, TValId /* dst */>     TJoinCache;
+typedef ScratchHashMap<TValPair /* (v1, v2) */, TValId /* dst */,
+                       boost::hash<TValPair> >                  TValPairMap;
+
+#if SJ_RECORD_TRACE
+/// append a line to symjoin-trace.txt, safe to be called from any thread
+void sjRecordLine(const std::string &line)
+{
+    static std::mutex lock;
+    static std::ofstream str("symjoin-trace.txt");
+
+    std::lock_guard<std::mutex> guard(lock);
+    str << line << '\n';
+}
+
+long sjNextTraceId()
+{
+    static std::atomic<long> last(0L);
+    return ++last;
+}
+
+#   define SJ_RECORD(what) do {                                             \
+        std::ostringstream str;                                             \
+        str << what;                                                        \
+        sjRecordLine(str.str());                                            \
+    } while (0)
+
+/// TSchedList that records all operations on it
+struct TWorkList: public TSchedList {
+    long traceId;
+
+    bool schedule(const SchedItem &item) {
+        SJ_RECORD("s " << traceId
+                << " " << item.fldDst.fieldId()
+                << " " << item.fld1.fieldId()
+                << " " << item.fld2.fieldId()
+                << " " << item.ldiff);
+        return TSchedList::schedule(item);
+    }
+
+    bool next(SchedItem &dst) {
+        SJ_RECORD("n " << traceId);
+        return TSchedList::next(dst);
+    }
+};
+
+/// TValPairMap that records all operations on it
+struct TJoinCache: public TValPairMap {
+    long traceId;
+
+    TValId& operator[](const TValPair &vp) {
+        SJ_RECORD("c " << traceId << " " << vp.first << " " << vp.second);
+        return TValPairMap::operator[](vp);
+    }
+
+    const_iterator find(const TValPair &vp) const {
+        SJ_RECORD("l " << traceId << " " << vp.first << " " << vp.second);
+        return TValPairMap::find(vp);
+    }
+};
+#else
+#   define SJ_RECORD(what) do { } while (0)
+
+typedef TSchedList                                              TWorkList;
+typedef TValPairMap                                             TJoinCache;
+#endif
+
+/// containers of SymJoinCtx reused by all joins running in a thread
+struct JoinScratch {
+    TWorkList                   wl;
+    TJoinCache                  joinCache;
+};
+
+/// lend a cleared JoinScratch of the current thread to a single SymJoinCtx
+class JoinScratchLease {
+    private:
+        typedef std::vector<std::unique_ptr<JoinScratch> > TPool;
+
+        // nested joins (such as joinData() on behalf of joinSymHeaps()) take
+        // one object each, the objects are released as the thread exits
+        static thread_local TPool               pool_;
+
+        std::unique_ptr<JoinScratch>            scratch_;
+
+        // copying NOT allowed
+        JoinScratchLease(const JoinScratchLease &);
+        JoinScratchLease& operator=(const JoinScratchLease &);
+
+    public:
+        JoinScratchLease() {
+            if (pool_.empty())
+                scratch_.reset(new JoinScratch);
+            else {
+                scratch_ = std::move(pool_.back());
+                pool_.pop_back();
+            }
+#if SJ_RECORD_TRACE
+            const long traceId = sjNextTraceId();
+            scratch_->wl.traceId = traceId;
+            scratch_->joinCache.traceId = traceId;
+            SJ_RECORD("b " << traceId);
+#endif
+        }
+
+        ~JoinScratchLease() {
+            SJ_RECORD("e " << scratch_->wl.traceId);
+
+            // release the field handles, but keep the memory for the next join
+            scratch_->wl.clear();
+            scratch_->joinCache.clear();
+            pool_.push_back(std::move(scratch_));
+        }
+
+        JoinScratch* operator->() const {
+            return scratch_.get();
+        }
+};
+
+thread_local JoinScratchLease::TPool JoinScratchLease::pool_;
 
 /// current state, common for joinSymHeaps() and joinData()
 struct SymJoinCtx {
@@ -131,14 +279,15 @@ struct SymJoinCtx {
     TObjMapBidir                objMap1;
     TObjMapBidir                objMap2;
 
-    TWorkList                   wl;
+    JoinScratchLease            scratch;
+    TWorkList                  &wl;
     EJoinStatus                 status;
     bool                        forceThreeWay;
     bool                        allowThreeWay;
 
     std::set<TObjId /* dst */>  protos;
 
-    TJoinCache                  joinCache;
+    TJoinCache                 &joinCache;
 
     void initValMaps() {
         // VAL_NULL should be always mapped to VAL_NULL
@@ -164,9 +313,11 @@ struct SymJoinCtx {
         sh2(sh2_),
         l1Drift(0),
         l2Drift(0),
+        wl(scratch->wl),
         status(JS_USE_ANY),
         forceThreeWay(false),
-        allowThreeWay((1 < GlConf::data.allowThreeWayJoin) && allowThreeWay_)
+        allowThreeWay((1 < GlConf::data.allowThreeWayJoin) && allowThreeWay_),
+        joinCache(scratch->joinCache)
     {
         initValMaps();
     }
@@ -178,9 +329,11 @@ struct SymJoinCtx {
         sh2(sh_),
         l1Drift(l1Drift_),
         l2Drift(l2Drift_),
+        wl(scratch->wl),
         status(JS_USE_ANY),
         forceThreeWay(false),
-        allowThreeWay(0 < GlConf::data.allowThreeWayJoin)
+        allowThreeWay(0 < GlConf::data.allowThreeWayJoin),
+        joinCache(scratch->joinCache)
     {
         initValMaps();
     }
@@ -838,12 +991,11 @@ bool ObjMatchVisitor::operator()(const FldHandle item[2])
     return checkValueMapping(ctx, v1, v2);
 }
 
-// FIXME: suboptimal implementation
-bool isScheduled(TWorkList wl, const TObjId obj)
+bool isScheduled(const TWorkList &wl, const TObjId obj)
 {
-    SchedItem item;
-    while (wl.next(item)) {
-        const FldHandle &fldDst = item.fldDst;
+    const unsigned cnt = wl.cntTodo();
+    for (unsigned nth = 0U; nth < cnt; ++nth) {
+        const FldHandle &fldDst = wl.todo(nth).fldDst;
         if (fldDst.obj() == obj)
             return true;
     }
@@ -2539,6 +2691,12 @@ void initTrace(SymJoinCtx &ctx)
         return;
     }
 
+    if (GlConf::data.traceFree) {
+        // no need to export the ID mapping in the trace-free mode
+        Trace::collapse(ctx.dst);
+        return;
+    }
+
     Trace::Node *const tr = new Trace::JoinNode(tr1, tr2, ctx.status);
 
     // export the captured ID mapping
@@ -2550,6 +2708,38 @@ void initTrace(SymJoinCtx &ctx)
     ctx.dst.traceUpdate(tr);
 }
 
+THeapFingerprint joinFingerprint(const SymHeap &sh)
+{
+    using boost::hash_combine;
+    size_t seed = 0;
+
+    // joinSymHeaps() fails immediately if the exit points are not equal
+    const SymBackTrace *bt = sh.exitPoint();
+    hash_combine(seed, !!bt);
+    if (bt && bt->size()) {
+        hash_combine(seed, bt->size());
+        hash_combine(seed, uidOf(*bt->topFnc()));
+    }
+
+    // asymmetric join of gl variables is refused by traverseProgramVars...()
+    TObjList vars;
+    sh.gatherObjects(vars, isProgramVar);
+    TCVarSet glVars;
+    for (const TObjId obj : vars) {
+        if (OBJ_RETURN == obj || sh.isAnonStackObj(obj))
+            continue;
+
+        const CVar cv = sh.cVarByObject(obj);
+        if (!cv.inst)
+            glVars.insert(cv);
+    }
+
+    for (const CVar &cv : glVars)
+        hash_combine(seed, cv.uid);
+
+    return (seed) ? seed : 1U;
+}
+
 bool joinSymHeaps(
         EJoinStatus             *pStatus,
         SymHeap                 *pDst,
@@ -2557,6 +2747,8 @@ bool joinSymHeaps(
         SymHeap                  sh2,
         const bool               allowThreeWay)
 {
+    ProfScope prof(PP_JOIN_SYM_HEAPS);
+
     SJ_DEBUG("--> joinSymHeaps()");
     TStorRef stor = sh1.stor();
     CL_BREAK_IF(&stor != &sh2.stor());
@@ -26,6 +26,7 @@
  */
 
 #include "join_status.hh"
+#include "symcmp.hh"                // for THeapFingerprint
 #include "symheap.hh"
 #include "symtrace.hh"              // for Trace::TIdMapper
 
@@ -50,6 +51,16 @@ bool joinSymHeaps(
         SymHeap                  sh2,
         bool                     allowThreeWay = true);
 
+/**
+ * compute a key of the given symbolic heap such that joinSymHeaps() is
+ * guaranteed to fail on any two heaps with distinct keys
+ *
+ * The key covers the exit point and the set of global variables, which
+ * joinSymHeaps() never recovers asymmetrically (unlike local variables).  It
+ * never returns zero, which can thus be used to denote "not computed yet".
+ */
+THeapFingerprint joinFingerprint(const SymHeap &sh);
+
 /// enable/disable debugging of symjoin
 void debugSymJoin(bool enable);
 
@@ -24,7 +24,9 @@
 #include <cl/clutil.hh>
 #include <cl/storage.hh>
 
+#include "glconf.hh"
 #include "plotenum.hh"
+#include "plotwriter.hh"
 #include "symheap.hh"
 #include "sympred.hh"
 #include "symseg.hh"
@@ -32,10 +34,10 @@
 #include "worklist.hh"
 
 #include <cctype>
-#include <fstream>
 #include <iomanip>
 #include <map>
 #include <set>
+#include <sstream>
 #include <string>
 
 // /////////////////////////////////////////////////////////////////////////////
@@ -1295,31 +1297,24 @@ bool plotHeapCore(
         // propagate the resulting name back to the caller
         *pName = plotName;
 
-    // create a dot file
-    std::fstream out(fileName.c_str(), std::ios::out);
-    if (!out) {
-        CL_ERROR("unable to create file '" << fileName << "'");
-        return false;
-    }
-
-    // open graph
-    out << "digraph " << SL_QUOTE(plotName)
-        << " {\n\tlabel=<<FONT POINT-SIZE=\"18\">" << plotName
+    // open graph, the head carries the name given by the caller rather than
+    // the unique one, so that plots of the same heap can be stored only once
+    std::ostringstream head;
+    head << "digraph " << SL_QUOTE(name)
+        << " {\n\tlabel=<<FONT POINT-SIZE=\"18\">" << name
         << "</FONT>>;\n\tclusterrank=local;\n\tlabelloc=t;\n";
 
-    // check whether we can write to stream
-    if (!out.flush()) {
-        CL_ERROR("unable to write file '" << fileName << "'");
-        out.close();
-        return false;
-    }
-
-    if (loc)
+    const std::string &archive = GlConf::data.plotArchive;
+    if (loc && archive.empty())
         CL_NOTE_MSG(loc, "writing heap graph to '" << fileName << "'...");
+    else if (loc)
+        CL_NOTE_MSG(loc, "writing heap graph '" << fileName
+                << "' to '" << archive << "'...");
     else
         CL_DEBUG("writing heap graph to '" << fileName << "'...");
 
-    // initialize an instance of PlotData
+    // render the graph to memory
+    std::ostringstream out;
     PlotData plot(sh, out, objs, vals, pHighlight);
 
     // do our stuff
@@ -1327,9 +1322,10 @@ bool plotHeapCore(
 
     // close graph
     out << "}\n";
-    const bool ok = !!out;
-    out.close();
-    return ok;
+
+    // let PlotWriter write it to the disk in the background
+    PlotWriter::write(fileName, head.str(), out.str());
+    return true;
 }
 
 // /////////////////////////////////////////////////////////////////////////////
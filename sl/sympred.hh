@@ -21,17 +21,15 @@
 #define H_GUARD_SYM_PRED_H
 
 #include "config.h"
+#include "persistent.hh"
 #include "util.hh"
 
-#include <map>
-#include <set>
-
-/// a symmetric relation
+/// a symmetric relation, copies of which share their unchanged parts
 template <class TKey, bool IREFLEXIVE>
 class SymPairSet {
     protected:
         typedef std::pair<TKey /* lt */, TKey /* gt */>     TItem;
-        typedef std::set<TItem>                             TCont;
+        typedef PersistentSet<TItem>                        TCont;
         TCont cont_;
 
     public:
@@ -39,6 +37,10 @@ class SymPairSet {
             return cont_.empty();
         }
 
+        size_t size() const {
+            return cont_.size();
+        }
+
         bool chk(TKey k1, TKey k2) const {
             sortValues(k1, k2);
             const TItem item(k1, k2);
@@ -50,7 +52,7 @@ class SymPairSet {
 
             sortValues(k1, k2);
             const TItem item(k1, k2);
-            return cont_.insert(item)./* inserted */second;
+            return cont_.insert(item);
         }
 
         bool del(TKey k1, TKey k2) {
@@ -62,11 +64,12 @@ class SymPairSet {
         }
 };
 
+/// a symmetric map, copies of which share their unchanged parts
 template <class TKey, class TVal>
 class SymPairMap {
     protected:
         typedef std::pair<TKey /* lt */, TKey /* gt */>     TItem;
-        typedef std::map<TItem, TVal>                       TMap;
+        typedef PersistentMap<TItem, TVal>                  TMap;
         TMap db_;
 
     public:
@@ -80,24 +83,27 @@ class SymPairMap {
         /// return STL-like iterator to go through the container
         const_iterator end()   const { return db_.end();   }
 
+        /// return count of pairs stored in the container
+        size_t size() const { return db_.size(); }
+
     public:
         void add(TKey k1, TKey k2, TVal val) {
             sortValues(k1, k2);
             const TItem key(k1, k2);
 
             CL_BREAK_IF(hasKey(db_, key));
-            db_[key] = val;
+            db_.insert(std::make_pair(key, val));
         }
 
         bool chk(TVal *pDst, TKey k1, TKey k2) const {
             sortValues(k1, k2);
             const TItem key(k1, k2);
 
-            typename TMap::const_iterator it = db_.find(key);
-            if (db_.end() == it)
+            const typename TMap::value_type *item = db_.lookup(key);
+            if (!item)
                 return false;
 
-            *pDst = it->second;
+            *pDst = item->second;
             return true;
         }
 };
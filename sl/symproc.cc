@@ -60,13 +60,21 @@
 // SymProc implementation
 void SymProc::printBackTrace(EMsgLevel level, bool forcePtrace)
 {
+    const bool printTrace = forcePtrace || !GlConf::data.errorRecoveryMode;
+    if (GlConf::data.traceFree && (printTrace || SE_DUMP_TRACE_GRAPHS))
+        // the trace is not available, the caller is going to run us again
+        throw Trace::TraceRequiredException();
+
+    // the trace graph is shared by all threads of SymExecEngine
+    Trace::GraphLock lock;
+
     // update trace graph
     Trace::MsgNode *trMsg = new Trace::MsgNode(sh_.traceNode(), level, lw_);
     sh_.traceUpdate(trMsg);
     CL_BREAK_IF(!chkTraceGraphConsistency(trMsg));
 
     // print the backtrace (or full trace if error recovery is disabled)
-    if (forcePtrace || !GlConf::data.errorRecoveryMode) {
+    if (printTrace) {
         Trace::printTrace(trMsg);
         printMemUsage("Trace::printTrace");
     }
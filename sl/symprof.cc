@@ -0,0 +1,316 @@
+/*
+ * Copyright (C) 2026 Kamil Dudka <kdudka@redhat.com>
+ *
+ * This file is part of predator.
+ *
+ * predator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * predator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with predator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include "symprof.hh"
+
+#include <cl/cl_msg.hh>
+#include <cl/storage.hh>
+
+#include "mempool.hh"
+
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+static const char *phaseNames[PP_TOTAL] = {
+    "execFnc",
+    "run",
+    "getCallCtx",
+    "joinSymHeaps",
+    "areEqual",
+    "abstractIfNeeded",
+    "discoverBestAbstraction",
+    "collectJunk"
+};
+
+namespace Profiler {
+
+bool enabled;
+
+/// a node of the call tree, identified by its path from the root
+struct Node {
+    EProfPhase                  phase;
+    int                         uid;        ///< fnc uid, -1 if not per fnc
+    std::string                 label;
+    Node                       *parent;
+    std::vector<Node *>         children;
+
+    unsigned long               calls;
+    long long                   inclNs;     ///< time including children
+    long long                   childNs;    ///< time spent in children
+    unsigned long               allocs;     ///< allocs including children
+    unsigned long               childAllocs;///< allocs done in children
+
+    Node(EProfPhase phase_, int uid_, const std::string &label_, Node *par):
+        phase(phase_),
+        uid(uid_),
+        label(label_),
+        parent(par),
+        calls(0UL),
+        inclNs(0LL),
+        childNs(0LL),
+        allocs(0UL),
+        childAllocs(0UL)
+    {
+    }
+
+    ~Node() {
+        for (Node *child : children)
+            delete child;
+    }
+
+    Node* findChild(EProfPhase phase, int uid) const {
+        for (Node *child : children)
+            if (child->phase == phase && child->uid == uid)
+                return child;
+
+        return 0;
+    }
+
+    Node* addChild(EProfPhase phase, int uid, const std::string &label) {
+        Node *child = new Node(phase, uid, label, this);
+        children.push_back(child);
+        return child;
+    }
+};
+
+/// call tree of a single thread
+struct ThreadTree {
+    Node                        root;
+    Node                       *cursor;
+
+    ThreadTree():
+        root(PP_TOTAL, -1, "", 0),
+        cursor(&root)
+    {
+    }
+};
+
+// shared among all threads
+static struct {
+    std::mutex                                  lock;
+    std::vector<std::unique_ptr<ThreadTree>>    trees;
+    std::atomic<unsigned>                       gen{1U};
+    std::string                                 fileName;
+} gl;
+
+// call tree of the current thread, dropped when gen does not match gl.gen
+static thread_local struct {
+    unsigned                    gen;
+    ThreadTree                 *tree;
+} tc;
+
+static ThreadTree* threadTree()
+{
+    const unsigned gen = gl.gen.load(std::memory_order_relaxed);
+    if (tc.gen == gen)
+        return tc.tree;
+
+    // first use by this thread since the last dump
+    ThreadTree *tree = new ThreadTree;
+    {
+        std::lock_guard<std::mutex> lock(gl.lock);
+        gl.trees.emplace_back(tree);
+    }
+
+    tc.gen = gen;
+    tc.tree = tree;
+    return tree;
+}
+
+void enable(const std::string &fileName)
+{
+    gl.fileName = fileName;
+    enabled = true;
+}
+
+// merge the subtree rooted at src into the children of dst
+static void mergeTree(Node *dst, const Node *src)
+{
+    for (const Node *child : src->children) {
+        Node *tgt = dst->findChild(child->phase, child->uid);
+        if (!tgt)
+            tgt = dst->addChild(child->phase, child->uid, child->label);
+
+        tgt->calls          += child->calls;
+        tgt->inclNs         += child->inclNs;
+        tgt->childNs        += child->childNs;
+        tgt->allocs         += child->allocs;
+        tgt->childAllocs    += child->childAllocs;
+        mergeTree(tgt, child);
+    }
+}
+
+static inline double toMs(const long long ns)
+{
+    return ns / 1e6;
+}
+
+static void writeCsv(std::ostream &str, const Node *node, std::string path)
+{
+    if (node->parent) {
+        if (!path.empty())
+            path += "/";
+
+        path += node->label;
+        str << path
+            << "," << node->calls
+            << "," << toMs(node->inclNs)
+            << "," << toMs(node->inclNs - node->childNs)
+            << "," << node->allocs
+            << "," << (node->allocs - node->childAllocs)
+            << "\n";
+    }
+
+    for (const Node *child : node->children)
+        writeCsv(str, child, path);
+}
+
+static void writeJson(std::ostream &str, const Node *node, int level)
+{
+    const std::string indent(2 * level, ' ');
+    str << indent << "{ \"name\": \"" << node->label << "\""
+        << ", \"calls\": " << node->calls
+        << ", \"incl_ms\": " << toMs(node->inclNs)
+        << ", \"excl_ms\": " << toMs(node->inclNs - node->childNs)
+        << ", \"allocs\": " << node->allocs
+        << ", \"excl_allocs\": " << (node->allocs - node->childAllocs)
+        << ", \"children\": [";
+
+    const char *sep = "\n";
+    for (const Node *child : node->children) {
+        str << sep;
+        writeJson(str, child, level + 1);
+        sep = ",\n";
+    }
+
+    if (node->children.empty())
+        str << "] }";
+    else
+        str << "\n" << indent << "] }";
+}
+
+bool dump()
+{
+    if (!enabled)
+        return true;
+
+    enabled = false;
+
+    // merge the call trees of all threads into a single one
+    Node root(PP_TOTAL, -1, "", 0);
+    {
+        std::lock_guard<std::mutex> lock(gl.lock);
+        for (const std::unique_ptr<ThreadTree> &tree : gl.trees)
+            mergeTree(&root, &tree->root);
+
+        gl.trees.clear();
+    }
+
+    // make all threads start a new call tree on the next use
+    gl.gen.fetch_add(1U, std::memory_order_relaxed);
+
+    const std::string &fileName = gl.fileName;
+    std::fstream str(fileName.c_str(), std::ios::out);
+    if (!str) {
+        CL_ERROR("unable to create file '" << fileName << "'");
+        return false;
+    }
+
+    str << std::fixed << std::setprecision(3);
+
+    const std::string csvSuffix = ".csv";
+    const size_t len = fileName.size();
+    if (csvSuffix.size() < len
+            && !fileName.compare(len - csvSuffix.size(), std::string::npos,
+                csvSuffix))
+    {
+        str << "path,calls,incl_ms,excl_ms,allocs,excl_allocs\n";
+        writeCsv(str, &root, "");
+    }
+    else {
+        str << "{ \"profile\": [";
+        const char *sep = "\n";
+        for (const Node *child : root.children) {
+            str << sep;
+            writeJson(str, child, 1);
+            sep = ",\n";
+        }
+        str << "\n] }\n";
+    }
+
+    str.close();
+    if (!str) {
+        CL_ERROR("error while writing '" << fileName << "'");
+        return false;
+    }
+
+    CL_DEBUG("Profiler: profile written to '" << fileName << "'");
+    return true;
+}
+
+} // namespace Profiler
+
+void ProfScope::enter(const EProfPhase phase, const CodeStorage::Fnc *fnc)
+{
+    using namespace Profiler;
+    ThreadTree *tree = threadTree();
+
+    Node *cursor = tree->cursor;
+    const int uid = (fnc) ? uidOf(*fnc) : -1;
+    node_ = cursor->findChild(phase, uid);
+    if (!node_) {
+        // the label is built only once per node of the call tree
+        std::string label = phaseNames[phase];
+        if (fnc)
+            label = label + "(" + nameOf(*fnc) + ")";
+
+        node_ = cursor->addChild(phase, uid, label);
+    }
+
+    tree->cursor = node_;
+
+    allocs_ = MemPool::threadAllocCount();
+    start_ = std::chrono::steady_clock::now();
+}
+
+void ProfScope::leave()
+{
+    using namespace Profiler;
+    const TTime end = std::chrono::steady_clock::now();
+    const long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>
+        (end - start_).count();
+    const unsigned long allocs = MemPool::threadAllocCount() - allocs_;
+
+    Node *node = node_;
+    node->calls     += 1UL;
+    node->inclNs    += ns;
+    node->allocs    += allocs;
+
+    Node *parent = node->parent;
+    parent->childNs      += ns;
+    parent->childAllocs  += allocs;
+
+    CL_BREAK_IF(tc.tree->cursor != node);
+    tc.tree->cursor = parent;
+}
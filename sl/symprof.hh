@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2026 Kamil Dudka <kdudka@redhat.com>
+ *
+ * This file is part of predator.
+ *
+ * predator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * predator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with predator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H_GUARD_SYM_PROF_H
+#define H_GUARD_SYM_PROF_H
+
+/**
+ * @file symprof.hh
+ * ProfScope - hierarchical profiler of the phases of symbolic execution
+ */
+
+#include <chrono>
+#include <string>
+
+namespace CodeStorage {
+    struct Fnc;
+}
+
+/// phases of symbolic execution measured by ProfScope
+enum EProfPhase {
+    PP_EXEC_FNC,                    ///< SymExec::execFnc()
+    PP_RUN_FNC,                     ///< SymExecEngine::run() of a function
+    PP_GET_CALL_CTX,                ///< SymCallCache::getCallCtx()
+    PP_JOIN_SYM_HEAPS,              ///< joinSymHeaps()
+    PP_ARE_EQUAL,                   ///< areEqual()
+    PP_ABSTRACT_IF_NEEDED,          ///< abstractIfNeeded()
+    PP_DISCOVER_BEST_ABSTRACTION,   ///< discoverBestAbstraction()
+    PP_COLLECT_JUNK,                ///< collectJunk()
+    PP_TOTAL
+};
+
+namespace Profiler {
+
+struct Node;
+
+/// true if the profiler has been enabled by enable()
+extern bool enabled;
+
+/**
+ * enable the profiler and set the name of the file to write the profile to
+ * @param fileName ending with @b .csv selects CSV, anything else selects JSON
+ * @note has to be called before symbolic execution starts
+ */
+void enable(const std::string &fileName);
+
+/**
+ * write the profile collected so far by all threads to the file given to
+ * enable() and reset the profiler to the disabled state
+ * @attention no ProfScope object may exist in any thread at that point
+ * @return true if the profile has been written successfully
+ */
+bool dump();
+
+} // namespace Profiler
+
+/**
+ * measure the time spent in the enclosing scope and the count of objects
+ * allocated by MemPool in the meanwhile, accounted to the chain of ProfScope
+ * objects of the current thread (the call path).  If the profiler is disabled,
+ * the cost is a single test of Profiler::enabled.
+ * @note scopes entered by the worker threads of the @b threads option start at
+ * the top level of the profile, independently of the scopes of the main thread
+ */
+class ProfScope {
+    public:
+        /// @param fnc if not null, the scope is accounted separately per fnc
+        ProfScope(const EProfPhase phase, const CodeStorage::Fnc *fnc = 0):
+            node_(0)
+        {
+            if (Profiler::enabled)
+                this->enter(phase, fnc);
+        }
+
+        ~ProfScope() {
+            if (node_)
+                this->leave();
+        }
+
+    private:
+        // copying NOT allowed
+        ProfScope(const ProfScope &);
+        ProfScope& operator=(const ProfScope &);
+
+        void enter(EProfPhase, const CodeStorage::Fnc *);
+        void leave();
+
+    private:
+        typedef std::chrono::steady_clock::time_point TTime;
+
+        Profiler::Node             *node_;
+        TTime                       start_;
+        unsigned long               allocs_;
+};
+
+#endif /* H_GUARD_SYM_PROF_H */
@@ -33,18 +33,65 @@
 #include "worklist.hh"
 
 #include <algorithm>            // for std::copy_if
+#include <deque>
 #include <iomanip>
 #include <map>
-
-#if !SE_BLOCK_SCHEDULER_KIND
-#   include <queue>
-#endif
+#include <set>
+#include <tuple>
 
 // set to 'true' if you wonder why SymState matches states as it does (noisy)
 static bool debugSymState = static_cast<bool>(DEBUG_SYMSTATE);
 
 static int cntLookups = -1;
 
+// statistics of the fingerprint-based filtering in SymHeapUnion::lookup()
+static struct {
+    unsigned long   hits;           ///< lookups that found an equal heap
+    unsigned long   collisions;     ///< fingerprint matches (areEqual() calls)
+    unsigned long   falsePositives; ///< fingerprint matches refused by areEqual()
+    unsigned long   skipped;        ///< areEqual() calls avoided
+} fpStats;
+
+// statistics of BlockScheduler and joins to compare the scheduling policies
+static struct {
+    unsigned long   visits;         ///< blocks taken by getNext()
+    unsigned long   reschedules;    ///< blocks scheduled while still waiting
+    unsigned long   maxWaiting;     ///< maximal count of waiting blocks
+    unsigned long   joinCalls;      ///< calls of joinSymHeaps() in SymState
+    unsigned long   joinHits;       ///< successful calls of joinSymHeaps()
+    unsigned long   joinSkipped;    ///< calls avoided due to join key mismatch
+    unsigned long   heapsStored;    ///< heaps added to states of basic blocks
+    unsigned long   maxBlockState;  ///< maximal count of heaps in a block state
+} schedStats;
+
+/// a heap not stored in any SymState, remembered by the join cache
+struct InternedHeap {
+    THeapIdent                      ident;
+    SymHeap                         sh;
+};
+
+typedef std::tuple<THeapIdent, THeapIdent, bool>            TJoinCacheKey;
+typedef std::map<THeapFingerprint, std::deque<InternedHeap>> TInternMap;
+
+// failed joins remembered by joinSymHeapsCached(), dropped in the FIFO order
+static struct {
+    THeapIdent                      lastIdent;
+    std::set<TJoinCacheKey>         failed;
+    std::deque<TJoinCacheKey>       failedQueue;
+    TInternMap                      interned;
+    std::deque<THeapFingerprint>    internedQueue;
+
+    /// join keys of heaps without identity that a join has failed with
+    std::set<THeapFingerprint>      failedKeys;
+    std::deque<THeapFingerprint>    failedKeysQueue;
+
+    unsigned long                   lookups;    ///< calls of joinSymHeapsCached()
+    unsigned long                   hits;       ///< joins known to fail
+    unsigned long                   failures;   ///< failed joins remembered
+    unsigned long                   evictions;  ///< failed joins forgotten
+    unsigned long                   internings; ///< heaps given an identity
+} joinCache;
+
 namespace {
     void debugPlot(const char *name, int idx, const SymHeap &sh) {
 #if DEBUG_SYMJOIN
@@ -70,6 +117,7 @@ void SymState::clear()
         delete sh;
 
     heaps_.clear();
+    keys_.clear();
 }
 
 SymState::~SymState()
@@ -86,6 +134,9 @@ SymState& SymState::operator=(const SymState &ref)
     for (const SymHeap *sh : ref.heaps_)
         heaps_.push_back(new SymHeap(*sh));
 
+    // fingerprints and join keys are preserved by cloning
+    keys_ = ref.keys_;
+
     return *this;
 }
 
@@ -104,6 +155,7 @@ void SymState::insertNew(const SymHeap &sh)
 
     // append the pointer to our container
     heaps_.push_back(dup);
+    keys_.push_back(HeapKeys());
 }
 
 bool SymState::insert(const SymHeap &sh, bool /* allowThreeWay */ )
@@ -121,6 +173,45 @@ void SymState::rotateExisting(const int idxA, const int idxB)
     TList::iterator itA = heaps_.begin() + idxA;
     TList::iterator itB = heaps_.begin() + idxB;
     rotate(itA, itB, heaps_.end());
+
+    TKeys::iterator keyA = keys_.begin() + idxA;
+    TKeys::iterator keyB = keys_.begin() + idxB;
+    rotate(keyA, keyB, keys_.end());
+}
+
+void SymState::moveAllFrom(SymState &src)
+{
+    heaps_.insert(heaps_.end(), src.heaps_.begin(), src.heaps_.end());
+    keys_.insert(keys_.end(), src.keys_.begin(), src.keys_.end());
+    src.heaps_.clear();
+    src.keys_.clear();
+}
+
+THeapFingerprint SymState::fingerprintOf(const int nth) const
+{
+    THeapFingerprint &fp = keys_.at(nth).fprint;
+    if (!fp)
+        fp = heapFingerprint(*heaps_[nth]);
+
+    return fp;
+}
+
+THeapFingerprint SymState::joinKeyOf(const int nth) const
+{
+    THeapFingerprint &key = keys_.at(nth).joinKey;
+    if (!key)
+        key = joinFingerprint(*heaps_[nth]);
+
+    return key;
+}
+
+THeapIdent SymState::identOf(const int nth) const
+{
+    THeapIdent &ident = keys_.at(nth).ident;
+    if (!ident)
+        ident = ++::joinCache.lastIdent;
+
+    return ident;
 }
 
 void SymState::updateTraceOf(const int idx, Trace::Node *tr, EJoinStatus status)
@@ -130,6 +221,12 @@ void SymState::updateTraceOf(const int idx, Trace::Node *tr, EJoinStatus status)
         // we are alreade up2date
         return;
 
+    if (GlConf::data.traceFree) {
+        // no need to keep the trace of the join in the trace-free mode
+        Trace::collapse(*heaps_[idx]);
+        return;
+    }
+
     int i0 = 0;
     int i1 = 1;
 
@@ -176,28 +273,187 @@ int SymHeapUnion::lookup(const SymHeap &lookFor) const
     ++::cntLookups;
     debugPlot("lookup", 0, lookFor);
 
+    const THeapFingerprint fp = heapFingerprint(lookFor);
+
     for(int idx = 0; idx < cnt; ++idx) {
         const int nth = idx + 1;
 
+        if (fp != this->fingerprintOf(idx)) {
+            // fingerprint mismatch --> the heaps cannot be equal
+            ++::fpStats.skipped;
+            continue;
+        }
+
         const SymHeap &sh = this->operator[](idx);
         debugPlot("lookup", nth, sh);
 
+        ++::fpStats.collisions;
         if (areEqual(lookFor, sh)) {
             CL_DEBUG("<I> sh #" << idx << " is equal to the given one, "
                     << cnt << " heaps in total");
 
+            ++::fpStats.hits;
+
             if (1 < GlConf::data.stateLiveOrdering)
                 // put the matched heap at beginning of the list [optimization]
                 const_cast<SymHeapUnion *>(this)->rotateExisting(0U, idx);
 
             return idx;
         }
+
+        ++::fpStats.falsePositives;
     }
 
     // not found
     return -1;
 }
 
+// the statistics are printed as notes if print_stats is enabled
+#define SE_PRINT_STATS(what) do {   \
+    if (GlConf::data.printStats)    \
+        CL_NOTE(what);              \
+    else                            \
+        CL_DEBUG(what);             \
+} while (0)
+
+void printSymStateStats()
+{
+    SE_PRINT_STATS("SymHeapUnion::lookup() statistics: "
+            << ::fpStats.hits << " hit(s), "
+            << ::fpStats.collisions << " fingerprint collision(s), "
+            << ::fpStats.falsePositives << " false positive(s), "
+            << ::fpStats.skipped << " comparison(s) skipped");
+
+    AreEqualStats eq;
+    readAreEqualStats(&eq);
+    SE_PRINT_STATS("areEqual() statistics: "
+            << eq.calls << " call(s), refused in O(1) due to "
+            << eq.exitPoints << " exit point mismatch(es), "
+            << eq.programVars << " program variable mismatch(es), "
+            << eq.preds << " predicate count mismatch(es)");
+
+    const EBlockSchedulerKind kind =
+        static_cast<EBlockSchedulerKind>(GlConf::data.blockScheduler);
+
+    SE_PRINT_STATS("BlockScheduler statistics (" << blockSchedulerName(kind) << "): "
+            << ::schedStats.visits << " block visit(s), "
+            << ::schedStats.reschedules << " reschedule(s), "
+            << ::schedStats.maxWaiting << " waiting block(s) at most, "
+            << ::schedStats.joinHits << " of "
+            << ::schedStats.joinCalls << " join(s) succeeded, "
+            << ::schedStats.joinSkipped << " join(s) skipped");
+
+    SE_PRINT_STATS("SymStateMap statistics: "
+            << ::schedStats.heapsStored << " heap(s) stored, "
+            << ::schedStats.maxBlockState << " heap(s) in a block at most");
+
+    const unsigned long lookups = ::joinCache.lookups;
+    const unsigned long hits = ::joinCache.hits;
+    SE_PRINT_STATS("join cache statistics: "
+            << hits << " hit(s) of "
+            << lookups << " lookup(s) ("
+            << ((lookups) ? (100UL * hits / lookups) : 0UL) << "%), "
+            << ::joinCache.failures << " failed join(s) remembered, "
+            << ::joinCache.evictions << " eviction(s), "
+            << ::joinCache.internings << " heap(s) interned");
+}
+
+THeapIdent heapIdentOf(const SymHeap &sh, const THeapFingerprint joinKey)
+{
+    if (!hasKey(::joinCache.failedKeys, joinKey))
+        // no join has failed with such a heap, it is not worth interning
+        return 0;
+
+    // look for an equal heap among the heaps remembered so far
+    const THeapFingerprint fp = heapFingerprint(sh);
+    std::deque<InternedHeap> &heaps = ::joinCache.interned[fp];
+    for (const InternedHeap &ih : heaps)
+        if (areEqual(sh, ih.sh))
+            return ih.ident;
+
+    if (SE_JOIN_CACHE_SIZE <= ::joinCache.internedQueue.size()) {
+        // forget the oldest heap
+        const THeapFingerprint fpOld = ::joinCache.internedQueue.front();
+        ::joinCache.internedQueue.pop_front();
+
+        const TInternMap::iterator it = ::joinCache.interned.find(fpOld);
+        it->second.pop_front();
+        if (it->second.empty() && fpOld != fp)
+            ::joinCache.interned.erase(it);
+    }
+
+    ++::joinCache.internings;
+    const THeapIdent ident = ++::joinCache.lastIdent;
+    heaps.push_back(InternedHeap{ident, sh});
+    ::joinCache.internedQueue.push_back(fp);
+    return ident;
+}
+
+bool joinSymHeapsCached(
+        EJoinStatus             *pStatus,
+        SymHeap                 *pDst,
+        const THeapIdent         ident1,
+        const SymHeap           &sh1,
+        const THeapIdent         ident2,
+        const SymHeap           &sh2,
+        const bool               allowThreeWay)
+{
+    CL_BREAK_IF(!ident1);
+
+    const TJoinCacheKey key(ident1, ident2, allowThreeWay);
+    if (ident2) {
+        ++::joinCache.lookups;
+        if (hasKey(::joinCache.failed, key)) {
+            // neither of the heaps has changed since the join failed last time
+            ++::joinCache.hits;
+            return false;
+        }
+    }
+
+    if (joinSymHeaps(pStatus, pDst, sh1, sh2, allowThreeWay))
+        return true;
+
+    if (!SE_JOIN_CACHE_SIZE)
+        return false;
+
+    if (!ident2) {
+        // let heapIdentOf() intern the heaps with this join key from now on
+        const THeapFingerprint joinKey = joinFingerprint(sh2);
+        if (!insertOnce(::joinCache.failedKeys, joinKey))
+            return false;
+
+        if (SE_JOIN_CACHE_SIZE <= ::joinCache.failedKeysQueue.size()) {
+            ::joinCache.failedKeys.erase(::joinCache.failedKeysQueue.front());
+            ::joinCache.failedKeysQueue.pop_front();
+        }
+
+        ::joinCache.failedKeysQueue.push_back(joinKey);
+        return false;
+    }
+
+    if (SE_JOIN_CACHE_SIZE <= ::joinCache.failedQueue.size()) {
+        // forget the oldest failed join
+        ::joinCache.failed.erase(::joinCache.failedQueue.front());
+        ::joinCache.failedQueue.pop_front();
+        ++::joinCache.evictions;
+    }
+
+    ::joinCache.failed.insert(key);
+    ::joinCache.failedQueue.push_back(key);
+    ++::joinCache.failures;
+    return false;
+}
+
+void clearJoinCache()
+{
+    ::joinCache.failed.clear();
+    ::joinCache.failedQueue.clear();
+    ::joinCache.interned.clear();
+    ::joinCache.internedQueue.clear();
+    ::joinCache.failedKeys.clear();
+    ::joinCache.failedKeysQueue.clear();
+}
+
 
 // /////////////////////////////////////////////////////////////////////////////
 // SymStateWithJoin implementation
@@ -216,13 +472,26 @@ void SymStateWithJoin::packState(unsigned idxNew, bool allowThreeWay)
         TStorRef stor = shNew.stor();
         CL_BREAK_IF(&stor != &shOld.stor());
 
+        if (this->joinKeyOf(idxOld) != this->joinKeyOf(idxNew)) {
+            // join key mismatch --> the heaps cannot be joined
+            ++::schedStats.joinSkipped;
+            ++idxOld;
+            continue;
+        }
+
         EJoinStatus     status;
         SymHeap         result(stor, new Trace::TransientNode("packState()"));
-        if (!joinSymHeaps(&status, &result, shOld, shNew, allowThreeWay)) {
+        ++::schedStats.joinCalls;
+        if (!joinSymHeapsCached(&status, &result,
+                    this->identOf(idxOld), shOld,
+                    this->identOf(idxNew), shNew, allowThreeWay))
+        {
             ++idxOld;
             continue;
         }
 
+        ++::schedStats.joinHits;
+
         if (GlConf::data.forbidHeapReplace && (JS_USE_SH2 == status)) {
             ++idxOld;
             continue;
@@ -294,12 +563,32 @@ bool SymStateWithJoin::insert(const SymHeap &shNew, bool allowThreeWay)
             new Trace::TransientNode("SymStateWithJoin::insert()"));
     int             idx;
 
+    const THeapFingerprint joinKey = joinFingerprint(shNew);
+    THeapIdent identNew = /* not needed yet */ 0;
+    bool identKnown = false;
+
     ++::cntLookups;
     for(idx = 0; idx < cnt; ++idx) {
+        if (joinKey != this->joinKeyOf(idx)) {
+            // join key mismatch --> the heaps cannot be joined
+            ++::schedStats.joinSkipped;
+            continue;
+        }
+
+        if (!identKnown) {
+            // 0 unless a join with such a heap has already failed
+            identNew = heapIdentOf(shNew, joinKey);
+            identKnown = true;
+        }
+
         const SymHeap &shOld = this->operator[](idx);
-        if (!joinSymHeaps(&status, &result, shOld, shNew, allowThreeWay))
+        ++::schedStats.joinCalls;
+        if (!joinSymHeapsCached(&status, &result, this->identOf(idx), shOld,
+                    identNew, shNew, allowThreeWay))
             continue;
 
+        ++::schedStats.joinHits;
+
         if (GlConf::data.forbidHeapReplace && (JS_USE_SH2 == status))
             continue;
 
@@ -372,26 +661,261 @@ bool SymStateWithJoin::insert(const SymHeap &shNew, bool allowThreeWay)
 
 // /////////////////////////////////////////////////////////////////////////////
 // BlockScheduler implementation
+const char* blockSchedulerName(const EBlockSchedulerKind kind)
+{
+    switch (kind) {
+        case BSK_BFS:               return "bfs";
+        case BSK_DFS:               return "dfs";
+        case BSK_DFS_REORDER:       return "dfs_reorder";
+        case BSK_FEWEST_PENDING:    return "fewest_pending";
+        case BSK_RPO:               return "rpo";
+        case BSK_LOOP_NEST:         return "loop_nest";
+        case BSK_WIDENING:          return "widening";
+        case BSK_LAST:              break;
+    }
+
+    CL_BREAK_IF("invalid call of blockSchedulerName()");
+    return "unknown";
+}
+
+/// binary min-heap of blocks that keeps track of the position of each block
+class BlockQueue {
+    public:
+        typedef BlockScheduler::TBlock                          TBlock;
+        typedef std::pair<long, long>                           TPrio;
+
+        bool empty() const {
+            return heap_.empty();
+        }
+
+        /// insert the block, or update its priority if already inside
+        void push(const TBlock bb, const TPrio &prio) {
+            const TPos::const_iterator it = pos_.find(bb);
+            if (pos_.end() == it) {
+                const unsigned idx = heap_.size();
+                heap_.push_back(Item(prio, bb));
+                pos_[bb] = idx;
+                this->siftUp(idx);
+                return;
+            }
+
+            const unsigned idx = it->second;
+            const TPrio prioOld = heap_[idx].prio;
+            heap_[idx].prio = prio;
+            if (prio < prioOld)
+                this->siftUp(idx);
+            else
+                this->siftDown(idx);
+        }
+
+        /// remove the block with the lowest priority value
+        TBlock pop() {
+            CL_BREAK_IF(this->empty());
+            const TBlock bb = heap_.front().bb;
+            this->swapItems(0U, heap_.size() - 1U);
+            heap_.pop_back();
+            pos_.erase(bb);
+            if (!heap_.empty())
+                this->siftDown(0U);
+
+            return bb;
+        }
+
+    private:
+        struct Item {
+            TPrio       prio;
+            TBlock      bb;
+
+            Item(const TPrio &prio_, const TBlock bb_):
+                prio(prio_),
+                bb(bb_)
+            {
+            }
+        };
+
+        typedef std::map<TBlock, unsigned /* idx */>            TPos;
+
+        std::vector<Item>   heap_;
+        TPos                pos_;
+
+        void swapItems(const unsigned a, const unsigned b) {
+            std::swap(heap_[a], heap_[b]);
+            pos_[heap_[a].bb] = a;
+            pos_[heap_[b].bb] = b;
+        }
+
+        void siftUp(unsigned idx) {
+            while (idx) {
+                const unsigned parent = (idx - 1U) / 2U;
+                if (!(heap_[idx].prio < heap_[parent].prio))
+                    break;
+
+                this->swapItems(idx, parent);
+                idx = parent;
+            }
+        }
+
+        void siftDown(unsigned idx) {
+            const unsigned cnt = heap_.size();
+            for (;;) {
+                unsigned best = idx;
+                const unsigned left = 2U * idx + 1U;
+                const unsigned right = left + 1U;
+                if (left < cnt && heap_[left].prio < heap_[best].prio)
+                    best = left;
+                if (right < cnt && heap_[right].prio < heap_[best].prio)
+                    best = right;
+                if (best == idx)
+                    break;
+
+                this->swapItems(idx, best);
+                idx = best;
+            }
+        }
+};
+
+/// static properties of blocks of a single CFG used by BlockQueue priorities
+struct BlockRanks {
+    typedef BlockScheduler::TBlock                              TBlock;
+
+    std::map<TBlock, long>      rpo;        ///< index in reverse post-order
+    std::map<TBlock, long>      depth;      ///< count of enclosing loops
+    long                        maxDepth;
+
+    BlockRanks():
+        maxDepth(0L)
+    {
+    }
+
+    void init(const CodeStorage::ControlFlow &cfg);
+};
+
+void BlockRanks::init(const CodeStorage::ControlFlow &cfg)
+{
+    typedef std::pair<TBlock, unsigned /* next target */>       TFrame;
+
+    // compute post-order of the blocks using an explicit DFS stack
+    std::vector<TBlock> postOrder;
+    std::set<TBlock> seen;
+    std::vector<TFrame> stack;
+    const TBlock entry = cfg.entry();
+    seen.insert(entry);
+    stack.push_back(TFrame(entry, 0U));
+    while (!stack.empty()) {
+        TFrame &frame = stack.back();
+        const CodeStorage::TTargetList &targets = frame.first->targets();
+        if (frame.second < targets.size()) {
+            const TBlock next = targets[frame.second++];
+            if (insertOnce(seen, next))
+                stack.push_back(TFrame(next, 0U));
+
+            continue;
+        }
+
+        postOrder.push_back(frame.first);
+        stack.pop_back();
+    }
+
+    const long cnt = postOrder.size();
+    for (long idx = 0L; idx < cnt; ++idx)
+        rpo[postOrder[cnt - idx - 1L]] = idx;
+
+    // every loop-closing edge src -> head induces a natural loop
+    for (const TBlock src : postOrder) {
+        const CodeStorage::Insn *term = src->back();
+        for (const unsigned idx : term->loopClosingTargets) {
+            const TBlock head = term->targets[idx];
+
+            // collect the loop body by going backwards from src up to head
+            std::set<TBlock> body;
+            body.insert(head);
+            WorkList<TBlock> wl(src);
+            TBlock bb;
+            while (wl.next(bb)) {
+                body.insert(bb);
+                if (bb == head)
+                    // a loop closed by a self-loop edge
+                    continue;
+
+                for (const TBlock pred : bb->inbound())
+                    if (!hasKey(body, pred))
+                        wl.schedule(pred);
+            }
+
+            for (const TBlock bbInLoop : body) {
+                const long now = ++depth[bbInLoop];
+                if (maxDepth < now)
+                    maxDepth = now;
+            }
+        }
+    }
+}
+
 struct BlockScheduler::Private {
-#if !SE_BLOCK_SCHEDULER_KIND
-    typedef std::queue<TBlock>                              TSched;
-#elif SE_BLOCK_SCHEDULER_KIND < 3
-    typedef std::vector<TBlock>                             TSched;
-#endif
+    typedef std::deque<TBlock>                              TSched;
     typedef std::map<TBlock, unsigned /* cnt */>            TDone;
 
+    EBlockSchedulerKind kind;
     TBlockSet           todo;
-#if SE_BLOCK_SCHEDULER_KIND < 3
     TSched              sched;
-#endif
+    BlockQueue          queue;
+    BlockRanks          ranks;
+    bool                ranksReady;
     TDone               done;
 
     const IPendingCountProvider *pcp;
+
+    bool usingQueue() const {
+        return (BSK_FEWEST_PENDING <= kind);
+    }
+
+    BlockQueue::TPrio prioOf(TBlock bb);
 };
 
+BlockQueue::TPrio BlockScheduler::Private::prioOf(const TBlock bb)
+{
+    if (!this->ranksReady) {
+        // all blocks scheduled by a single instance belong to the same CFG
+        this->ranks.init(*bb->cfg());
+        this->ranksReady = true;
+    }
+
+    const std::map<TBlock, long>::const_iterator it = ranks.rpo.find(bb);
+    CL_BREAK_IF(ranks.rpo.end() == it);
+    const long rpo = it->second;
+
+    long depth = 0L;
+    if (hasKey(ranks.depth, bb))
+        depth = ranks.depth[bb];
+
+    switch (kind) {
+        case BSK_FEWEST_PENDING:
+            return BlockQueue::TPrio(pcp->cntPending(bb), rpo);
+
+        case BSK_RPO:
+            return BlockQueue::TPrio(0L, rpo);
+
+        case BSK_LOOP_NEST:
+            return BlockQueue::TPrio(-depth, rpo);
+
+        case BSK_WIDENING:
+            if (bb->isLoopEntry())
+                // the inner loop entries go first among the loop entries
+                return BlockQueue::TPrio(1L + ranks.maxDepth - depth, rpo);
+            else
+                return BlockQueue::TPrio(0L, rpo);
+
+        default:
+            CL_BREAK_IF("BlockScheduler::prioOf() called for a list policy");
+            return BlockQueue::TPrio(0L, rpo);
+    }
+}
+
 BlockScheduler::BlockScheduler(const IPendingCountProvider &pcp):
     d(new Private)
 {
+    d->kind = static_cast<EBlockSchedulerKind>(GlConf::data.blockScheduler);
+    d->ranksReady = false;
     d->pcp = &pcp;
 }
 
@@ -427,18 +951,30 @@ BlockScheduler::TBlockList BlockScheduler::done() const
 
 bool BlockScheduler::schedule(const TBlock bb)
 {
-    if (insertOnce(d->todo, bb)) {
-#if !SE_BLOCK_SCHEDULER_KIND
-        d->sched.push(bb);
-#elif SE_BLOCK_SCHEDULER_KIND < 3
+    const bool isNew = insertOnce(d->todo, bb);
+    if (isNew) {
+        const unsigned long cntWaiting = d->todo.size();
+        if (::schedStats.maxWaiting < cntWaiting)
+            ::schedStats.maxWaiting = cntWaiting;
+    }
+    else
+        ++::schedStats.reschedules;
+
+    if (d->usingQueue()) {
+        // (re)compute the priority as the count of pending heaps may change
+        d->queue.push(bb, d->prioOf(bb));
+        return isNew;
+    }
+
+    if (isNew) {
         d->sched.push_back(bb);
-#endif
         return true;
     }
 
     // already in the queue
+    if (BSK_DFS_REORDER != d->kind)
+        return false;
 
-#if 2 == SE_BLOCK_SCHEDULER_KIND
     const int cnt = d->sched.size();
 
     // seek the given block in the queue
@@ -463,7 +999,6 @@ bool BlockScheduler::schedule(const TBlock bb)
     Private::TSched::iterator itIdx = d->sched.begin() + idx;
     Private::TSched::iterator itTop = d->sched.begin() + (cnt - 1);
     rotate(itIdx, itTop, d->sched.end());
-#endif
 
     return false;
 }
@@ -475,38 +1010,29 @@ bool BlockScheduler::getNext(TBlock *dst)
 
     // select the block for processing according to the policy
     TBlock bb;
-#if !SE_BLOCK_SCHEDULER_KIND
-    bb = d->sched.front();
-    d->sched.pop();
-#elif SE_BLOCK_SCHEDULER_KIND < 3
-    bb = d->sched.back();
-    d->sched.pop_back();
-
-#else // assume load-driven scheduler
-
-    typedef std::map<int /* cntPending */, TBlock> TLoad;
-    TLoad load;
-
-    // this really needs to be sorted in getNext()
-    for (const TBlock bbNow : d->todo) {
-        const int cntPending = d->pcp->cntPending(bbNow);
-        load[cntPending] = bbNow;
-    }
+    switch (d->kind) {
+        case BSK_BFS:
+            bb = d->sched.front();
+            d->sched.pop_front();
+            break;
 
-    const TLoad::const_iterator itTop = load.begin();
-    const TLoad::const_reverse_iterator itBottom = load.rbegin();
+        case BSK_DFS:
+        case BSK_DFS_REORDER:
+            bb = d->sched.back();
+            d->sched.pop_back();
+            break;
 
-    bb = itTop->second;
+        default:
+            bb = d->queue.pop();
+            CL_DEBUG("<Q> " << blockSchedulerName(d->kind)
+                    << " scheduler picks " << bb->name()
+                    << ", " << (d->todo.size() - 1U) << " blocks left");
+    }
 
-    CL_DEBUG("<Q> load-driven scheduler picks "
-            << bb->name() << " with "
-            << itTop->first << " pending states, the last one is "
-            << itBottom->second->name() << " with "
-            << itBottom->first << " pending states");   
-#endif
     if (1 != d->todo.erase(bb))
         CL_BREAK_IF("BlockScheduler malfunction");
 
+    ++::schedStats.visits;
     *dst = bb;
     d->done[bb]++;
     return true;
@@ -620,9 +1146,15 @@ bool SymStateMap::insert(
     else
         changed = ref.state.insert(sh, allowThreeWay);
 
-    if (ref.state.size() <= size)
+    const unsigned sizeNow = ref.state.size();
+    if (sizeNow <= size)
         // if the size did not grow, there must have been at least join
         ref.anyHit = true;
+    else
+        ++::schedStats.heapsStored;
+
+    if (::schedStats.maxBlockState < sizeNow)
+        ::schedStats.maxBlockState = sizeNow;
 
     return changed;
 }
@@ -29,16 +29,36 @@
 #include <vector>
 
 #include "join_status.hh"
+#include "symcmp.hh"
 #include "symheap.hh"
 
 namespace CodeStorage {
     class Block;
 }
 
+/// identity of a heap as seen by the join cache, 0 means "not assigned yet"
+typedef unsigned long THeapIdent;
+
 class SymState {
     private:
         typedef std::vector<SymHeap *> TList;
 
+        /// keys of a heap used to filter out useless comparisons/joins
+        struct HeapKeys {
+            THeapFingerprint    fprint;     ///< see heapFingerprint()
+            THeapFingerprint    joinKey;    ///< see joinFingerprint()
+            THeapIdent          ident;      ///< see joinSymHeapsCached()
+
+            HeapKeys():
+                fprint(/* not computed yet */ 0),
+                joinKey(/* not computed yet */ 0),
+                ident(/* not assigned yet */ 0)
+            {
+            }
+        };
+
+        typedef std::vector<HeapKeys> TKeys;
+
     public:
         typedef TList::const_iterator           const_iterator;
         typedef TList::iterator                 iterator;
@@ -54,6 +74,7 @@ class SymState {
 
         virtual void swap(SymState &other) {
             heaps_.swap(other.heaps_);
+            keys_.swap(other.keys_);
         }
 
         /**
@@ -92,22 +113,41 @@ class SymState {
         virtual void eraseExisting(int nth) {
             delete heaps_[nth];
             heaps_.erase(heaps_.begin() + nth);
+            keys_.erase(keys_.begin() + nth);
         }
 
         virtual void swapExisting(int nth, SymHeap &sh) {
             SymHeap &existing = *heaps_.at(nth);
             existing.swap(sh);
+
+            // the keys need to be computed again
+            keys_[nth] = HeapKeys();
         }
 
         virtual void rotateExisting(int idxA, int idxB);
 
         void updateTraceOf(int idx, Trace::Node *tr, EJoinStatus status);
 
+        /// return fingerprint of the nth SymHeap object, computed on demand
+        THeapFingerprint fingerprintOf(int nth) const;
+
+        /// return join key of the nth SymHeap object, computed on demand
+        THeapFingerprint joinKeyOf(int nth) const;
+
+        /// return identity of the nth SymHeap object, assigned on demand
+        THeapIdent identOf(int nth) const;
+
+        /// move all SymHeap objects from src to the end of this container
+        void moveAllFrom(SymState &src);
+
         /// lookup/insert optimization in SymCallCache implementation
         friend class PerFncCache;
 
     private:
         TList heaps_;
+
+        /// keys of heaps_ (zero if not computed yet), see lookup() and insert()
+        mutable TKeys keys_;
 };
 
 class SymHeapList: public SymState {
@@ -130,6 +170,11 @@ class SymHeapList: public SymState {
         virtual int lookup(const SymHeap &) const {
             return /* not found */ -1;
         }
+
+        /// append all heaps of src without cloning them, src ends up empty
+        void splice(SymHeapList &src) {
+            this->moveAllFrom(src);
+        }
 };
 
 /**
@@ -301,6 +346,60 @@ class IStatsProvider {
         virtual void printStats() const = 0;
 };
 
+/// print global statistics of SymHeapUnion::lookup() (as debug messages)
+void printSymStateStats();
+
+/**
+ * return identity of a heap that is not stored in any SymState such that heaps
+ * equal in terms of areEqual() get the same identity as long as the join cache
+ * remembers them (see config.h::SE_JOIN_CACHE_SIZE).  The heap is interned only
+ * if a join with a heap of the same join key has failed before, 0 is returned
+ * otherwise.
+ * @param joinKey join key of the heap, see joinFingerprint()
+ */
+THeapIdent heapIdentOf(const SymHeap &sh, THeapFingerprint joinKey);
+
+/**
+ * joinSymHeaps() that skips the join if it has already failed on a pair of
+ * heaps with the same identities (see SymState::identOf() and heapIdentOf()).
+ * If ident2 is 0, a failure only makes heapIdentOf() intern the heaps with
+ * the join key of sh2 from now on.
+ */
+bool joinSymHeapsCached(
+        EJoinStatus             *pStatus,
+        SymHeap                 *pDst,
+        THeapIdent               ident1,
+        const SymHeap           &sh1,
+        THeapIdent               ident2,
+        const SymHeap           &sh2,
+        bool                     allowThreeWay = true);
+
+/// release all heaps and failed joins remembered by the join cache
+void clearJoinCache();
+
+/// policy of BlockScheduler, see config.h::SE_BLOCK_SCHEDULER_KIND for details
+enum EBlockSchedulerKind {
+    BSK_BFS = 0,                    ///< FIFO order
+    BSK_DFS,                        ///< LIFO order
+    BSK_DFS_REORDER,                ///< LIFO order, move rescheduled to top
+    BSK_FEWEST_PENDING,             ///< fewest pending heaps first
+    BSK_RPO,                        ///< reverse post-order of the CFG
+    BSK_LOOP_NEST,                  ///< deepest loop nesting first
+    BSK_WIDENING,                   ///< loop entries after their loop bodies
+    BSK_LAST
+};
+
+/// name of the given scheduling policy as accepted by GlConf
+const char* blockSchedulerName(EBlockSchedulerKind);
+
+/**
+ * work-list of basic blocks waiting for processing
+ *
+ * The policy is taken from GlConf::data.blockScheduler at construction time.
+ * The policies BSK_BFS, BSK_DFS, and BSK_DFS_REORDER are list-based.  The
+ * remaining policies use an indexed priority queue, which updates priority of
+ * a block in O(log n) when the block is scheduled again.
+ */
 class BlockScheduler: public IStatsProvider {
     public:
         typedef const CodeStorage::Block       *TBlock;
@@ -0,0 +1,1307 @@
+/*
+ * Copyright (C) 2026 Kamil Dudka <kdudka@redhat.com>
+ *
+ * This file is part of predator.
+ *
+ * predator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * predator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with predator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include "symsummary.hh"
+
+#include <cl/cl_msg.hh>
+#include <cl/clutil.hh>
+#include <cl/storage.hh>
+
+#include "glconf.hh"
+#include "symcmp.hh"
+#include "symstate.hh"
+#include "symtrace.hh"
+#include "symutil.hh"
+#include "util.hh"
+#include "worklist.hh"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <set>
+#include <sstream>
+
+#include <boost/functional/hash.hpp>
+
+/// bump this whenever the format of the summary store changes
+#define SUMMARY_STORE_VERSION 1
+
+static const char summaryStoreMagic[] = "predator-summary-store";
+
+/// hash of code or configuration, zero is reserved for "cannot be summarized"
+typedef size_t THash;
+
+// /////////////////////////////////////////////////////////////////////////////
+// hashing of code, used to detect stale summaries
+static void hashType(THash &seed, const struct cl_type *clt)
+{
+    using boost::hash_combine;
+
+    hash_combine(seed, clt->uid);
+    hash_combine(seed, clt->code);
+    hash_combine(seed, clt->size);
+    hash_combine(seed, clt->array_size);
+    hash_combine(seed, clt->is_unsigned);
+    if (clt->name)
+        hash_combine(seed, std::string(clt->name));
+
+    // offsets are initialized only for items of composite types
+    const bool hasOffsets = isComposite(clt, /* includingArray */ false);
+
+    // nested types are referred by uid, they are hashed on their own
+    for (int i = 0; i < clt->item_cnt; ++i) {
+        const struct cl_type_item &item = clt->items[i];
+        if (hasOffsets)
+            hash_combine(seed, item.offset);
+
+        hash_combine(seed, (item.type) ? item.type->uid : -1);
+    }
+}
+
+static void hashOperand(THash &seed, const struct cl_operand &op)
+{
+    using boost::hash_combine;
+
+    hash_combine(seed, op.code);
+    if (CL_OPERAND_VOID == op.code)
+        return;
+
+    hash_combine(seed, op.scope);
+    hash_combine(seed, (op.type) ? op.type->uid : -1);
+
+    for (const struct cl_accessor *ac = op.accessor; ac; ac = ac->next) {
+        hash_combine(seed, ac->code);
+        hash_combine(seed, (ac->type) ? ac->type->uid : -1);
+        switch (ac->code) {
+            case CL_ACCESSOR_DEREF_ARRAY:
+                hashOperand(seed, *ac->data.array.index);
+                break;
+
+            case CL_ACCESSOR_ITEM:
+                hash_combine(seed, ac->data.item.id);
+                break;
+
+            case CL_ACCESSOR_OFFSET:
+                hash_combine(seed, ac->data.offset.off);
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    if (CL_OPERAND_VAR == op.code) {
+        const struct cl_var *var = op.data.var;
+        hash_combine(seed, var->uid);
+        if (var->name)
+            hash_combine(seed, std::string(var->name));
+        return;
+    }
+
+    const struct cl_cst &cst = op.data.cst;
+    hash_combine(seed, cst.code);
+    switch (cst.code) {
+        case CL_TYPE_ENUM:
+        case CL_TYPE_INT:
+            hash_combine(seed, cst.data.cst_int.value);
+            break;
+
+        case CL_TYPE_REAL:
+            hash_combine(seed, cst.data.cst_real.value);
+            break;
+
+        case CL_TYPE_FNC:
+            hash_combine(seed, cst.data.cst_fnc.uid);
+            hash_combine(seed, std::string(cst.data.cst_fnc.name));
+            break;
+
+        case CL_TYPE_STRING:
+            hash_combine(seed, std::string(cst.data.cst_string.value));
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void hashInsn(THash &seed, const CodeStorage::Insn &insn)
+{
+    using boost::hash_combine;
+
+    hash_combine(seed, insn.code);
+    switch (insn.code) {
+        case CL_INSN_UNOP:
+        case CL_INSN_BINOP:
+            // subCode is not initialized for the other instructions
+            hash_combine(seed, insn.subCode);
+            break;
+
+        default:
+            break;
+    }
+
+    for (const struct cl_operand &op : insn.operands)
+        hashOperand(seed, op);
+
+    for (const CodeStorage::Block *target : insn.targets)
+        hash_combine(seed, target->name());
+
+    for (const CodeStorage::KillVar &kv : insn.varsToKill) {
+        hash_combine(seed, kv.uid);
+        hash_combine(seed, kv.onlyIfNotPointed);
+    }
+
+    for (const CodeStorage::TKillVarList &kList : insn.killPerTarget) {
+        hash_combine(seed, kList.size());
+        for (const CodeStorage::KillVar &kv : kList) {
+            hash_combine(seed, kv.uid);
+            hash_combine(seed, kv.onlyIfNotPointed);
+        }
+    }
+}
+
+static void hashVar(THash &seed, const CodeStorage::Var &var)
+{
+    using boost::hash_combine;
+
+    hash_combine(seed, var.uid);
+    hash_combine(seed, var.code);
+    hash_combine(seed, var.name);
+    hash_combine(seed, var.type->uid);
+    hash_combine(seed, var.initialized);
+
+    for (const CodeStorage::Insn *insn : var.initials)
+        hashInsn(seed, *insn);
+}
+
+/// the options that may influence results of a function call
+static void hashOptions(THash &seed)
+{
+    using boost::hash_combine;
+    const GlConf::Options &opt = GlConf::data;
+
+    hash_combine(seed, opt.trackUninit);
+    hash_combine(seed, opt.oomSimulation);
+    hash_combine(seed, opt.memLeakIsError);
+    hash_combine(seed, opt.errorRecoveryMode);
+    hash_combine(seed, opt.verifierErrorIsError);
+    hash_combine(seed, opt.errLabel);
+    hash_combine(seed, opt.allowCyclicTraceGraph);
+    hash_combine(seed, opt.allowThreeWayJoin);
+    hash_combine(seed, opt.forbidHeapReplace);
+    hash_combine(seed, opt.intArithmeticLimit);
+    hash_combine(seed, opt.joinOnLoopEdgesOnly);
+    hash_combine(seed, opt.stateLiveOrdering);
+    hash_combine(seed, opt.exitLeaks);
+    hash_combine(seed, opt.detectContainers);
+
+    // the order of blocks changes the order of joins and thus the results
+    hash_combine(seed, opt.blockScheduler);
+}
+
+// /////////////////////////////////////////////////////////////////////////////
+// (de)serialization of strings and floating-point numbers
+static void writeStr(std::ostream &out, const std::string &str)
+{
+    // hex-encode the string so that it is always a single token
+    out << '#' << std::hex << std::setfill('0');
+    for (const unsigned char c : str)
+        out << std::setw(2) << static_cast<unsigned>(c);
+    out << std::dec << std::setfill(' ');
+}
+
+static bool readStr(std::istream &in, std::string *pDst)
+{
+    std::string token;
+    if (!(in >> token) || token.empty() || '#' != token[0]
+            || !(token.size() & 1U))
+        return false;
+
+    pDst->clear();
+    for (size_t i = 1U; i < token.size(); i += 2U) {
+        const std::string byte(token, i, 2U);
+        if (std::string::npos != byte.find_first_not_of("0123456789abcdef"))
+            return false;
+
+        const unsigned long c = std::stoul(byte, 0, 16);
+        pDst->push_back(static_cast<char>(c));
+    }
+
+    return true;
+}
+
+static unsigned long long bitsOfDouble(const double fpn)
+{
+    unsigned long long bits;
+    static_assert(sizeof bits == sizeof fpn, "unsupported size of double");
+    memcpy(&bits, &fpn, sizeof bits);
+    return bits;
+}
+
+static double doubleOfBits(const unsigned long long bits)
+{
+    double fpn;
+    memcpy(&fpn, &bits, sizeof fpn);
+    return fpn;
+}
+
+// /////////////////////////////////////////////////////////////////////////////
+// serialization of a symbolic heap
+//
+// The heap is written as a sequence of single-line records, each of them
+// starting with a one-letter tag.  Objects and values are numbered in the
+// order of their appearance, the numbers of values below 1 are reserved for
+// special values (VAL_NULL).  The object number 0 stands for OBJ_NULL.
+//
+//  objects: v (program variable), s (anonymous stack object), h (heap object),
+//           r (OBJ_RETURN)
+//  values:  a (address), g (address with range offset), u (unknown value),
+//           F (code pointer), I (integral range), D (real), S (string)
+//  others:  x (field), b (uniform block), n (Neq predicate)
+class SummaryWriter {
+    public:
+        SummaryWriter(std::ostream &out, const SymHeap &sh):
+            out_(out),
+            sh_(/* XXX */ const_cast<SymHeap &>(sh)),
+            lastVal_(0),
+            ok_(true)
+        {
+            objMap_[OBJ_NULL] = 0;
+        }
+
+        bool /* success */ writeHeap();
+
+    private:
+        std::ostream                   &out_;
+        SymHeap                        &sh_;
+        std::map<TObjId, int>           objMap_;
+        std::map<TValId, int>           valMap_;
+        int                             lastVal_;
+        WorkList<TObjId>                wl_;
+        bool                            ok_;
+
+        int objRef(TObjId);
+        int valRef(TValId);
+        int protoRef(TValId);
+        void writeObject(TObjId);
+        void writeNeqs();
+};
+
+static int typeRef(const TObjType clt)
+{
+    return (clt)
+        ? clt->uid
+        : -1;
+}
+
+int SummaryWriter::objRef(const TObjId obj)
+{
+    const std::map<TObjId, int>::const_iterator it = objMap_.find(obj);
+    if (objMap_.end() != it)
+        return it->second;
+
+    const int ref = objMap_.size();
+    objMap_[obj] = ref;
+    wl_.schedule(obj);
+
+    const bool valid = sh_.isValid(obj);
+    if (OBJ_RETURN == obj) {
+        out_ << "r " << ref
+            << " " << typeRef(sh_.objEstimatedType(obj)) << "\n";
+        return ref;
+    }
+
+    if (isProgramVar(sh_.objStorClass(obj))) {
+        CallInst from(-1, -1);
+        if (sh_.isAnonStackObj(obj, &from)) {
+            const TSizeRange size = sh_.objSize(obj);
+            out_ << "s " << ref
+                << " " << size.lo
+                << " " << size.hi
+                << " " << size.alignment
+                << " " << from.uid
+                << " " << from.inst
+                << " " << valid << "\n";
+            return ref;
+        }
+
+        const CVar cv = sh_.cVarByObject(obj);
+        out_ << "v " << ref
+            << " " << cv.uid
+            << " " << cv.inst
+            << " " << valid << "\n";
+        return ref;
+    }
+
+    const TSizeRange size = sh_.objSize(obj);
+    const EObjKind kind = sh_.objKind(obj);
+    BindingOff off(OK_OBJ_OR_NULL);
+    TMinLen minLen = 0;
+    if (OK_REGION != kind) {
+        if (OK_OBJ_OR_NULL != kind)
+            off = sh_.segBinding(obj);
+
+        minLen = sh_.segMinLength(obj);
+    }
+
+    out_ << "h " << ref
+        << " " << size.lo
+        << " " << size.hi
+        << " " << size.alignment
+        << " " << valid
+        << " " << typeRef(sh_.objEstimatedType(obj))
+        << " " << sh_.objProtoLevel(obj)
+        << " " << kind
+        << " " << off.head
+        << " " << off.next
+        << " " << off.prev
+        << " " << minLen << "\n";
+    return ref;
+}
+
+int SummaryWriter::valRef(const TValId val)
+{
+    if (val <= 0)
+        // special values are written as they are
+        return val;
+
+    const std::map<TValId, int>::const_iterator it = valMap_.find(val);
+    if (valMap_.end() != it)
+        return it->second;
+
+    const EValueTarget code = sh_.valTarget(val);
+    int ref;
+
+    if (VT_CUSTOM == code) {
+        const CustomValue &cv = sh_.valUnwrapCustom(val);
+        ref = ++lastVal_;
+        switch (cv.code()) {
+            case CV_FNC:
+                out_ << "F " << ref << " " << cv.uid() << "\n";
+                break;
+
+            case CV_INT_RANGE:
+                out_ << "I " << ref
+                    << " " << cv.rng().lo
+                    << " " << cv.rng().hi
+                    << " " << cv.rng().alignment << "\n";
+                break;
+
+            case CV_REAL:
+                out_ << "D " << ref << " " << bitsOfDouble(cv.fpn()) << "\n";
+                break;
+
+            case CV_STRING:
+                out_ << "S " << ref << " ";
+                writeStr(out_, cv.str());
+                out_ << "\n";
+                break;
+
+            default:
+                ok_ = false;
+        }
+    }
+    else if (isAnyDataArea(code)) {
+        const int obj = this->objRef(sh_.objByAddr(val));
+        const ETargetSpecifier ts = sh_.targetSpec(val);
+        ref = ++lastVal_;
+        if (VT_RANGE == code) {
+            const IR::Range rng = sh_.valOffsetRange(val);
+            out_ << "g " << ref
+                << " " << obj
+                << " " << ts
+                << " " << rng.lo
+                << " " << rng.hi
+                << " " << rng.alignment << "\n";
+        }
+        else {
+            out_ << "a " << ref
+                << " " << obj
+                << " " << ts
+                << " " << sh_.valOffset(val) << "\n";
+        }
+    }
+    else {
+        ref = ++lastVal_;
+        out_ << "u " << ref
+            << " " << code
+            << " " << sh_.valOrigin(val) << "\n";
+    }
+
+    valMap_[val] = ref;
+    return ref;
+}
+
+int SummaryWriter::protoRef(const TValId val)
+{
+    if (val <= 0)
+        return val;
+
+    // see translateValProto()
+    const EValueTarget code = sh_.valTarget(val);
+    if (VT_UNKNOWN != code)
+        ok_ = false;
+
+    const int ref = ++lastVal_;
+    out_ << "u " << ref
+        << " " << code
+        << " " << sh_.valOrigin(val) << "\n";
+    return ref;
+}
+
+void SummaryWriter::writeObject(const TObjId obj)
+{
+    const int ref = objMap_[obj];
+
+    if (sh_.isValid(obj)) {
+        TUniBlockMap bMap;
+        sh_.gatherUniformBlocks(bMap, obj);
+        for (TUniBlockMap::const_reference item : bMap) {
+            const UniformBlock &ub = item.second;
+            const int tpl = this->protoRef(ub.tplValue);
+            out_ << "b " << ref
+                << " " << ub.off
+                << " " << ub.size
+                << " " << tpl << "\n";
+        }
+    }
+
+    FldList fields;
+    sh_.gatherLiveFields(fields, obj);
+    for (const FldHandle &fld : fields) {
+        const TObjType clt = fld.type();
+        if (isComposite(clt, /* includingArray */ false))
+            continue;
+
+        const int val = this->valRef(fld.value());
+        out_ << "x " << ref
+            << " " << fld.offset()
+            << " " << typeRef(clt)
+            << " " << val << "\n";
+    }
+}
+
+void SummaryWriter::writeNeqs()
+{
+    for (std::map<TValId, int>::const_reference item : valMap_) {
+        const int ref = item.second;
+
+        TValList related;
+        sh_.gatherRelatedValues(related, item.first);
+        for (const TValId rel : related) {
+            int relRef = rel;
+            if (0 < rel) {
+                const std::map<TValId, int>::const_iterator it =
+                    valMap_.find(rel);
+                if (valMap_.end() == it)
+                    // not relevant, see SymHeapCore::copyRelevantPreds()
+                    continue;
+
+                relRef = it->second;
+                if (ref < relRef)
+                    // each predicate is written only once
+                    continue;
+            }
+
+            out_ << "n " << ref << " " << relRef << "\n";
+        }
+    }
+}
+
+bool SummaryWriter::writeHeap()
+{
+    if (sh_.exitPoint() || sh_.cntCoincidences())
+        // not supported
+        return false;
+
+    out_ << "heap\n";
+
+    // start with program variables, as splitHeapByCVars() does
+    TObjList vars;
+    sh_.gatherObjects(vars, isProgramVar);
+    for (const TObjId obj : vars)
+        this->objRef(obj);
+
+    if (sh_.objEstimatedType(OBJ_RETURN))
+        this->objRef(OBJ_RETURN);
+
+    TObjId obj;
+    while (ok_ && wl_.next(obj))
+        this->writeObject(obj);
+
+    this->writeNeqs();
+    out_ << "end\n";
+    return ok_;
+}
+
+/// lookup tables used to validate uids read from the summary store
+struct StorIndex {
+    std::map<cl_uid_t, TObjType>                        types;
+    std::set<cl_uid_t>                                  vars;
+    std::map<cl_uid_t, const CodeStorage::Fnc *>        fncByUid;
+    std::map<std::string, const CodeStorage::Fnc *>     fncByName;
+};
+
+class SummaryReader {
+    public:
+        SummaryReader(std::istream &in, const StorIndex &idx):
+            in_(in),
+            idx_(idx)
+        {
+        }
+
+        bool /* success */ readHeap(SymHeap &sh);
+
+    private:
+        std::istream                   &in_;
+        const StorIndex                &idx_;
+        std::vector<TObjId>             objs_;
+        std::vector<TValId>             vals_;
+
+        bool readNewRef(int *pRef, unsigned expected);
+        bool readObj(TObjId *pObj);
+        bool readVal(TValId *pVal);
+        bool readType(TObjType *pClt);
+        bool readRange(IR::Range *pRng);
+        bool readRecord(SymHeap &sh, char tag);
+};
+
+bool SummaryReader::readNewRef(int *pRef, const unsigned expected)
+{
+    // objects and values are numbered in the order of their appearance
+    return (in_ >> *pRef)
+        && (expected == static_cast<unsigned>(*pRef));
+}
+
+bool SummaryReader::readObj(TObjId *pObj)
+{
+    int ref;
+    if (!(in_ >> ref) || ref < 0 || objs_.size() <= static_cast<unsigned>(ref))
+        return false;
+
+    *pObj = objs_[ref];
+    return true;
+}
+
+bool SummaryReader::readVal(TValId *pVal)
+{
+    int ref;
+    if (!(in_ >> ref) || ref < 0 || vals_.size() <= static_cast<unsigned>(ref))
+        return false;
+
+    // vals_[0] is VAL_NULL
+    *pVal = vals_[ref];
+    return true;
+}
+
+bool SummaryReader::readType(TObjType *pClt)
+{
+    cl_uid_t uid;
+    if (!(in_ >> uid))
+        return false;
+
+    if (-1 == uid) {
+        *pClt = 0;
+        return true;
+    }
+
+    const std::map<cl_uid_t, TObjType>::const_iterator it =
+        idx_.types.find(uid);
+    if (idx_.types.end() == it)
+        return false;
+
+    *pClt = it->second;
+    return true;
+}
+
+bool SummaryReader::readRange(IR::Range *pRng)
+{
+    return (in_ >> pRng->lo >> pRng->hi >> pRng->alignment)
+        && (pRng->lo <= pRng->hi)
+        && (IR::Int1 <= pRng->alignment);
+}
+
+bool SummaryReader::readRecord(SymHeap &sh, const char tag)
+{
+    int ref;
+    switch (tag) {
+        case 'v': {
+            // program variable
+            cl_uid_t uid;
+            int inst;
+            bool valid;
+            if (!this->readNewRef(&ref, objs_.size())
+                    || !(in_ >> uid >> inst >> valid)
+                    || !hasKey(idx_.vars, uid) || inst < 0)
+                return false;
+
+            const TObjId obj = sh.regionByVar(CVar(uid, inst), true);
+            if (!valid)
+                sh.objInvalidate(obj);
+
+            objs_.push_back(obj);
+            return true;
+        }
+
+        case 's': {
+            // anonymous stack object
+            TSizeRange size;
+            cl_uid_t uid;
+            int inst;
+            bool valid;
+            if (!this->readNewRef(&ref, objs_.size()) || !this->readRange(&size)
+                    || !(in_ >> uid >> inst >> valid)
+                    || !hasKey(idx_.fncByUid, uid))
+                return false;
+
+            const TObjId obj = sh.stackAlloc(size, CallInst(uid, inst));
+            if (!valid)
+                sh.objInvalidate(obj);
+
+            objs_.push_back(obj);
+            return true;
+        }
+
+        case 'h': {
+            // heap object
+            TSizeRange size;
+            bool valid;
+            TObjType clt;
+            int protoLevel, kind, minLen;
+            BindingOff off;
+            if (!this->readNewRef(&ref, objs_.size()) || !this->readRange(&size)
+                    || !(in_ >> valid) || !this->readType(&clt)
+                    || !(in_ >> protoLevel >> kind)
+                    || !(in_ >> off.head >> off.next >> off.prev >> minLen)
+                    || protoLevel < 0 || kind < OK_REGION
+                    || OK_SEE_THROUGH_2N < kind || minLen < 0)
+                return false;
+
+            // see addObjectIfNeeded() in symcut.cc
+            const TObjId obj = sh.heapAlloc(size);
+            if (!valid)
+                sh.objInvalidate(obj);
+
+            if (clt)
+                sh.objSetEstimatedType(obj, clt);
+
+            sh.objSetProtoLevel(obj, protoLevel);
+
+            if (OK_REGION != kind) {
+                sh.objSetAbstract(obj, static_cast<EObjKind>(kind), off);
+                if (sh.segMinLength(obj) != minLen)
+                    sh.segSetMinLength(obj, minLen);
+            }
+
+            objs_.push_back(obj);
+            return true;
+        }
+
+        case 'r': {
+            // OBJ_RETURN
+            TObjType clt;
+            if (!this->readNewRef(&ref, objs_.size()) || !this->readType(&clt))
+                return false;
+
+            if (clt)
+                sh.objSetEstimatedType(OBJ_RETURN, clt);
+
+            objs_.push_back(OBJ_RETURN);
+            return true;
+        }
+
+        case 'a':
+        case 'g': {
+            // address (with a range offset in case of 'g')
+            TObjId obj;
+            int ts;
+            if (!this->readNewRef(&ref, vals_.size()) || !this->readObj(&obj)
+                    || !(in_ >> ts) || ts <= TS_INVALID || TS_ALL < ts)
+                return false;
+
+            const ETargetSpecifier code = static_cast<ETargetSpecifier>(ts);
+            if ('a' == tag) {
+                TOffset off;
+                if (!(in_ >> off))
+                    return false;
+
+                vals_.push_back(sh.addrOfTarget(obj, code, off));
+                return true;
+            }
+
+            IR::Range rng;
+            if (!this->readRange(&rng))
+                return false;
+
+            const TValId root = sh.addrOfTarget(obj, code);
+            vals_.push_back(sh.valByRange(root, rng));
+            return true;
+        }
+
+        case 'u': {
+            // unknown value
+            int code, origin;
+            if (!this->readNewRef(&ref, vals_.size())
+                    || !(in_ >> code >> origin)
+                    || code < VT_INVALID || VT_RANGE < code
+                    || origin < VO_INVALID || VO_HEAP < origin)
+                return false;
+
+            const EValueTarget vt = static_cast<EValueTarget>(code);
+            if (VT_CUSTOM == vt || isAnyDataArea(vt))
+                return false;
+
+            const EValueOrigin vo = static_cast<EValueOrigin>(origin);
+            vals_.push_back(sh.valCreate(vt, vo));
+            return true;
+        }
+
+        case 'F':
+        case 'I':
+        case 'D':
+        case 'S': {
+            // custom value
+            if (!this->readNewRef(&ref, vals_.size()))
+                return false;
+
+            CustomValue cv;
+            if ('F' == tag) {
+                cl_uid_t uid;
+                if (!(in_ >> uid) || !hasKey(idx_.fncByUid, uid))
+                    return false;
+
+                cv = CustomValue(uid);
+            }
+            else if ('I' == tag) {
+                IR::Range rng;
+                if (!this->readRange(&rng))
+                    return false;
+
+                cv = CustomValue(rng);
+            }
+            else if ('D' == tag) {
+                unsigned long long bits;
+                if (!(in_ >> bits))
+                    return false;
+
+                cv = CustomValue(doubleOfBits(bits));
+            }
+            else {
+                std::string str;
+                if (!readStr(in_, &str))
+                    return false;
+
+                cv = CustomValue(str.c_str());
+            }
+
+            vals_.push_back(sh.valWrapCustom(cv));
+            return true;
+        }
+
+        case 'x': {
+            // field
+            TObjId obj;
+            TOffset off;
+            TObjType clt;
+            TValId val;
+            if (!this->readObj(&obj) || !(in_ >> off) || !this->readType(&clt)
+                    || !clt || !this->readVal(&val))
+                return false;
+
+            const FldHandle fld(sh, obj, clt, off);
+            fld.setValue(val);
+            return true;
+        }
+
+        case 'b': {
+            // uniform block
+            TObjId obj;
+            UniformBlock ub;
+            if (!this->readObj(&obj) || !(in_ >> ub.off >> ub.size)
+                    || ub.size <= 0 || !this->readVal(&ub.tplValue))
+                return false;
+
+            sh.writeUniformBlock(obj, ub);
+            return true;
+        }
+
+        case 'n': {
+            // Neq predicate
+            TValId v1, v2;
+            if (!this->readVal(&v1) || !this->readVal(&v2) || v1 == v2)
+                return false;
+
+            sh.addNeq(v1, v2);
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
+bool SummaryReader::readHeap(SymHeap &sh)
+{
+    std::string tag;
+    if (!(in_ >> tag) || "heap" != tag)
+        return false;
+
+    objs_.assign(1U, OBJ_NULL);
+    vals_.assign(1U, VAL_NULL);
+
+    while (in_ >> tag) {
+        if ("end" == tag)
+            return true;
+
+        if (1U != tag.size() || !this->readRecord(sh, tag[0]))
+            return false;
+    }
+
+    // unexpected end of file
+    return false;
+}
+
+/// skip a heap without interpreting it (the uids it refers to may be stale)
+static bool skipHeap(std::istream &in)
+{
+    std::string tag;
+    if (!(in >> tag) || "heap" != tag)
+        return false;
+
+    // strings are hex-encoded, so "end" cannot appear in the middle
+    while (in >> tag)
+        if ("end" == tag)
+            return true;
+
+    return false;
+}
+
+static unsigned cntObjects(const SymHeap &sh)
+{
+    TObjList objs;
+    sh.gatherObjects(objs);
+    return objs.size();
+}
+
+// /////////////////////////////////////////////////////////////////////////////
+// SymSummaryStore implementation
+struct SummaryRecord {
+    SymHeap                         entry;
+    THeapFingerprint                fprint;
+    std::vector<SymHeap>            results;
+
+    SummaryRecord(const SymHeap &entry_):
+        entry(entry_),
+        fprint(heapFingerprint(entry_))
+    {
+    }
+};
+
+struct SymSummaryStore::Private {
+    typedef std::vector<SummaryRecord>                  TRecordList;
+    typedef std::map<cl_uid_t, TRecordList>             TSummaryMap;
+    typedef std::map<cl_uid_t, THash>                   TFncHashMap;
+
+    const std::string               fileName;
+    const CodeStorage::Storage     *stor;
+    StorIndex                       idx;
+    THash                           digest;
+    TFncHashMap                     fncHashes;
+    TSummaryMap                     summaries;
+    bool                            dirty;
+
+    // statistics
+    int                             cntLoaded;
+    int                             cntStale;
+    int                             cntHits;
+    int                             cntInserted;
+    int                             cntRejected;
+
+    Private(const std::string &fileName_):
+        fileName(fileName_),
+        stor(0),
+        digest(0),
+        dirty(false),
+        cntLoaded(0),
+        cntStale(0),
+        cntHits(0),
+        cntInserted(0),
+        cntRejected(0)
+    {
+    }
+
+    void initIndex();
+    THash storDigest() const;
+    THash fncHash(const CodeStorage::Fnc &fnc);
+    bool roundTrip(SymHeap &dst, const SymHeap &src) const;
+    bool /* success */ loadCore(std::istream &in);
+    void saveCore(std::ostream &out);
+};
+
+void SymSummaryStore::Private::initIndex()
+{
+    for (const struct cl_type *clt : stor->types)
+        idx.types[clt->uid] = clt;
+
+    for (const CodeStorage::Var &var : stor->vars)
+        idx.vars.insert(var.uid);
+
+    for (const CodeStorage::Fnc *fnc : stor->fncs) {
+        idx.fncByUid[uidOf(*fnc)] = fnc;
+        idx.fncByName[nameOf(*fnc)] = fnc;
+    }
+}
+
+/// hash of everything a summary may depend on, except the function bodies
+THash SymSummaryStore::Private::storDigest() const
+{
+    using boost::hash_combine;
+
+    THash seed = 0;
+    hashOptions(seed);
+
+    for (const struct cl_type *clt : stor->types)
+        hashType(seed, clt);
+
+    for (const CodeStorage::Var &var : stor->vars)
+        if (!isOnStack(var))
+            hashVar(seed, var);
+
+    for (const CodeStorage::Fnc *fnc : stor->fncs) {
+        hash_combine(seed, uidOf(*fnc));
+        hash_combine(seed, std::string(nameOf(*fnc)));
+    }
+
+    return seed;
+}
+
+/// hash of the body of fnc and all fncs it calls, 0 if fnc cannot be summarized
+THash SymSummaryStore::Private::fncHash(const CodeStorage::Fnc &fnc)
+{
+    using boost::hash_combine;
+
+    const cl_uid_t uid = uidOf(fnc);
+    const TFncHashMap::const_iterator it = fncHashes.find(uid);
+    if (fncHashes.end() != it)
+        // already computed (or being computed, which means recursion)
+        return it->second;
+
+    fncHashes[uid] = 0;
+
+    THash seed = 0;
+    hash_combine(seed, std::string(nameOf(fnc)));
+    for (const int arg : fnc.args)
+        hash_combine(seed, arg);
+
+    for (const cl_uid_t vUid : fnc.vars)
+        hashVar(seed, stor->vars[vUid]);
+
+    for (const CodeStorage::Block *bb : fnc.cfg) {
+        hash_combine(seed, bb->name());
+        for (const CodeStorage::Insn *insn : *bb) {
+            hashInsn(seed, *insn);
+            if (CL_INSN_CALL != insn->code)
+                continue;
+
+            cl_uid_t calleeUid;
+            if (!fncUidFromOperand(&calleeUid, &insn->operands[/* fnc */ 1]))
+                // indirect call
+                return 0;
+
+            const std::map<cl_uid_t, const CodeStorage::Fnc *>::const_iterator
+                itCallee = idx.fncByUid.find(calleeUid);
+            if (idx.fncByUid.end() == itCallee)
+                return 0;
+
+            const CodeStorage::Fnc *callee = itCallee->second;
+            if (!isDefined(*callee))
+                // external fnc, already hashed by its name
+                continue;
+
+            const THash calleeHash = this->fncHash(*callee);
+            if (!calleeHash)
+                return 0;
+
+            hash_combine(seed, calleeHash);
+        }
+    }
+
+    if (!seed)
+        // zero is reserved
+        seed = 1;
+
+    fncHashes[uid] = seed;
+    return seed;
+}
+
+/// store the heap and load it back, check that nothing has been lost
+bool SymSummaryStore::Private::roundTrip(SymHeap &dst, const SymHeap &src)
+    const
+{
+    std::stringstream str;
+    SummaryWriter writer(str, src);
+    if (!writer.writeHeap())
+        return false;
+
+    SummaryReader reader(str, idx);
+    if (!reader.readHeap(dst))
+        return false;
+
+    return areEqual(src, dst)
+        && cntObjects(src) == cntObjects(dst);
+}
+
+bool SymSummaryStore::Private::loadCore(std::istream &in)
+{
+    std::string magic, build;
+    int version;
+    THash fileDigest;
+    if (!(in >> magic >> version) || summaryStoreMagic != magic)
+        return false;
+
+    if (SUMMARY_STORE_VERSION != version
+            || !(in >> build >> std::hex >> fileDigest >> std::dec)
+            || GIT_SHA1 != build
+            || digest != fileDigest)
+    {
+        CL_DEBUG("SymSummaryStore: " << fileName
+                << " is stale, starting with an empty store");
+        this->dirty = true;
+        return true;
+    }
+
+    std::string tag;
+    while (in >> tag) {
+        std::string name;
+        THash hash;
+        unsigned cnt;
+        if ("summary" != tag || !readStr(in, &name)
+                || !(in >> std::hex >> hash >> std::dec >> cnt))
+            return false;
+
+        const std::map<std::string, const CodeStorage::Fnc *>::const_iterator
+            it = idx.fncByName.find(name);
+
+        if (idx.fncByName.end() == it || !hash
+                || hash != this->fncHash(*it->second))
+        {
+            // the function has been changed or removed since last time
+            for (unsigned i = 0U; i <= cnt; ++i)
+                if (!skipHeap(in))
+                    return false;
+
+            ++this->cntStale;
+            this->dirty = true;
+            continue;
+        }
+
+        const CodeStorage::Fnc &fnc = *it->second;
+        SymHeap sh(*stor, new Trace::TransientNode("SymSummaryStore"));
+        SummaryReader entryReader(in, idx);
+        if (!entryReader.readHeap(sh))
+            return false;
+
+        SummaryRecord rec(sh);
+        for (unsigned i = 0U; i < cnt; ++i) {
+            SymHeap res(*stor, new Trace::TransientNode("SymSummaryStore"));
+            SummaryReader resReader(in, idx);
+            if (!resReader.readHeap(res))
+                return false;
+
+            rec.results.push_back(res);
+        }
+
+        this->summaries[uidOf(fnc)].push_back(rec);
+        ++this->cntLoaded;
+    }
+
+    return in.eof();
+}
+
+void SymSummaryStore::Private::saveCore(std::ostream &out)
+{
+    out << summaryStoreMagic << " " << SUMMARY_STORE_VERSION
+        << " " << GIT_SHA1
+        << " " << std::hex << digest << std::dec << "\n";
+
+    for (TSummaryMap::const_reference item : summaries) {
+        const CodeStorage::Fnc &fnc = *idx.fncByUid[item.first];
+        const THash hash = this->fncHash(fnc);
+
+        for (const SummaryRecord &rec : item.second) {
+            out << "summary ";
+            writeStr(out, nameOf(fnc));
+            out << " " << std::hex << hash << std::dec
+                << " " << rec.results.size() << "\n";
+
+            // all the heaps have already passed roundTrip()
+            SummaryWriter(out, rec.entry).writeHeap();
+            for (const SymHeap &res : rec.results)
+                SummaryWriter(out, res).writeHeap();
+        }
+    }
+}
+
+SymSummaryStore::SymSummaryStore(const std::string &fileName):
+    d(new Private(fileName))
+{
+}
+
+SymSummaryStore::~SymSummaryStore()
+{
+    delete d;
+}
+
+void SymSummaryStore::load(TStorRef stor)
+{
+    if (GlConf::data.fixedPoint) {
+        // the fixed-point would miss the states of the functions not executed
+        CL_WARN("option \"summary_store\" is ignored with "
+                "\"dump_fixed_point\" or \"detect_containers\"");
+        return;
+    }
+
+    d->stor = &stor;
+    d->initIndex();
+    d->digest = d->storDigest();
+
+    std::ifstream in(d->fileName.c_str());
+    if (!in) {
+        CL_DEBUG("SymSummaryStore: " << d->fileName
+                << " not found, starting with an empty store");
+        return;
+    }
+
+    if (d->loadCore(in)) {
+        CL_DEBUG("SymSummaryStore: " << d->cntLoaded
+                << " summaries loaded from " << d->fileName);
+        return;
+    }
+
+    CL_WARN("ignoring corrupted summary store: " << d->fileName);
+    d->summaries.clear();
+    d->cntLoaded = 0;
+    d->dirty = true;
+}
+
+void SymSummaryStore::save()
+{
+    if (!d->stor || !d->dirty)
+        // nothing to save
+        return;
+
+    // write a temporary file first, so that the store is replaced atomically
+    const std::string tmpName = d->fileName + ".tmp";
+    std::ofstream out(tmpName.c_str());
+    if (out)
+        d->saveCore(out);
+
+    out.close();
+    if (!out || rename(tmpName.c_str(), d->fileName.c_str())) {
+        CL_WARN("failed to write summary store: " << d->fileName);
+        remove(tmpName.c_str());
+        return;
+    }
+
+    d->dirty = false;
+}
+
+bool SymSummaryStore::lookup(
+        SymState                    &dst,
+        const CodeStorage::Fnc      &fnc,
+        const SymHeap               &entry,
+        Trace::Node                 *trEntry)
+{
+    if (!d->stor)
+        return false;
+
+    const Private::TSummaryMap::const_iterator it =
+        d->summaries.find(uidOf(fnc));
+    if (d->summaries.end() == it)
+        return false;
+
+    const THeapFingerprint fprint = heapFingerprint(entry);
+    for (const SummaryRecord &rec : it->second) {
+        if (fprint != rec.fprint || !areEqual(entry, rec.entry))
+            continue;
+
+        for (const SymHeap &res : rec.results) {
+            SymHeap sh(res);
+            Trace::waiveCloneOperation(sh);
+            sh.traceUpdate(new Trace::CallSummaryNode(trEntry, &fnc));
+            dst.insert(sh);
+        }
+
+        CL_DEBUG_MSG(locationOf(fnc), "SymSummaryStore: using a stored summary"
+                " of " << nameOf(fnc) << "()");
+
+        ++d->cntHits;
+        return true;
+    }
+
+    return false;
+}
+
+void SymSummaryStore::insert(
+        const CodeStorage::Fnc      &fnc,
+        const SymHeap               &entry,
+        const SymState              &results)
+{
+    if (!d->stor || !d->fncHash(fnc))
+        // the function cannot be summarized
+        return;
+
+    SymHeap sh(*d->stor, new Trace::TransientNode("SymSummaryStore"));
+    if (!d->roundTrip(sh, entry)) {
+        ++d->cntRejected;
+        return;
+    }
+
+    // keep the copies that have passed the round trip, not the original heaps
+    SummaryRecord rec(sh);
+    const unsigned cnt = results.size();
+    for (unsigned i = 0U; i < cnt; ++i) {
+        SymHeap res(*d->stor, new Trace::TransientNode("SymSummaryStore"));
+        if (!d->roundTrip(res, results[i])) {
+            CL_DEBUG_MSG(locationOf(fnc), "SymSummaryStore: unable to store"
+                    " a summary of " << nameOf(fnc) << "()");
+
+            ++d->cntRejected;
+            return;
+        }
+
+        rec.results.push_back(res);
+    }
+
+    d->summaries[uidOf(fnc)].push_back(rec);
+    d->dirty = true;
+    ++d->cntInserted;
+}
+
+void SymSummaryStore::printStats() const
+{
+    CL_DEBUG("SymSummaryStore: " << d->cntLoaded << " summaries loaded, "
+            << d->cntStale << " stale, "
+            << d->cntHits << " hits, "
+            << d->cntInserted << " inserted, "
+            << d->cntRejected << " rejected");
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2026 Kamil Dudka <kdudka@redhat.com>
+ *
+ * This file is part of predator.
+ *
+ * predator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * predator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with predator.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H_GUARD_SYM_SUMMARY_H
+#define H_GUARD_SYM_SUMMARY_H
+
+/**
+ * @file symsummary.hh
+ * SymSummaryStore - on-disk store of function call results reused across runs
+ */
+
+#include "symheap.hh"
+
+#include <string>
+
+class SymState;
+
+namespace CodeStorage {
+    struct Fnc;
+}
+
+namespace Trace {
+    class Node;
+}
+
+/**
+ * persistent store of function call results (so called summaries), which can
+ * be reused by SymCallCache in a later run on the same translation unit
+ *
+ * Each summary is keyed by the name of the function, a hash of its body
+ * (including the bodies of all functions it calls), and the entry heap.  The
+ * whole store is considered stale if the build of the analyzer, its options,
+ * or the types and global variables of the translation unit have changed.
+ */
+class SymSummaryStore {
+    public:
+        /// @param fileName the file to load the summaries from and save them to
+        SymSummaryStore(const std::string &fileName);
+        ~SymSummaryStore();
+
+        /// load the summaries that are still valid for the given code storage
+        void load(TStorRef stor);
+
+        /// write the summaries back to the file if anything has changed
+        void save();
+
+        /**
+         * look for a summary of the given function called with the given entry
+         * heap.  If found, append the cached results to dst and return true.
+         * @param trEntry trace node the results should be connected to
+         */
+        bool lookup(
+                SymState                    &dst,
+                const CodeStorage::Fnc      &fnc,
+                const SymHeap               &entry,
+                Trace::Node                 *trEntry);
+
+        /**
+         * remember the results of a function call computed in this run
+         * @note the call is silently ignored if the summary cannot be stored
+         */
+        void insert(
+                const CodeStorage::Fnc      &fnc,
+                const SymHeap               &entry,
+                const SymState              &results);
+
+        /// print statistics of the store using CL_DEBUG()
+        void printStats() const;
+
+    private:
+        // copying NOT allowed
+        SymSummaryStore(const SymSummaryStore &);
+        SymSummaryStore& operator=(const SymSummaryStore &);
+
+    private:
+        struct Private;
+        Private *d;
+};
+
+#endif /* H_GUARD_SYM_SUMMARY_H */
@@ -30,6 +30,7 @@
 #include <algorithm>
 #include <fstream>
 #include <map>
+#include <mutex>
 #include <set>
 #include <sstream>
 
@@ -40,6 +41,25 @@ namespace Trace {
 typedef const Node                                     *TNode;
 typedef std::set<TNode>                                 TNodeSet;
 
+// /////////////////////////////////////////////////////////////////////////////
+// implementation of Trace::GraphLock
+
+static std::recursive_mutex& graphMutex()
+{
+    static std::recursive_mutex mutex;
+    return mutex;
+}
+
+GraphLock::GraphLock()
+{
+    graphMutex().lock();
+}
+
+GraphLock::~GraphLock()
+{
+    graphMutex().unlock();
+}
+
 // /////////////////////////////////////////////////////////////////////////////
 // implementation of Trace::NodeBase
 
@@ -55,6 +75,8 @@ Node* NodeBase::parent() const
 
 void NodeBase::replaceParent(Node *parentOld, Node *parentNew)
 {
+    GraphLock lock;
+
     typedef TNodeList::iterator TIt;
     const TIt itToRepl = std::find(parents_.begin(), parents_.end(), parentOld);
     CL_BREAK_IF(itToRepl == parents_.end());
@@ -80,6 +102,8 @@ bool hasDupChildren(const Node *node)
 
 Node::~Node()
 {
+    GraphLock lock;
+
     if (!alive_)
         // this node is already being destroyed
         return;
@@ -121,6 +145,8 @@ Node::~Node()
 
 void Node::notifyBirth(NodeBase *child)
 {
+    GraphLock lock;
+
     CL_BREAK_IF(hasDupChildren(this));
     children_.push_back(child);
     CL_BREAK_IF(hasDupChildren(this));
@@ -128,6 +154,8 @@ void Node::notifyBirth(NodeBase *child)
 
 void Node::notifyDeath(NodeBase *child)
 {
+    GraphLock lock;
+
     CL_BREAK_IF(hasDupChildren(this));
 
     // remove the dead child from the list
@@ -165,6 +193,8 @@ const TIdMapper& Node::idMapper() const
 
 void replaceNode(Node *tr, Node *by)
 {
+    GraphLock lock;
+
     CL_BREAK_IF(hasDupChildren(tr));
     CL_BREAK_IF(hasDupChildren(by));
 
@@ -193,6 +223,8 @@ NodeHandle::~NodeHandle()
 
 void NodeHandle::reset(Node *node)
 {
+    GraphLock lock;
+
     Node *&ref = parents_.front();
     if (ref == node)
         // if the node is already in, protect it against accidental deallocation
@@ -346,6 +378,12 @@ void TransientNode::plotNode(TracePlotter &tplot) const
         << SL_QUOTE(origin_) << "];\n";
 }
 
+void CollapsedNode::plotNode(TracePlotter &tplot) const
+{
+    tplot.out << "\t" << SL_QUOTE(this)
+        << " [shape=circle, color=gray, fontcolor=gray, label=\"...\"];\n";
+}
+
 void RootNode::plotNode(TracePlotter &tplot) const
 {
     // TODO
@@ -462,6 +500,14 @@ void CallCacheHitNode::plotNode(TracePlotter &tplot) const
         << (nameOf(*fnc_)) << "()\"];\n";
 }
 
+void CallSummaryNode::plotNode(TracePlotter &tplot) const
+{
+    tplot.out << "\t" << SL_QUOTE(this)
+        << " [shape=box, fontname=monospace, color=gold, fontcolor=blue"
+        ", penwidth=3.0, label=\"(x) call summary loaded: "
+        << (nameOf(*fnc_)) << "()\"];\n";
+}
+
 void CallFrameNode::plotNode(TracePlotter &tplot) const
 {
     tplot.out << "\t" << SL_QUOTE(this)
@@ -634,6 +680,12 @@ Node* /* selected predecessor */ TransientNode::printNode() const
     return this->parent();
 }
 
+Node* /* selected predecessor */ CollapsedNode::printNode() const
+{
+    // the rest of the trace has not been kept
+    return 0;
+}
+
 Node* /* selected predecessor */ RootNode::printNode() const
 {
     // reaching this node means we are done with tracing!
@@ -909,4 +961,12 @@ void waiveCloneOperation(SymState &state)
         Trace::waiveCloneOperation(*sh);
 }
 
+// /////////////////////////////////////////////////////////////////////////////
+// implementation of Trace::collapse()
+
+void collapse(SymHeap &sh)
+{
+    sh.traceUpdate(new CollapsedNode);
+}
+
 } // namespace Trace
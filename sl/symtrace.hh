@@ -29,9 +29,11 @@
 
 #include "id_mapper.hh"
 #include "join_status.hh"
+#include "mempool.hh"
 #include "symbt.hh"                 // needed for EMsgLevel
 #include "symheap.hh"               // needed for EObjKind
 
+#include <exception>
 #include <vector>
 #include <string>
 
@@ -140,6 +142,9 @@ class Node: public NodeBase {
         friend void plotTraceCore(TracePlotter &);
 
     public:
+        // trace nodes are allocated from a memory pool
+        MEM_POOL_ALLOCATED(MPK_TRACE_NODE)
+
         /// used to store a list of child nodes
         typedef std::vector<NodeBase *> TBaseList;
 
@@ -251,6 +256,17 @@ class RootNode: public Node {
         void virtual plotNode(TracePlotter &) const;
 };
 
+/// root of a trace collapsed in the trace-free mode (see option no_trace)
+class CollapsedNode: public Node {
+    public:
+        CollapsedNode() { }
+
+        virtual Node* printNode() const;
+
+    protected:
+        void virtual plotNode(TracePlotter &) const;
+};
+
 /// a trace graph node that represents a non-terminal instruction
 class InsnNode: public Node {
     private:
@@ -271,6 +287,9 @@ class InsnNode: public Node {
             this->idMapper().setNotFoundAction(TIdMapper::NFA_RETURN_IDENTITY);
         }
 
+        /// the instruction represented by this node
+        TInsn insn() const { return insn_; }
+
         virtual Node* printNode() const;
 
     protected:
@@ -461,6 +480,26 @@ class CallCacheHitNode: public Node {
         void virtual plotNode(TracePlotter &) const;
 };
 
+/// trace graph node representing a call result loaded from SymSummaryStore
+class CallSummaryNode: public Node {
+    private:
+        const TFnc fnc_;
+
+    public:
+        /**
+         * @param entry trace representing the call entry
+         * @param fnc a CodeStorage::Fnc fld representing the called function
+         */
+        CallSummaryNode(Node *entry, const TFnc fnc):
+            Node(entry),
+            fnc_(fnc)
+        {
+        }
+
+    protected:
+        void virtual plotNode(TracePlotter &) const;
+};
+
 /// trace graph node representing a call frame
 class CallFrameNode: public Node {
     private:
@@ -672,12 +711,41 @@ class Globals {
         }
 };
 
+/**
+ * serialize all changes of the trace graph performed in the scope of the lock
+ * by multiple threads (the lock is recursive, so it is safe to nest it)
+ */
+class GraphLock {
+    public:
+        GraphLock();
+        ~GraphLock();
+
+    private:
+        // copying NOT allowed
+        GraphLock(const GraphLock &);
+        GraphLock& operator=(const GraphLock &);
+};
+
 /// mark the just completed @b clone operation as @b intended and unimportant
 void waiveCloneOperation(SymHeap &sh);
 
 /// mark the just completed @b clone operation as @b intended and unimportant
 void waiveCloneOperation(SymState &);
 
+/**
+ * drop the trace leading to the given heap and replace it by a CollapsedNode,
+ * which allows the nodes to be released as soon as they have been used
+ */
+void collapse(SymHeap &sh);
+
+/// thrown in the trace-free mode once a report requires the full trace
+class TraceRequiredException: public std::exception {
+    public:
+        virtual const char* what() const throw() {
+            return "trace required in the trace-free mode";
+        }
+};
+
 } // namespace Trace
 
 #endif /* H_GUARD_SYM_TRACE_H */